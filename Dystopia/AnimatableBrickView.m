@@ -24,6 +24,7 @@
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #import "AnimatableBrickView.h"
+#import "GameScheduler.h"
 
 #define GAME_OBJECT_ANIMATION_END_VISIBLE_STATE_UNCHANGED 0
 #define GAME_OBJECT_ANIMATION_END_VISIBLE_STATE_VISIBLE   1
@@ -190,7 +191,9 @@
             self.transform = CGAffineTransformMakeScale(scale, scale);
         }];
     });
-    [self performSelector:@selector(animatePulse) withObject:nil afterDelay:(GAME_OBJECT_BRICK_PULSING_DURATION / 2.0f)];
+    [[GameScheduler instance] performBlock:^{
+        [self animatePulse];
+    } afterDelay:(GAME_OBJECT_BRICK_PULSING_DURATION / 2.0f)];
 }
 
 - (void)setViewAlpha:(float)viewAlpha {
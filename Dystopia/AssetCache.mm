@@ -0,0 +1,169 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "AssetCache.h"
+
+#define ASSET_CACHE_MAGIC   0x43415944 // "DYAC"
+#define ASSET_CACHE_VERSION 1
+
+// Header is padded, so pixel rows start aligned in the mapped file
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bytesPerRow;
+    uint32_t reserved[11];
+} AssetCacheHeader;
+
+AssetCache *assetCacheInstance = nil;
+
+@interface AssetCache () {
+    NSString *cacheDirectory;
+}
+
+@end
+
+@implementation AssetCache
+
++ (AssetCache *)instance {
+    @synchronized(self) {
+        if (assetCacheInstance == nil) {
+            assetCacheInstance = [[AssetCache alloc] init];
+        }
+        return assetCacheInstance;
+    }
+}
+
+- (id)init {
+    if (self = [super init]) {
+        [self initialize];
+    }
+    return self;
+}
+
+- (void)initialize {
+    // Assets ship with the bundle, so a new build gets a fresh cache
+    NSString *cachesDirectory = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    NSString *bundleVersion = [[NSBundle mainBundle] objectForInfoDictionaryKey:(NSString *)kCFBundleVersionKey];
+    cacheDirectory = [[cachesDirectory stringByAppendingPathComponent:@"AssetCache"] stringByAppendingPathComponent:bundleVersion != nil ? bundleVersion : @"0"];
+    [[NSFileManager defaultManager] createDirectoryAtPath:cacheDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+}
+
+- (void)clear {
+    [[NSFileManager defaultManager] removeItemAtPath:cacheDirectory error:nil];
+    [[NSFileManager defaultManager] createDirectoryAtPath:cacheDirectory withIntermediateDirectories:YES attributes:nil error:nil];
+}
+
+- (UIImage *)imageNamed:(NSString *)name size:(CGSize)size scale:(float)scale renderer:(AssetRenderer)renderer {
+    int width = (int)ceilf(size.width * scale);
+    int height = (int)ceilf(size.height * scale);
+    if (width <= 0 || height <= 0) {
+        return nil;
+    }
+    NSString *path = [cacheDirectory stringByAppendingPathComponent:[NSString stringWithFormat:@"%@_%ix%i@%.2f.bitmap", name, width, height, scale]];
+
+    UIImage *image = [self mappedImageAtPath:path width:width height:height scale:scale];
+    if (image != nil) {
+        return image;
+    }
+    if (DEBUG) {
+        NSLog(@"Asset cache miss: %@", [path lastPathComponent]);
+    }
+    NSData *data = [self renderWidth:width height:height scale:scale renderer:renderer];
+    if (data == nil) {
+        return nil;
+    }
+    if (![data writeToFile:path atomically:YES]) {
+        NSLog(@"Could not write asset cache file %@", path);
+    }
+    return [self imageWithData:data width:width height:height scale:scale];
+}
+
+- (UIImage *)mappedImageAtPath:(NSString *)path width:(int)width height:(int)height scale:(float)scale {
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:nil];
+    if (data == nil || data.length < sizeof(AssetCacheHeader)) {
+        return nil;
+    }
+    const AssetCacheHeader *header = (const AssetCacheHeader *)data.bytes;
+    if (header->magic != ASSET_CACHE_MAGIC || header->version != ASSET_CACHE_VERSION || header->width != width || header->height != height ||
+        data.length < sizeof(AssetCacheHeader) + (size_t)header->bytesPerRow * height) {
+        return nil;
+    }
+    return [self imageWithData:data width:width height:height scale:scale];
+}
+
+- (NSData *)renderWidth:(int)width height:(int)height scale:(float)scale renderer:(AssetRenderer)renderer {
+    size_t bytesPerRow = (size_t)width * 4;
+    NSMutableData *data = [NSMutableData dataWithLength:sizeof(AssetCacheHeader) + bytesPerRow * height];
+
+    AssetCacheHeader *header = (AssetCacheHeader *)data.mutableBytes;
+    header->magic = ASSET_CACHE_MAGIC;
+    header->version = ASSET_CACHE_VERSION;
+    header->width = width;
+    header->height = height;
+    header->bytesPerRow = (uint32_t)bytesPerRow;
+
+    // Native byte order, so Core Animation can use the pixels without converting
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate((uint8_t *)data.mutableBytes + sizeof(AssetCacheHeader), width, height, 8, bytesPerRow, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+    CGColorSpaceRelease(colorSpace);
+    if (context == NULL) {
+        return nil;
+    }
+
+    // UIKit coordinates in points
+    CGContextTranslateCTM(context, 0.0f, height);
+    CGContextScaleCTM(context, scale, -scale);
+
+    UIGraphicsPushContext(context);
+    renderer(CGSizeMake(width / scale, height / scale));
+    UIGraphicsPopContext();
+
+    CGContextRelease(context);
+    return data;
+}
+
+static void releaseAssetData(void *info, const void *data, size_t size) {
+    CFRelease(info);
+}
+
+- (UIImage *)imageWithData:(NSData *)data width:(int)width height:(int)height scale:(float)scale {
+    const AssetCacheHeader *header = (const AssetCacheHeader *)data.bytes;
+    size_t length = (size_t)header->bytesPerRow * height;
+
+    // Provider keeps the (possibly mapped) data alive for the lifetime of the image
+    CGDataProviderRef provider = CGDataProviderCreateWithData((void *)CFBridgingRetain(data), (const uint8_t *)data.bytes + sizeof(AssetCacheHeader), length, releaseAssetData);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGImageRef imageRef = CGImageCreate(width, height, 8, 32, header->bytesPerRow, colorSpace, kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little, provider, NULL, false, kCGRenderingIntentDefault);
+    CGColorSpaceRelease(colorSpace);
+    CGDataProviderRelease(provider);
+
+    UIImage *image = [UIImage imageWithCGImage:imageRef scale:scale orientation:UIImageOrientationUp];
+    CGImageRelease(imageRef);
+    return image;
+}
+
+@end
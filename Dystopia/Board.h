@@ -29,11 +29,14 @@
 #import "BoardUtil.h"
 #import "HeroFigure.h"
 #import "MonsterFigure.h"
+#import "FigureRegistry.h"
 
 #define BOARD_BRICK_NONE      0
 #define BOARD_BRICK_INVISIBLE 1
 #define BOARD_BRICK_VISIBLE   2
 
+typedef FigureSetRange<MoveableGameObject * __unsafe_unretained> FigureRange;
+
 @interface Board : UIView
 
 + (Board *)instance;
@@ -51,25 +54,46 @@
 - (bool)hasBrickAtPosition:(cv::Point)position;
 - (bool)hasVisibleBrickAtPosition:(cv::Point)position;
 - (bool)hasObjectAtPosition:(cv::Point)position;
+- (GameObject *)objectAtPosition:(cv::Point)position;
 
 - (BrickView *)brickViewAtPosition:(cv::Point)p;
 
+// Cells within movement length of the position, going around other figures, the position itself included
+- (cv::vector<cv::Point>)reachablePositionsFromPosition:(cv::Point)position movementLength:(int)movementLength;
+
+// Plans moves of all active monsters together, used by recommendedDestinationForMonster for the rest of the turn
+- (void)planMonstersTurn;
+
+// Planned cell of the monster, or else the cell within its reach closest to the nearest active hero. Returns NO if no
+// hero can be reached
+- (bool)recommendedDestinationForMonster:(MoveableGameObject *)monster destination:(cv::Point &)destination;
+
 - (void)refreshBrickMap;
 - (void)refreshObjectMap;
 
-- (NSMutableArray *)boardObjects;
-- (NSMutableArray *)visibleBoardObjects;
-- (NSMutableArray *)visibleMonsterFigures;
-- (NSMutableArray *)invisibleMonsterFigures;
-- (NSMutableArray *)activeMonsterFigures;
-- (NSMutableArray *)unrecognizedActiveMonsterFigures;
-- (NSMutableArray *)unrecognizedHeroFigures;
+- (void)figureChanged:(GameObject *)object;
+
+// Called whenever what is projected changes, with the length of the animation it starts if any
+- (void)projectionChangedWithAnimationDuration:(double)duration;
+- (void)removeHeroFigure:(HeroFigure *)hero;
 
-- (cv::vector<cv::Point>)randomControlPoints:(int)count;
+- (FigureRange)boardObjects;
+- (FigureRange)visibleBoardObjects;
+- (FigureRange)activeBoardObjects;
+- (FigureRange)visibleMonsterFigures;
+- (FigureRange)invisibleMonsterFigures;
+- (FigureRange)activeMonsterFigures;
+- (FigureRange)unrecognizedActiveMonsterFigures;
+- (FigureRange)unrecognizedHeroFigures;
 
 @property (nonatomic, retain) NSMutableArray *heroFigures;
 @property (nonatomic, retain) NSMutableArray *monsterFigures;
 
 @property (nonatomic, readonly) cv::vector<cv::Point> brickPositions;
+@property (nonatomic, readonly) int brickMapVersion;
+
+// Bumped on every change to what is projected; the projection is settled once its last animation has finished
+@property (nonatomic, readonly) int projectionVersion;
+@property (nonatomic, readonly) bool projectionSettled;
 
 @end
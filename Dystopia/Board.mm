@@ -29,11 +29,21 @@
 #import "ConnectorsView.h"
 #import "MoveableLocationsView.h"
 #import "DoorView.h"
+#import "GameScheduler.h"
+#import "LevelImage.h"
+#import "Pathfinder.h"
+#import "MonsterPlanner.h"
+
+#define BOARD_MONSTER_PLAN_TIME_BUDGET 0.05f
 
 @interface Board () {
     int brickMap[BOARD_HEIGHT][BOARD_WIDTH];
     int brickVisibilityMap[BOARD_HEIGHT][BOARD_WIDTH];
-    int objectMap[BOARD_HEIGHT][BOARD_WIDTH];
+    int brickIndexMap[BOARD_HEIGHT][BOARD_WIDTH];
+    __unsafe_unretained GameObject *objectMap[BOARD_HEIGHT][BOARD_WIDTH];
+
+    FigureRegistry figureRegistry;
+    __unsafe_unretained MoveableGameObject *figures[MAX_FIGURES];
     
     NSMutableArray *brickViews;
 
@@ -42,6 +52,16 @@
     BorderView *borderView;
     
     int level;
+    LevelImage levelImage;
+
+    Pathfinder pathfinder;
+
+    WorkStealingPool plannerPool;
+    FigureSet plannedMonsters;
+    cv::Point plannedDestinations[MAX_FIGURES];
+    unsigned int planCount;
+
+    double projectionSettledTime;
 }
 
 @end
@@ -51,6 +71,8 @@
 Board *boardInstance = nil;
 
 @synthesize brickPositions;
+@synthesize brickMapVersion;
+@synthesize projectionVersion;
 @synthesize heroFigures;
 @synthesize monsterFigures;
 
@@ -72,6 +94,7 @@ Board *boardInstance = nil;
 
 - (void)initialize {
     self.backgroundColor = [UIColor blackColor];
+    memset(brickIndexMap, -1, sizeof(brickIndexMap));
 
     moveableLocationsView = [[MoveableLocationsView alloc] initWithFrame:self.bounds];
     [self addSubview:moveableLocationsView];
@@ -85,62 +108,63 @@ Board *boardInstance = nil;
 - (void)layoutSubviews {
     [self bringSubviewToFront:moveableLocationsView];
     [self bringSubviewToFront:[ConnectorsView instance]];
-    for (GameObject *object in [self activeBoardObjects]) {
+    for (GameObject *object : [self activeBoardObjects]) {
         [self bringSubviewToFront:object];
     }
+    [self projectionChangedWithAnimationDuration:0.0];
 }
 
 - (void)loadLevel:(int)l {
     level = l;
+    if (![self mapLevelImage]) {
+        return;
+    }
     [self loadBoard];
     [self setupBorderView];
     [self initializeFigures];
     [self makeBrickViewVisible:[brickViews objectAtIndex:0]];
 }
 
+- (bool)mapLevelImage {
+    NSString *path = [[NSBundle mainBundle] pathForResource:[NSString stringWithFormat:@"level%i", level + 1] ofType:@"level"];
+    std::string error;
+    if (path == nil || !levelImage.open([path UTF8String], error)) {
+        NSLog(@"Could not load level %i: %s", level + 1, path == nil ? "not found" : error.c_str());
+        return NO;
+    }
+    return YES;
+}
+
 - (void)loadBoard {
     brickViews = [NSMutableArray array];
-    [self addBrickOfType:0 atPosition:cv::Point(3, 3)];
-    [self addBrickOfType:0 atPosition:cv::Point(6, 3)];
-    [self addBrickOfType:8 atPosition:cv::Point(7, 6)];
-    [self addBrickOfType:8 atPosition:cv::Point(7, 9)];
-    [self addBrickOfType:8 atPosition:cv::Point(7, 12)];
-
-    [self addBrickOfType:2 atPosition:cv::Point(6, 15)];
-    [self addBrickOfType:2 atPosition:cv::Point(9, 15)];
-
-    [self addBrickOfType:5 atPosition:cv::Point(4, 10)];
-    [self addBrickOfType:5 atPosition:cv::Point(8, 10)];
-    [self addBrickOfType:5 atPosition:cv::Point(11, 10)];
-    [self addBrickOfType:1 atPosition:cv::Point(14, 8)];
-    [self addBrickOfType:1 atPosition:cv::Point(14, 11)];
-
-    [self addBrickOfType:3 atPosition:cv::Point(1, 9)];
-    [self addBrickOfType:8 atPosition:cv::Point(2, 12)];
-
-    [self addBrickOfType:4 atPosition:cv::Point(2, 15)];
+    memset(brickIndexMap, -1, sizeof(brickIndexMap));
 
+    // Forget previous level, so next brick map refresh counts as a change
+    memset(brickVisibilityMap, 0, sizeof(brickVisibilityMap));
+    for (int i = 0; i < levelImage.header().brickCount; i++) {
+        const LevelImageBrick &brick = levelImage.bricks()[i];
+        [self addBrickOfType:brick.type atPosition:cv::Point(brick.x, brick.y)];
+    }
     for (BrickView *brickView in brickViews) {
         [self addSubview:brickView];
     }
-
-    [[ConnectorsView instance] addDoorAtPosition1:cv::Point(7, 5) position2:cv::Point(7, 6) type:DOOR_TYPE_NORMAL];
-    [[ConnectorsView instance] addDoorAtPosition1:cv::Point(7, 14) position2:cv::Point(7, 15) type:DOOR_TYPE_NORMAL];
-    [[ConnectorsView instance] addDoorAtPosition1:cv::Point(13, 10) position2:cv::Point(14, 10) type:DOOR_TYPE_NORMAL];
-    [[ConnectorsView instance] addDoorAtPosition1:cv::Point(3, 10) position2:cv::Point(4, 10) type:DOOR_TYPE_NORMAL];
-    [[ConnectorsView instance] addDoorAtPosition1:cv::Point(2, 11) position2:cv::Point(2, 12) type:DOOR_TYPE_NORMAL];
-    [[ConnectorsView instance] addDoorAtPosition1:cv::Point(2, 14) position2:cv::Point(2, 15) type:DOOR_TYPE_NORMAL];
-
-    [[ConnectorsView instance] addHallwayConnectionAtPosition1:cv::Point(6, 10) position2:cv::Point(7, 10)];
-    [[ConnectorsView instance] addHallwayConnectionAtPosition1:cv::Point(7, 10) position2:cv::Point(8, 10)];
-    
-    [[ConnectorsView instance] addConnectionViewAtPosition1:cv::Point(5, 4) position2:cv::Point(6, 5) type:CONNECTION_TYPE_VIEW_GLUE];
-    [[ConnectorsView instance] addConnectionViewAtPosition1:cv::Point(7, 8) position2:cv::Point(7, 9) type:CONNECTION_TYPE_VIEW_GLUE];
-    [[ConnectorsView instance] addConnectionViewAtPosition1:cv::Point(7, 11) position2:cv::Point(7, 12) type:CONNECTION_TYPE_VIEW_GLUE];
-    [[ConnectorsView instance] addConnectionViewAtPosition1:cv::Point(8, 16) position2:cv::Point(9, 16) type:CONNECTION_TYPE_VIEW_GLUE];
-    [[ConnectorsView instance] addConnectionViewAtPosition1:cv::Point(10, 10) position2:cv::Point(11, 10) type:CONNECTION_TYPE_VIEW_GLUE];
-    [[ConnectorsView instance] addConnectionViewAtPosition1:cv::Point(15, 8) position2:cv::Point(15, 9) type:CONNECTION_TYPE_VIEW_GLUE];
-    [[ConnectorsView instance] addConnectionViewAtPosition1:cv::Point(15, 11) position2:cv::Point(15, 12) type:CONNECTION_TYPE_VIEW_GLUE];
+    for (int i = 0; i < levelImage.header().connectionCount; i++) {
+        const LevelImageConnection &connection = levelImage.connections()[i];
+        cv::Point position1 = cv::Point(connection.x1, connection.y1);
+        cv::Point position2 = cv::Point(connection.x2, connection.y2);
+        switch (connection.type) {
+            case CONNECTION_TYPE_DOOR:
+                [[ConnectorsView instance] addDoorAtPosition1:position1 position2:position2 type:DOOR_TYPE_NORMAL];
+                break;
+            case CONNECTION_TYPE_HALLWAY:
+                [[ConnectorsView instance] addHallwayConnectionAtPosition1:position1 position2:position2];
+                break;
+            default:
+                [[ConnectorsView instance] addConnectionViewAtPosition1:position1 position2:position2 type:connection.type];
+                break;
+        }
+    }
+    [[ConnectorsView instance] prepareRevealMasks];
 }
 
 - (void)setupBorderView {
@@ -149,7 +173,18 @@ Board *boardInstance = nil;
 }
 
 - (void)addBrickOfType:(int)type atPosition:(cv::Point)position {
-    [brickViews addObject:[[BrickView alloc] initWithPosition:position type:type]];
+    BrickView *brickView = [[BrickView alloc] initWithPosition:position type:type];
+    int brickIndex = (int)brickViews.count;
+    [brickViews addObject:brickView];
+
+    // First brick added at a cell owns it, as the linear search used to find
+    for (int i = position.y; i < MIN(position.y + brickView.size.height, BOARD_HEIGHT); i++) {
+        for (int j = position.x; j < MIN(position.x + brickView.size.width, BOARD_WIDTH); j++) {
+            if (brickIndexMap[i][j] == -1) {
+                brickIndexMap[i][j] = brickIndex;
+            }
+        }
+    }
 }
 
 - (void)makeBrickViewVisible:(BrickView *)brickView {
@@ -168,8 +203,8 @@ Board *boardInstance = nil;
 }
 
 - (void)showMonstersInBrickView:(BrickView *)brickView {
-    for (MonsterFigure *monsterFigure in [self invisibleMonsterFigures]) {
-        if ([brickView containsPosition:monsterFigure.position]) {
+    for (MoveableGameObject *monsterFigure : [self invisibleMonsterFigures]) {
+        if ([self brickViewAtPosition:monsterFigure.position] == brickView) {
             monsterFigure.visible = YES;
             [monsterFigure showBrickWithAnimation:NO];
         }
@@ -177,8 +212,8 @@ Board *boardInstance = nil;
 }
 
 - (void)activateMonstersInBrickView:(BrickView *)brickView {
-    for (MonsterFigure *monsterFigure in monsterFigures) {
-        if ([brickView containsPosition:monsterFigure.position]) {
+    for (MoveableGameObject *monsterFigure : [self figuresInView:FIGURE_VIEW_MONSTERS]) {
+        if ([self brickViewAtPosition:monsterFigure.position] == brickView) {
             monsterFigure.active = YES;
             monsterFigure.visible = YES;
             [monsterFigure showBrickWithAnimation:NO];
@@ -199,6 +234,8 @@ Board *boardInstance = nil;
 }
 
 - (void)refreshBrickMap {
+    int previousBrickVisibilityMap[BOARD_HEIGHT][BOARD_WIDTH];
+    memcpy(previousBrickVisibilityMap, brickVisibilityMap, sizeof(brickVisibilityMap));
     for (int i = 0; i < BOARD_HEIGHT; i++) {
         for (int j = 0; j < BOARD_WIDTH; j++) {
             brickMap[i][j] = -1;
@@ -214,17 +251,109 @@ Board *boardInstance = nil;
         }
     }
     [self refreshBrickPositions];
+    if (memcmp(previousBrickVisibilityMap, brickVisibilityMap, sizeof(brickVisibilityMap)) != 0) {
+        brickMapVersion++;
+        [self projectionChangedWithAnimationDuration:0.0];
+        [self refreshPathfinder];
+    }
 }
 
-- (void)refreshObjectMap {
+- (void)refreshPathfinder {
+    int rooms[BOARD_HEIGHT][BOARD_WIDTH];
     for (int i = 0; i < BOARD_HEIGHT; i++) {
         for (int j = 0; j < BOARD_WIDTH; j++) {
-            objectMap[i][j] = -1;
+            rooms[i][j] = brickVisibilityMap[i][j] == BOARD_BRICK_VISIBLE ? levelImage.bricks()[brickIndexMap[i][j]].room : -1;
+        }
+    }
+    pathfinder.setBoard(rooms);
+}
+
+- (Bitboard)occupiedCells {
+    Bitboard occupied;
+    clearBitboard(occupied);
+    for (MoveableGameObject *object : [self boardObjects]) {
+        setBitboardCell(occupied, object.position);
+    }
+    return occupied;
+}
+
+- (cv::vector<cv::Point>)reachablePositionsFromPosition:(cv::Point)position movementLength:(int)movementLength {
+    Bitboard blocked = [self occupiedCells];
+    blocked.rows[position.y] &= ~(1u << position.x);
+    Bitboard reachable = pathfinder.reachableCells(position, movementLength, blocked);
+    cv::vector<cv::Point> positions;
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            if (bitboardContains(reachable, cv::Point(j, i))) {
+                positions.push_back(cv::Point(j, i));
+            }
+        }
+    }
+    return positions;
+}
+
+- (void)planMonstersTurn {
+    plannedMonsters = 0;
+    cv::vector<PlannerFigure> monsters;
+    cv::vector<PlannerFigure> heroes;
+    cv::vector<int> monsterIndices;
+    for (MoveableGameObject *monster : [self activeMonsterFigures]) {
+        monsters.push_back(PlannerFigure {.position = monster.position, .movementLength = monster.movementLength});
+        monsterIndices.push_back(monster.figureIndex);
+    }
+    for (MoveableGameObject *hero : [self figuresInView:FIGURE_VIEW_HEROES]) {
+        if (hero.active) {
+            heroes.push_back(PlannerFigure {.position = hero.position, .movementLength = hero.movementLength});
+        }
+    }
+    if (monsters.size() == 0 || heroes.size() == 0) {
+        return;
+    }
+    MonsterPlan plan = planMonsterMoves(pathfinder, monsters, heroes, [self occupiedCells], BOARD_MONSTER_PLAN_TIME_BUDGET, planCount++, plannerPool);
+    if (DEBUG) {
+        NSLog(@"Monster plan scored %i after %i restarts%@", plan.score, plan.restarts, plan.complete ? @"" : @" (cut by time budget)");
+    }
+    for (int i = 0; i < monsterIndices.size(); i++) {
+        plannedMonsters |= (FigureSet)1 << monsterIndices[i];
+        plannedDestinations[monsterIndices[i]] = plan.destinations[i];
+    }
+}
+
+- (bool)recommendedDestinationForMonster:(MoveableGameObject *)monster destination:(cv::Point &)destination {
+    Bitboard blocked = [self occupiedCells];
+    blocked.rows[monster.position.y] &= ~(1u << monster.position.x);
+
+    // Planned move, unless monsters that moved before it have taken or cut off its cell
+    if (monster.figureIndex != -1 && (plannedMonsters >> monster.figureIndex) & 1) {
+        plannedMonsters &= ~((FigureSet)1 << monster.figureIndex);
+        cv::Point plannedDestination = plannedDestinations[monster.figureIndex];
+        if (bitboardContains(pathfinder.reachableCells(monster.position, monster.movementLength, blocked), plannedDestination)) {
+            destination = plannedDestination;
+            return YES;
         }
     }
-    NSMutableArray *objects = [self boardObjects];
-    for (GameObject *object in objects) {
-        objectMap[object.position.y][object.position.x] = 1;
+
+    cv::vector<cv::Point> heroPositions;
+    for (MoveableGameObject *hero : [self figuresInView:FIGURE_VIEW_HEROES]) {
+        if (hero.active) {
+            heroPositions.push_back(hero.position);
+        }
+    }
+    return pathfinder.recommendedDestination(monster.position, monster.movementLength, heroPositions, blocked, destination);
+}
+
+- (void)refreshObjectMap {
+    __unsafe_unretained GameObject *previousObjectMap[BOARD_HEIGHT][BOARD_WIDTH];
+    memcpy(previousObjectMap, objectMap, sizeof(objectMap));
+    memset(objectMap, 0, sizeof(objectMap));
+    for (FigureSet set = figureRegistry.view(FIGURE_VIEW_BOARD_OBJECTS); set != 0; set &= set - 1) {
+        int index = __builtin_ctzll(set);
+        cv::Point position = figureRegistry.position(index);
+        objectMap[position.y][position.x] = figures[index];
+    }
+    if (memcmp(previousObjectMap, objectMap, sizeof(objectMap)) != 0) {
+        brickMapVersion++;
+        [self projectionChangedWithAnimationDuration:GAME_OBJECT_MOVE_ANIMATION_DURATION];
     }
 }
 
@@ -240,15 +369,20 @@ Board *boardInstance = nil;
             [connectionView openConnection];
         }
     }
-    [self performSelector:@selector(layoutSubviews) withObject:nil afterDelay:BRICKVIEW_OPEN_DOOR_DURATION];
+    [self projectionChangedWithAnimationDuration:BRICKVIEW_OPEN_DOOR_DURATION];
+    [[GameScheduler instance] performBlock:^{
+        [self layoutSubviews];
+    } afterDelay:BRICKVIEW_OPEN_DOOR_DURATION];
 }
 
 - (void)showMoveableLocations:(cv::vector<cv::Point>)locations {
     [moveableLocationsView showLocations:locations];
+    [self projectionChangedWithAnimationDuration:(MOVEABLE_LOCATIONS_REAPPEAR_DURATION + MOVEABLE_LOCATIONS_APPEAR_DURATION)];
 }
 
 - (void)hideMoveableLocations {
     [moveableLocationsView hideLocations];
+    [self projectionChangedWithAnimationDuration:MOVEABLE_LOCATIONS_APPEAR_DURATION];
 }
 
 - (bool)hasBrickAtPosition:(cv::Point)position {
@@ -260,24 +394,66 @@ Board *boardInstance = nil;
 }
 
 - (bool)hasObjectAtPosition:(cv::Point)position {
-    return position.x >= 0 && position.y >= 0 && position.x < BOARD_WIDTH && position.y < BOARD_HEIGHT && objectMap[position.y][position.x] != -1;
+    return position.x >= 0 && position.y >= 0 && position.x < BOARD_WIDTH && position.y < BOARD_HEIGHT && objectMap[position.y][position.x] != nil;
+}
+
+- (GameObject *)objectAtPosition:(cv::Point)position {
+    return position.x >= 0 && position.y >= 0 && position.x < BOARD_WIDTH && position.y < BOARD_HEIGHT ? objectMap[position.y][position.x] : nil;
 }
 
 - (BrickView *)brickViewAtPosition:(cv::Point)p {
-    for (BrickView *brickView in brickViews) {
-        if (p.x >= brickView.position.x && p.x < brickView.position.x + brickView.size.width &&
-            p.y >= brickView.position.y && p.y < brickView.position.y + brickView.size.height) {
-            return brickView;
-        }
+    if (p.x < 0 || p.y < 0 || p.x >= BOARD_WIDTH || p.y >= BOARD_HEIGHT || brickIndexMap[p.y][p.x] == -1) {
+        return nil;
     }
-    return nil;
+    return [brickViews objectAtIndex:brickIndexMap[p.y][p.x]];
 }
 
 - (void)initializeFigures {
+    figureRegistry.clear();
+    memset(figures, 0, sizeof(figures));
     [self initializeHeroFigures];
     [self initializeMonsterFigures];
 }
 
+- (void)registerFigure:(MoveableGameObject *)object kind:(int)kind {
+    int index = figureRegistry.add(kind, object.position);
+    if (index == -1) {
+        NSLog(@"Too many figures on board");
+        return;
+    }
+    figures[index] = object;
+    object.figureIndex = index;
+    [self figureChanged:object];
+}
+
+- (void)projectionChangedWithAnimationDuration:(double)duration {
+    projectionVersion++;
+    projectionSettledTime = MAX(projectionSettledTime, [GameScheduler instance].now + duration);
+}
+
+- (bool)projectionSettled {
+    return [GameScheduler instance].now >= projectionSettledTime;
+}
+
+- (void)figureChanged:(GameObject *)object {
+    if (object.figureIndex == -1 || figures[object.figureIndex] != object) {
+        return;
+    }
+    figureRegistry.setPosition(object.figureIndex, object.position);
+    figureRegistry.setFlag(object.figureIndex, FIGURE_FLAG_VISIBLE, object.visible);
+    figureRegistry.setFlag(object.figureIndex, FIGURE_FLAG_ACTIVE, object.active);
+    figureRegistry.setFlag(object.figureIndex, FIGURE_FLAG_RECOGNIZED, object.recognizedOnBoard);
+}
+
+- (void)removeHeroFigure:(HeroFigure *)hero {
+    if (hero.figureIndex != -1 && figures[hero.figureIndex] == hero) {
+        figureRegistry.remove(hero.figureIndex);
+        figures[hero.figureIndex] = nil;
+    }
+    hero.figureIndex = -1;
+    [heroFigures removeObject:hero];
+}
+
 - (void)initializeHeroFigures {
     if (heroFigures != nil) {
         for (HeroFigure *hero in heroFigures) {
@@ -285,12 +461,13 @@ Board *boardInstance = nil;
         }
     }
     heroFigures = [NSMutableArray array];
-    [heroFigures addObject:[[HeroFigure alloc] initWithPosition:cv::Point(4, 3) type:HERO_WIZARD]];
-    [heroFigures addObject:[[HeroFigure alloc] initWithPosition:cv::Point(5, 5) type:HERO_WARRIOR]];
-    [heroFigures addObject:[[HeroFigure alloc] initWithPosition:cv::Point(6, 4) type:HERO_DWERF]];
-    [heroFigures addObject:[[HeroFigure alloc] initWithPosition:cv::Point(7, 3) type:HERO_ELF]];
+    for (int i = 0; i < levelImage.header().heroCount; i++) {
+        const LevelImageFigure &hero = levelImage.heroes()[i];
+        [heroFigures addObject:[[HeroFigure alloc] initWithPosition:cv::Point(hero.x, hero.y) type:hero.type]];
+    }
     for (HeroFigure *hero in heroFigures) {
         [self addSubview:hero];
+        [self registerFigure:hero kind:FIGURE_FLAG_HERO];
     }
     [self refreshObjectMap];
 }
@@ -302,120 +479,51 @@ Board *boardInstance = nil;
         }
     }
     monsterFigures = [NSMutableArray array];
-    [monsterFigures addObject:[[MonsterFigure alloc] initWithPosition:cv::Point(12, 10) type:MONSTER_GLOBNIC]];
-    [monsterFigures addObject:[[MonsterFigure alloc] initWithPosition:cv::Point(1, 9) type:MONSTER_GLOBNIC]];
-    [monsterFigures addObject:[[MonsterFigure alloc] initWithPosition:cv::Point(15, 8) type:MONSTER_GLOBNIC]];
-    [monsterFigures addObject:[[MonsterFigure alloc] initWithPosition:cv::Point(10, 16) type:MONSTER_GLOBNIC]];
+    for (int i = 0; i < levelImage.header().monsterCount; i++) {
+        const LevelImageFigure &monster = levelImage.monsters()[i];
+        [monsterFigures addObject:[[MonsterFigure alloc] initWithPosition:cv::Point(monster.x, monster.y) type:monster.type]];
+    }
     for (MonsterFigure *monster in monsterFigures) {
         [self addSubview:monster];
+        [self registerFigure:monster kind:FIGURE_FLAG_MONSTER];
     }
     [self refreshObjectMap];
 }
 
-- (cv::vector<cv::Point>)randomControlPoints:(int)count {
-    cv::vector<cv::Point> controlPoints;
-    int drawSize = brickPositions.size();
-    int indices[drawSize];
-    for (int i = 0; i < drawSize; i++) {
-        indices[i] = i;
-    }
-    while (drawSize > 0 && controlPoints.size() < count) {
-        int index = rand() % drawSize;
-        cv::Point position = brickPositions[indices[index]];
-        if (![self hasObjectAtPosition:position]) {
-            controlPoints.push_back(position);
-        }
-        indices[index] = indices[drawSize - 1];
-        drawSize--;
-    }
-    return controlPoints;
+- (FigureRange)figuresInView:(int)view {
+    return FigureRange(figureRegistry.view(view), figures);
 }
 
-- (NSMutableArray *)boardObjects {
-    NSMutableArray *figures = [NSMutableArray array];
-    [figures addObjectsFromArray:heroFigures];
-    [figures addObjectsFromArray:monsterFigures];
-    return figures;
+- (FigureRange)boardObjects {
+    return [self figuresInView:FIGURE_VIEW_BOARD_OBJECTS];
 }
 
-- (NSMutableArray *)visibleBoardObjects {
-    NSMutableArray *figures = [NSMutableArray array];
-    for (MoveableGameObject *object in heroFigures) {
-        if (object.visible) {
-            [figures addObject:object];
-        }
-    }
-    for (MoveableGameObject *object in monsterFigures) {
-        if (object.visible) {
-            [figures addObject:object];
-        }
-    }
-    return figures;
+- (FigureRange)visibleBoardObjects {
+    return [self figuresInView:FIGURE_VIEW_VISIBLE_BOARD_OBJECTS];
 }
 
-- (NSMutableArray *)activeBoardObjects {
-    NSMutableArray *figures = [NSMutableArray array];
-    for (MoveableGameObject *object in heroFigures) {
-        if (object.visible && object.active) {
-            [figures addObject:object];
-        }
-    }
-    for (MoveableGameObject *object in monsterFigures) {
-        if (object.visible && object.active) {
-            [figures addObject:object];
-        }
-    }
-    return figures;
+- (FigureRange)activeBoardObjects {
+    return [self figuresInView:FIGURE_VIEW_ACTIVE_BOARD_OBJECTS];
 }
 
-- (NSMutableArray *)visibleMonsterFigures {
-    NSMutableArray *figures = [NSMutableArray array];
-    for (MoveableGameObject *object in monsterFigures) {
-        if (object.visible) {
-            [figures addObject:object];
-        }
-    }
-    return figures;
+- (FigureRange)visibleMonsterFigures {
+    return [self figuresInView:FIGURE_VIEW_VISIBLE_MONSTERS];
 }
 
-- (NSMutableArray *)invisibleMonsterFigures {
-    NSMutableArray *figures = [NSMutableArray array];
-    for (MoveableGameObject *object in monsterFigures) {
-        if (!object.visible) {
-            [figures addObject:object];
-        }
-    }
-    return figures;
+- (FigureRange)invisibleMonsterFigures {
+    return [self figuresInView:FIGURE_VIEW_INVISIBLE_MONSTERS];
 }
 
-- (NSMutableArray *)activeMonsterFigures {
-    NSMutableArray *figures = [NSMutableArray array];
-    for (MoveableGameObject *object in monsterFigures) {
-        if (object.active) {
-            [figures addObject:object];
-        }
-    }
-    return figures;
+- (FigureRange)activeMonsterFigures {
+    return [self figuresInView:FIGURE_VIEW_ACTIVE_MONSTERS];
 }
 
-- (NSMutableArray *)unrecognizedActiveMonsterFigures {
-    NSMutableArray *figures = [NSMutableArray array];
-    for (MoveableGameObject *object in monsterFigures) {
-        if (!object.recognizedOnBoard && object.active) {
-            [figures addObject:object];
-        }
-    }
-    return figures;
+- (FigureRange)unrecognizedActiveMonsterFigures {
+    return [self figuresInView:FIGURE_VIEW_UNRECOGNIZED_ACTIVE_MONSTERS];
 }
 
-- (NSMutableArray *)unrecognizedHeroFigures {
-    NSMutableArray *figures = [NSMutableArray array];
-    for (MoveableGameObject *object in heroFigures) {
-        if (!object.recognizedOnBoard) {
-            [figures addObject:object];
-        }
-    }
-    return figures;
+- (FigureRange)unrecognizedHeroFigures {
+    return [self figuresInView:FIGURE_VIEW_UNRECOGNIZED_HEROES];
 }
 
 @end
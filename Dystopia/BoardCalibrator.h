@@ -27,12 +27,22 @@
 
 #import "BoardRecognizer.h"
 #import "CameraSession.h"
+#import "SnapshotExchange.h"
 #import "Util.h"
+#import "VisionEvent.h"
 
 #define BOARD_CALIBRATION_STATE_UNCALIBRATED 0
 #define BOARD_CALIBRATION_STATE_CALIBRATING  1
 #define BOARD_CALIBRATION_STATE_CALIBRATED   2
 
+typedef struct {
+    cv::Mat image;
+    BoardBounds boardBounds;
+    unsigned long long frameSequenceNumber;
+} BoardSnapshot;
+
+typedef SnapshotExchange<BoardSnapshot>::Reference BoardSnapshotReference;
+
 @interface BoardCalibrator : UIView
 
 + (BoardCalibrator *)instance;
@@ -40,13 +50,19 @@
 - (void)initializeWithFrame:(CGRect)frame;
 
 - (void)updateBoundsWithImage:(cv::Mat)image;
+- (void)updateBoundsWithImage:(cv::Mat)image blurredImage:(cv::Mat)blurredImage intensityRange:(IntensityRange)intensityRange;
 
 - (cv::Mat)perspectiveCorrectImage:(cv::Mat)image;
+- (void)perspectiveCorrectImage:(cv::Mat)image intoImage:(cv::Mat &)outputImage;
+
+- (BoardSnapshotReference)boardSnapshot;
+
+// Board found, lost and obstructed events; single consumer
+- (bool)nextBoardEvent:(VisionEvent &)event;
 
 @property (nonatomic, readonly) int state;
 @property (nonatomic, readonly) BoardBounds boardBounds;
-@property (nonatomic, readonly) cv::Mat boardImage;
-@property (nonatomic, retain) NSObject *boardImageLock;
+@property (nonatomic, readonly) unsigned long long frameSequenceNumber;
 @property (nonatomic, readonly) FourPoints screenPoints;
 
 @end
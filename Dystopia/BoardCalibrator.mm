@@ -34,6 +34,13 @@
     
     CFAbsoluteTime successTime;
     CFAbsoluteTime lastUpdateTime;
+
+    SnapshotExchange<BoardSnapshot> boardSnapshots;
+
+    BoardRecognitionContext recognitionContext;
+
+    VisionEventQueue boardEvents;
+    int lastBoardEventType;
 }
 
 @end
@@ -45,8 +52,7 @@ BoardCalibrator *boardCalibratorInstance = nil;
 @synthesize state;
 @synthesize boardBounds;
 @synthesize screenPoints;
-@synthesize boardImage;
-@synthesize boardImageLock;
+@synthesize frameSequenceNumber;
 
 + (BoardCalibrator *)instance {
     @synchronized(self) {
@@ -59,7 +65,8 @@ BoardCalibrator *boardCalibratorInstance = nil;
 
 - (id)init {
     if (self = [super init]) {
-        boardImageLock = [[NSObject alloc] init];
+        frameSequenceNumber = 0;
+        lastBoardEventType = VISION_EVENT_BOARD_LOST;
     }
     return self;
 }
@@ -75,17 +82,29 @@ BoardCalibrator *boardCalibratorInstance = nil;
 }
 
 - (void)updateBoundsWithImage:(cv::Mat)image {
-    boardBounds = [[BoardRecognizer instance] findBoardBoundsFromImage:image];
+    cv::Mat blurredImage;
+    IntensityRange intensityRange = preprocessFrame(image, blurredImage);
+    [self updateBoundsWithImage:image blurredImage:blurredImage intensityRange:intensityRange];
+}
+
+- (void)updateBoundsWithImage:(cv::Mat)image blurredImage:(cv::Mat)blurredImage intensityRange:(IntensityRange)intensityRange {
+    frameSequenceNumber++;
+    boardBounds = [[BoardRecognizer instance] findBoardBoundsFromImage:image blurredImage:blurredImage intensityRange:intensityRange context:recognitionContext];
     if (boardBounds.bounds.defined) {
         state = BOARD_CALIBRATION_STATE_CALIBRATED;
-        @synchronized(boardImageLock) {
-            boardImage = [self perspectiveCorrectImage:image];
+
+        // Warp into a free pooled buffer and publish it; readers never block the camera queue
+        BoardSnapshot snapshot = {.boardBounds = boardBounds, .frameSequenceNumber = frameSequenceNumber};
+        [self perspectiveCorrectImage:image intoImage:snapshot.image];
+        if (![self publishBoardSnapshot:snapshot] && DEBUG) {
+            NSLog(@"Dropped board snapshot %llu", frameSequenceNumber);
         }
         //[cameraSession lock];
     } else {
         state = BOARD_CALIBRATION_STATE_CALIBRATING;
         //[cameraSession unlock];
     }
+    [self emitBoardEvent];
     if (DEBUG) {
         dispatch_async(dispatch_get_main_queue(), ^{
             calibrationStateView.backgroundColor = boardBounds.bounds.defined ? [UIColor greenColor] : [UIColor redColor];
@@ -97,6 +116,36 @@ BoardCalibrator *boardCalibratorInstance = nil;
     return [[BoardRecognizer instance] perspectiveCorrectImage:image fromBoardBounds:boardBounds.bounds];
 }
 
+- (void)perspectiveCorrectImage:(cv::Mat)image intoImage:(cv::Mat &)outputImage {
+    [[BoardRecognizer instance] perspectiveCorrectImage:image intoImage:outputImage fromBoardBounds:boardBounds.bounds];
+}
+
+- (bool)publishBoardSnapshot:(BoardSnapshot &)snapshot {
+    return boardSnapshots.publish(snapshot);
+}
+
+- (BoardSnapshotReference)boardSnapshot {
+    return boardSnapshots.latest();
+}
+
+- (bool)nextBoardEvent:(VisionEvent &)event {
+    return boardEvents.pop(event);
+}
+
+- (void)emitBoardEvent {
+    int type = !boardBounds.bounds.defined ? VISION_EVENT_BOARD_LOST : (boardBounds.isBoundsObstructed ? VISION_EVENT_BOARD_OBSTRUCTED : VISION_EVENT_BOARD_FOUND);
+    if (type == lastBoardEventType) {
+        return;
+    }
+
+    // The detector either finds the board or not, hence full confidence. If the queue is full, retry on next frame
+    if (boardEvents.push(visionEvent(type, frameSequenceNumber, 1.0f))) {
+        lastBoardEventType = type;
+    } else if (DEBUG) {
+        NSLog(@"Dropped board event %i of frame %llu", type, frameSequenceNumber);
+    }
+}
+
 - (void)addCalibrationStateView {
     calibrationStateView = [[UIView alloc] initWithFrame:CGRectMake([BoardUtil instance].singleBrickScreenSize.width - 10.0f, [BoardUtil instance].singleBrickScreenSize.height - 10.0f, 10.0f, 10.0f)];
     calibrationStateView.backgroundColor = [UIColor clearColor];
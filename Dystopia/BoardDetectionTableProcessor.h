@@ -0,0 +1,66 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+#include <mutex>
+
+#import "BoardCalibrator.h"
+#import "BrickRecognitionWorker.h"
+#import "TableProcessingServer.h"
+
+// Board detection and brick recognition of one table for the table processing server. Keeps its own recognition
+// context, so tables detect concurrently on the shared recognizer, and publishes each frame's board bounds and
+// perspective corrected board image the same way the board calibrator does for the device camera.
+//
+// The game of the table asks for brick recognition like it asks the brick recognition worker. The request is run on the
+// next frame in which the board is found, against that frame's board image, and its results are read with nextEvent.
+class BoardDetectionTableProcessor : public TableProcessor {
+public:
+    BoardDetectionTableProcessor();
+
+    void processFrame(const cv::Mat &image, unsigned long long frameSequenceNumber);
+
+    BoardSnapshotReference boardSnapshot();
+
+    // Replaces any request not yet run. The snapshot of the request is ignored; the table's own board image is used.
+    // Requests should be projection aware, as only that path leaves the device's control point manager alone
+    void requestBrickRecognition(const BrickRecognitionRequest &request);
+
+    // Results of brick recognition requests; single consumer
+    bool nextEvent(VisionEvent &event);
+
+private:
+    void recognizeBricks();
+
+    BoardRecognitionContext recognitionContext;
+    SnapshotExchange<BoardSnapshot> boardSnapshots;
+
+    std::mutex requestMutex;
+    BrickRecognitionRequest brickRecognitionRequest;
+    bool hasBrickRecognitionRequest;
+
+    VisionEventQueue events;
+};
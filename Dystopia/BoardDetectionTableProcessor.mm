@@ -0,0 +1,83 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "BoardDetectionTableProcessor.h"
+#import "BoardRecognizer.h"
+
+BoardDetectionTableProcessor::BoardDetectionTableProcessor() : hasBrickRecognitionRequest(false) {
+}
+
+void BoardDetectionTableProcessor::processFrame(const cv::Mat &image, unsigned long long frameSequenceNumber) {
+    @autoreleasepool {
+        cv::Mat blurredImage;
+        IntensityRange intensityRange = preprocessFrame(image, blurredImage);
+
+        BoardSnapshot snapshot = {.frameSequenceNumber = frameSequenceNumber};
+        snapshot.boardBounds = [[BoardRecognizer instance] findBoardBoundsFromImage:image blurredImage:blurredImage intensityRange:intensityRange context:recognitionContext];
+        if (snapshot.boardBounds.bounds.defined) {
+            [[BoardRecognizer instance] perspectiveCorrectImage:image intoImage:snapshot.image fromBoardBounds:snapshot.boardBounds.bounds];
+        }
+        if (!boardSnapshots.publish(snapshot)) {
+            if (DEBUG) {
+                NSLog(@"Dropped table board snapshot %llu", frameSequenceNumber);
+            }
+            return;
+        }
+        if (snapshot.boardBounds.bounds.defined) {
+            recognizeBricks();
+        }
+    }
+}
+
+void BoardDetectionTableProcessor::recognizeBricks() {
+    BrickRecognitionRequest request;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        if (!hasBrickRecognitionRequest) {
+            return;
+        }
+        request = brickRecognitionRequest;
+        hasBrickRecognitionRequest = false;
+    }
+
+    // Frames of a table are never processed concurrently, so the latest snapshot is the one just published
+    request.snapshot = boardSnapshots.latest();
+    [[BrickRecognitionWorker instance] recognizeRequest:request events:events];
+}
+
+BoardSnapshotReference BoardDetectionTableProcessor::boardSnapshot() {
+    return boardSnapshots.latest();
+}
+
+void BoardDetectionTableProcessor::requestBrickRecognition(const BrickRecognitionRequest &request) {
+    std::lock_guard<std::mutex> lock(requestMutex);
+    brickRecognitionRequest = request;
+    brickRecognitionRequest.snapshot = BoardSnapshotReference();
+    hasBrickRecognitionRequest = true;
+}
+
+bool BoardDetectionTableProcessor::nextEvent(VisionEvent &event) {
+    return events.pop(event);
+}
@@ -47,7 +47,8 @@
 
 - (void)startWithLevel:(int)l;
 
-- (void)update;
+// Main thread; called once the board calibrator is done with a camera frame
+- (void)frameProcessed:(unsigned long long)frameSequenceNumber;
 
 @property (nonatomic, retain) id<BoardGameProtocol> delegate;
 
@@ -26,22 +26,46 @@
 #import "BoardGame.h"
 #import "BoardCalibrator.h"
 #import "BrickRecognizer.h"
+#import "BrickRecognitionWorker.h"
 #import "ExternalDisplay.h"
 #import "PreviewableViewController.h"
+#import "UIImage+OpenCV.h"
+#import "UIImage+CaptureScreen.h"
+#import "MoveAssignmentSolver.h"
+#import "ControlPointManager.h"
+#import "GameScheduler.h"
+#import "TurnTiming.h"
 
-#define BOARD_GAME_NEXT_OBJECT_DELAY 1.5f
-#define BOARD_GAME_NEXT_OBJECT_PAUSE 1.0f
+#define BOARD_GAME_CONTROL_POINT_COUNT 10
+
+#define BOARD_GAME_PROJECTION_AWARE_RECOGNITION YES
+#define BOARD_GAME_SIMULTANEOUS_HERO_MOVES YES
 
 @interface BoardGame () {
     UIView *boardRecognizedView;
 
     NSMutableArray *objectsToMoveInTurn;
     MoveableGameObject *objectToMove;
+
+    NSMutableArray *movedObjectsInTurn;
+    cv::vector<cv::vector<cv::Point>> simultaneousReachablePositions;
+    cv::vector<cv::Point> simultaneousMoveablePositions;
     
     NSMutableArray *heroFigureMoveOrder;
     
     bool isUpdating;
     bool readyForBrickRecognition;
+
+    int recognitionGeneration;
+    int lastRequestedGeneration;
+    unsigned long long lastRequestedFrameSequenceNumber;
+    unsigned long long lastProcessedFrameSequenceNumber;
+
+    bool boardVisible;
+    OccupancyChange occupancyChange;
+
+    cv::Mat projectedImage;
+    int projectedImageVersion;
 }
 
 @end
@@ -74,19 +98,29 @@ BoardGame *boardGameInstance;
     state = BOARD_GAME_STATE_INITIALIZING;
     isUpdating = NO;
     readyForBrickRecognition = NO;
+    recognitionGeneration = 0;
+    lastRequestedGeneration = -1;
+    lastRequestedFrameSequenceNumber = 0;
+    lastProcessedFrameSequenceNumber = 0;
+    boardVisible = NO;
+    projectedImageVersion = -1;
     [self addSubview:[Board instance]];
 }
 
 - (void)startWithLevel:(int)l {
     level = l;
     [[Board instance] loadLevel:level];
-    [self startUpdateTimer];
     NSLog(@"Level %i started", level + 1);
 }
 
-- (void)startUpdateTimer {
-    NSTimer* timer = [NSTimer timerWithTimeInterval:0.1f target:self selector:@selector(update) userInfo:nil repeats:YES];
-    [[NSRunLoop mainRunLoop] addTimer:timer forMode:NSRunLoopCommonModes];
+- (void)frameProcessed:(unsigned long long)frameSequenceNumber {
+
+    // Notifications are posted in frame order, so an older one only arrives late and has nothing new to evaluate
+    if (frameSequenceNumber <= lastProcessedFrameSequenceNumber) {
+        return;
+    }
+    lastProcessedFrameSequenceNumber = frameSequenceNumber;
+    [self update];
 }
 
 - (void)update {
@@ -97,31 +131,147 @@ BoardGame *boardGameInstance;
         isUpdating = YES;
     }
     @try {
+        [self processBoardEvents];
         if (state == BOARD_GAME_STATE_INITIALIZING) {
             if ([self isBoardReadyForStateUpdate]) {
                 state = BOARD_GAME_WAITING_FOR_INITIALIZED;
-                [self performSelector:@selector(startPlaceHeroes) withObject:nil afterDelay:BRICKVIEW_OPEN_DOOR_DURATION];
+                [[GameScheduler instance] performBlock:^{
+                    [self startPlaceHeroes];
+                } afterDelay:BRICKVIEW_OPEN_DOOR_DURATION];
             }
             return;
         }
-        [self recognizeMonsters];
-        if (state == BOARD_GAME_STATE_PLACE_HEROES) {
-            [self updatePlaceHeroes];
+        [self requestBrickRecognition];
+    } @finally {
+        isUpdating = NO;
+    }
+}
+
+- (void)requestBrickRecognition {
+    if (![self isBoardReadyForStateUpdate] || [BrickRecognitionWorker instance].busy) {
+        return;
+    }
+    BrickRecognitionRequest request;
+    request.snapshot = [[BoardCalibrator instance] boardSnapshot];
+    if (!request.snapshot.isValid()) {
+        return;
+    }
+
+    // Nothing new to recognize until either the camera or the game state has moved on
+    if (request.snapshot->frameSequenceNumber == lastRequestedFrameSequenceNumber && recognitionGeneration == lastRequestedGeneration) {
+        return;
+    }
+    if (![self prepareRecognitionRequest:request]) {
+        return;
+    }
+    request.tag = recognitionGeneration;
+    request.projectionAware = BOARD_GAME_PROJECTION_AWARE_RECOGNITION;
+    if (request.projectionAware) {
+
+        // The projection is rendered from the views' model layers, which already hold the end state of running
+        // animations, so wait until what is projected matches it
+        if (![Board instance].projectionSettled) {
             return;
         }
-        if (state == BOARD_GAME_STATE_PLAYERS_TURN_INITIAL) {
-            [self updatePlayersTurnInitial];
+        request.projectedImage = [self projectedBoardImage];
+    } else {
+        request.controlPoints = [[ControlPointManager instance] controlPointsWithCount:BOARD_GAME_CONTROL_POINT_COUNT inImage:request.snapshot->image];
+    }
+    if ([[BrickRecognitionWorker instance] processRequest:request completion:^{
+        [self processRecognitionEvents];
+
+        // Pick up the newest frame that arrived while the worker was busy
+        [self update];
+    }]) {
+        lastRequestedFrameSequenceNumber = request.snapshot->frameSequenceNumber;
+        lastRequestedGeneration = request.tag;
+    }
+}
+
+- (bool)prepareRecognitionRequest:(BrickRecognitionRequest &)request {
+    request.recognizeMovement = NO;
+    request.recognizeOccupancyChange = NO;
+    if (readyForBrickRecognition) {
+        for (MoveableGameObject *monsterFigure : [[Board instance] unrecognizedActiveMonsterFigures]) {
+            request.figureLocations.push_back(monsterFigure.position);
         }
-        if (state == BOARD_GAME_STATE_PLAYERS_TURN || state == BOARD_GAME_STATE_PLAYERS_TURN_INITIAL) {
-            [self updatePlayersTurn];
-            return;
+        if (state == BOARD_GAME_STATE_PLACE_HEROES || state == BOARD_GAME_STATE_PLAYERS_TURN_INITIAL) {
+            for (MoveableGameObject *hero : [[Board instance] unrecognizedHeroFigures]) {
+                request.figureLocations.push_back(hero.position);
+            }
         }
-        if (state == BOARD_GAME_STATE_MONSTERS_TURN) {
-            [self updateMonstersTurn];
-            return;
+        if ([self isSimultaneousMoveTurn]) {
+            for (MoveableGameObject *object in objectsToMoveInTurn) {
+                request.occupancyPositions.push_back(object.position);
+            }
+            request.occupancyLocations = simultaneousMoveablePositions;
+            request.recognizeOccupancyChange = YES;
+        }
+    }
+    if (objectToMove != nil && ![self isSimultaneousMoveTurn] && (state == BOARD_GAME_STATE_PLAYERS_TURN || state == BOARD_GAME_STATE_PLAYERS_TURN_INITIAL || state == BOARD_GAME_STATE_MONSTERS_TURN)) {
+        request.movementLocations = [objectToMove floodFillMoveablePositions];
+        request.recognizeMovement = YES;
+    }
+    return request.figureLocations.size() > 0 || request.recognizeMovement || request.recognizeOccupancyChange;
+}
+
+- (void)processBoardEvents {
+    VisionEvent event;
+    while ([[BoardCalibrator instance] nextBoardEvent:event]) {
+        boardVisible = event.type == VISION_EVENT_BOARD_FOUND;
+    }
+}
+
+- (void)processRecognitionEvents {
+    [self processBoardEvents];
+    occupancyChange = OccupancyChange();
+    VisionEvent event;
+    while ([[BrickRecognitionWorker instance] nextEvent:event]) {
+
+        // The game moved on since the event was requested - positions were searched for a turn that is over
+        if (event.requestTag != recognitionGeneration) {
+            continue;
+        }
+        [self handleVisionEvent:event];
+    }
+    [self endRecognitionEvents];
+}
+
+- (void)handleVisionEvent:(VisionEvent)event {
+    switch (event.type) {
+        case VISION_EVENT_FIGURE_RECOGNIZED:
+            [self figureRecognizedAtPosition:event.position];
+            break;
+        case VISION_EVENT_CELL_OCCUPIED:
+            if ([self isSimultaneousMoveTurn]) {
+                occupancyChange.occupied.push_back(event.position);
+                occupancyChange.occupiedConfidences.push_back(event.confidence);
+            } else if ([self updateObjectMovementWithPosition:event.position]) {
+                [self endTurn];
+            }
+            break;
+        case VISION_EVENT_CELL_VACATED:
+            occupancyChange.vacated.push_back(event.position);
+            occupancyChange.vacatedConfidences.push_back(event.confidence);
+            break;
+    }
+}
+
+- (void)endRecognitionEvents {
+    if (state == BOARD_GAME_STATE_PLACE_HEROES) {
+        [self updatePlaceHeroes];
+        return;
+    }
+    if (state == BOARD_GAME_STATE_PLAYERS_TURN_INITIAL) {
+        [self updatePlayersTurnInitial];
+        return;
+    }
+    if ([self isSimultaneousMoveTurn] && occupancyChange.vacated.size() > 0) {
+        if ([self updateSimultaneousObjectMovementWithOccupancyChange:occupancyChange]) {
+            [[GameScheduler instance] performBlock:^{
+                [self nextSimultaneousObjectsTurnAfterPause];
+            } afterDelay:BOARD_GAME_NEXT_OBJECT_DELAY];
         }
-    } @finally {
-        isUpdating = NO;
     }
 }
 
@@ -129,7 +279,9 @@ BoardGame *boardGameInstance;
     NSLog(@"Starting place heroes");
     state = BOARD_GAME_STATE_PLACE_HEROES;
     readyForBrickRecognition = YES;
+    recognitionGeneration++;
     heroFigureMoveOrder = [NSMutableArray array];
+    movedObjectsInTurn = [NSMutableArray array];
     for (HeroFigure *hero in [Board instance].heroFigures) {
         [hero showBrick];
     }
@@ -165,7 +317,11 @@ BoardGame *boardGameInstance;
 - (void)startMonstersTurn {
     NSLog(@"Starting monsters turn");
     state = BOARD_GAME_STATE_MONSTERS_TURN;
-    [self setObjectsToMove:[[Board instance] activeMonsterFigures]];
+    objectsToMoveInTurn = [NSMutableArray array];
+    for (MoveableGameObject *monsterFigure : [[Board instance] activeMonsterFigures]) {
+        [objectsToMoveInTurn addObject:monsterFigure];
+    }
+    [[Board instance] planMonstersTurn];
 }
 
 - (void)setObjectsToMove:(NSMutableArray *)objects {
@@ -179,17 +335,29 @@ BoardGame *boardGameInstance;
 
 - (void)nextObjectTurnAfterPause {
     readyForBrickRecognition = NO;
+    recognitionGeneration++;
     [self hideMarkers];
     if ([objectToMove isKindOfClass:[HeroFigure class]] && [[Board instance] shouldOpenDoorAtPosition:objectToMove.position]) {
         [[Board instance] openDoorAtPosition:objectToMove.position];
-        [self performSelector:@selector(nextObjectTurn) withObject:nil afterDelay:(BRICKVIEW_OPEN_DOOR_DURATION + BOARD_GAME_NEXT_OBJECT_PAUSE)];
+        [self nextObjectTurnAfterDelay:(BRICKVIEW_OPEN_DOOR_DURATION + BOARD_GAME_NEXT_OBJECT_PAUSE)];
     } else {
-        [self performSelector:@selector(nextObjectTurn) withObject:nil afterDelay:BOARD_GAME_NEXT_OBJECT_PAUSE];
+        [self nextObjectTurnAfterDelay:BOARD_GAME_NEXT_OBJECT_PAUSE];
     }
 }
 
+- (void)nextObjectTurnAfterDelay:(double)delay {
+    [[GameScheduler instance] performBlock:^{
+        [self nextObjectTurn];
+    } afterDelay:delay];
+}
+
 - (void)nextObjectTurn {
+    if ([self isSimultaneousMoveTurn]) {
+        [self nextSimultaneousObjectsTurn];
+        return;
+    }
     readyForBrickRecognition = YES;
+    recognitionGeneration++;
     [self hideMarkers];
     if (objectToMove != nil) {
         [objectsToMoveInTurn removeObject:objectToMove];
@@ -207,38 +375,94 @@ BoardGame *boardGameInstance;
     }
     if (objectToMove != nil) {
         NSLog(@"Object %i turn", objectToMove.type);
-        [[Board instance] showMoveableLocations:[objectToMove floodFillMoveablePositions]];
+        [[Board instance] showMoveableLocations:[self moveableLocationsForObject:objectToMove]];
     } else {
         [self startNewTurns];
     }
 }
 
+- (cv::vector<cv::Point>)moveableLocationsForObject:(MoveableGameObject *)object {
+
+    // Game master: monsters are shown where to go
+    cv::Point destination;
+    if ([object isKindOfClass:[MonsterFigure class]] && [[Board instance] recommendedDestinationForMonster:object destination:destination]) {
+        NSLog(@"Monster %i heading for %i, %i", object.type, destination.x, destination.y);
+        return cv::vector<cv::Point>(1, destination);
+    }
+    return [object floodFillMoveablePositions];
+}
+
+- (void)nextSimultaneousObjectsTurn {
+    readyForBrickRecognition = YES;
+    recognitionGeneration++;
+    [self hideMarkers];
+    objectToMove = nil;
+    [[Board instance] refreshBrickMap];
+    [[Board instance] refreshObjectMap];
+    if (objectsToMoveInTurn.count == 0) {
+        [self startNewTurns];
+        return;
+    }
+
+    // Reachable sets are taken with all remaining figures in place, so no move depends on another figure moving first
+    bool moveableMap[BOARD_HEIGHT][BOARD_WIDTH] = {{false}};
+    simultaneousReachablePositions.clear();
+    simultaneousMoveablePositions.clear();
+    for (MoveableGameObject *object in objectsToMoveInTurn) {
+        cv::vector<cv::Point> reachablePositions = [object floodFillMoveablePositions];
+        for (int i = 0; i < reachablePositions.size(); i++) {
+            cv::Point p = reachablePositions[i];
+            if (!moveableMap[p.y][p.x]) {
+                moveableMap[p.y][p.x] = true;
+                simultaneousMoveablePositions.push_back(p);
+            }
+        }
+        simultaneousReachablePositions.push_back(reachablePositions);
+        [self showPulsingMarkerViewForObject:object];
+    }
+    NSLog(@"%i objects turn", (int)objectsToMoveInTurn.count);
+    [[Board instance] showMoveableLocations:simultaneousMoveablePositions];
+}
+
+- (void)nextSimultaneousObjectsTurnAfterPause {
+    [self hideMarkers];
+    bool openedDoor = NO;
+    for (MoveableGameObject *object in movedObjectsInTurn) {
+        if ([object isKindOfClass:[HeroFigure class]] && [[Board instance] shouldOpenDoorAtPosition:object.position]) {
+            [[Board instance] openDoorAtPosition:object.position];
+            openedDoor = YES;
+        }
+    }
+    movedObjectsInTurn = [NSMutableArray array];
+    [self nextObjectTurnAfterDelay:(openedDoor ? BRICKVIEW_OPEN_DOOR_DURATION + BOARD_GAME_NEXT_OBJECT_PAUSE : BOARD_GAME_NEXT_OBJECT_PAUSE)];
+}
+
+- (bool)isSimultaneousMoveTurn {
+    return BOARD_GAME_SIMULTANEOUS_HERO_MOVES && state == BOARD_GAME_STATE_PLAYERS_TURN;
+}
+
 - (void)endTurn {
-    [self performSelector:@selector(nextObjectTurnAfterPause) withObject:nil afterDelay:BOARD_GAME_NEXT_OBJECT_DELAY];
+    [[GameScheduler instance] performBlock:^{
+        [self nextObjectTurnAfterPause];
+    } afterDelay:BOARD_GAME_NEXT_OBJECT_DELAY];
 }
 
 - (void)hideMarkers {
     [[Board instance] hideMoveableLocations];
-    for (GameObject *object in [[Board instance] boardObjects]) {
+    for (GameObject *object : [[Board instance] boardObjects]) {
         [object hideMarker];
     }
 }
 
 - (void)disableNonRecognizedHeroes {
-    NSMutableArray *remainingFigures = [NSMutableArray array];
-    for (HeroFigure *hero in [Board instance].heroFigures) {
-        if (!hero.recognizedOnBoard) {
-            [hero hideBrick];
-            hero.active = NO;
-        } else {
-            [remainingFigures addObject:hero];
-        }
+    for (MoveableGameObject *hero : [[Board instance] unrecognizedHeroFigures]) {
+        [hero hideBrick];
+        hero.active = NO;
+        [[Board instance] removeHeroFigure:(HeroFigure *)hero];
     }
-    [Board instance].heroFigures = remainingFigures;
 }
 
 - (void)updatePlayersTurnInitial {
-    [self updateInitialHeroPositions];
     for (HeroFigure *hero in [Board instance].heroFigures) {
         if (hero != objectToMove) {
             [hero hideMarker];
@@ -246,37 +470,66 @@ BoardGame *boardGameInstance;
     }
 }
 
-- (void)updatePlayersTurn {
-    if ([self updateObjectMovement]) {
-        [self endTurn];
-    }
-}
-
-- (void)updateMonstersTurn {
-    if ([self updateObjectMovement]) {
-        [self endTurn];
-    }
-}
-
-- (bool)updateObjectMovement {
-    if (![self isBoardReadyForStateUpdate]) {
+- (bool)updateObjectMovementWithPosition:(cv::Point)position {
+    if (objectToMove == nil || ![self isBoardReadyForStateUpdate]) {
         return NO;
     }
-    cv::Point position;
-    @synchronized([BoardCalibrator instance].boardImageLock) {
-        position = [[BrickRecognizer instance] positionOfBrickAtLocations:[objectToMove floodFillMoveablePositions] inImage:[BoardCalibrator instance].boardImage];
-    };
     if (position != objectToMove.position && position.x != -1) {
         NSLog(@"Object %i moved to %i, %i", objectToMove.type, position.x, position.y);
         [objectToMove moveToPosition:position];
+        recognitionGeneration++;
         return YES;
     } else {
         return NO;
     }
 }
 
+- (bool)updateSimultaneousObjectMovementWithOccupancyChange:(OccupancyChange)change {
+    if (![self isBoardReadyForStateUpdate] || !readyForBrickRecognition) {
+        return NO;
+    }
+    if (change.vacated.size() == 0 || change.vacated.size() != change.occupied.size()) {
+        return NO;
+    }
+
+    // Match vacated figures to newly occupied cells
+    NSMutableArray *movingObjects = [NSMutableArray array];
+    cv::vector<cv::Point> origins;
+    cv::vector<cv::vector<cv::Point>> reachablePositions;
+    for (int i = 0; i < change.vacated.size(); i++) {
+        for (int j = 0; j < objectsToMoveInTurn.count; j++) {
+            MoveableGameObject *object = [objectsToMoveInTurn objectAtIndex:j];
+            if (object.position == change.vacated[i]) {
+                [movingObjects addObject:object];
+                origins.push_back(change.vacated[i]);
+                reachablePositions.push_back(simultaneousReachablePositions[j]);
+                break;
+            }
+        }
+    }
+
+    // A vacated cell without a figure to move is not a move we can account for
+    if (movingObjects.count != change.vacated.size()) {
+        return NO;
+    }
+    cv::vector<int> assignment = [[MoveAssignmentSolver instance] assignmentFromOrigins:origins reachablePositions:reachablePositions destinations:change.occupied];
+    if (assignment.size() == 0) {
+        return NO;
+    }
+    for (int i = 0; i < movingObjects.count; i++) {
+        MoveableGameObject *object = [movingObjects objectAtIndex:i];
+        cv::Point position = change.occupied[assignment[i]];
+        NSLog(@"Object %i moved to %i, %i", object.type, position.x, position.y);
+        [object moveToPosition:position];
+        [movedObjectsInTurn addObject:object];
+    }
+    [objectsToMoveInTurn removeObjectsInArray:movingObjects];
+    readyForBrickRecognition = NO;
+    recognitionGeneration++;
+    return YES;
+}
+
 - (void)updatePlaceHeroes {
-    [self updateInitialHeroPositions];
     for (HeroFigure *hero in [Board instance].heroFigures) {
         if (hero.recognizedOnBoard) {
             [self startInitialPlayersTurn];
@@ -285,67 +538,49 @@ BoardGame *boardGameInstance;
     }
 }
 
-- (void)updateInitialHeroPositions {
+- (void)figureRecognizedAtPosition:(cv::Point)position {
     if (![self isBoardReadyForStateUpdate] || !readyForBrickRecognition) {
         return;
     }
-    cv::vector<cv::Point> positions;
-    cv::vector<cv::Point> searchPositions;
-    for (HeroFigure *hero in [[Board instance] unrecognizedHeroFigures]) {
-        searchPositions.push_back(hero.position);
-    };
-    @synchronized([BoardCalibrator instance].boardImageLock) {
-        positions = [[BrickRecognizer instance] positionOfBricksAtLocations:searchPositions inImage:[BoardCalibrator instance].boardImage controlPoints:[[Board instance] randomControlPoints:10]];
-    };
-    for (HeroFigure *hero in [[Board instance] unrecognizedHeroFigures]) {
-        for (int i = 0; i < positions.size(); i++) {
-            if (positions[i] == hero.position) {
-                NSLog(@"Hero %i found at %i, %i", hero.type, hero.position.x, hero.position.y);
-                hero.recognizedOnBoard = YES;
-                hero.active = YES;
-                [hero showMarker];
-                [hero hideBrick];
-                [heroFigureMoveOrder addObject:hero];
-                if (state == BOARD_GAME_STATE_PLAYERS_TURN_INITIAL) {
-                    [objectsToMoveInTurn addObject:hero];
-                }
-                break;
-            }
-        }
-    }
-}
-
-- (void)recognizeMonsters {
-    if (![self isBoardReadyForStateUpdate] || !readyForBrickRecognition) {
+    GameObject *object = [[Board instance] objectAtPosition:position];
+    if (object == nil || object.recognizedOnBoard) {
         return;
     }
-    NSArray *unrecognizedMonsterFigures = [[Board instance] unrecognizedActiveMonsterFigures];
-    if (unrecognizedMonsterFigures.count == 0) {
-        return;
+    if ([object isKindOfClass:[MonsterFigure class]] && object.active) {
+        NSLog(@"Monster %i found at %i, %i", object.type, object.position.x, object.position.y);
+        object.recognizedOnBoard = YES;
+        if (object != objectToMove && !object.markerView.visible) {
+            [object showMarker];
+            [object hideMarker];
+        }
+        [object hideBrick];
     }
-    cv::vector<cv::Point> positions;
-    cv::vector<cv::Point> searchPositions;
-    for (MonsterFigure *monsterFigure in unrecognizedMonsterFigures) {
-        searchPositions.push_back(monsterFigure.position);
-    };
-    @synchronized([BoardCalibrator instance].boardImageLock) {
-        positions = [[BrickRecognizer instance] positionOfBricksAtLocations:searchPositions inImage:[BoardCalibrator instance].boardImage controlPoints:[[Board instance] randomControlPoints:10]];
-    };
-    for (MonsterFigure *monsterFigure in unrecognizedMonsterFigures) {
-        for (int i = 0; i < positions.size(); i++) {
-            if (positions[i] == monsterFigure.position) {
-                NSLog(@"Monster %i found at %i, %i", monsterFigure.type, monsterFigure.position.x, monsterFigure.position.y);
-                monsterFigure.recognizedOnBoard = YES;
-                if (monsterFigure != objectToMove && !monsterFigure.markerView.visible) {
-                    [monsterFigure showMarker];
-                    [monsterFigure hideMarker];
-                }
-                [monsterFigure hideBrick];
-            }
+    if ([object isKindOfClass:[HeroFigure class]] && (state == BOARD_GAME_STATE_PLACE_HEROES || state == BOARD_GAME_STATE_PLAYERS_TURN_INITIAL)) {
+        HeroFigure *hero = (HeroFigure *)object;
+        NSLog(@"Hero %i found at %i, %i", hero.type, hero.position.x, hero.position.y);
+        hero.recognizedOnBoard = YES;
+        hero.active = YES;
+        [hero showMarker];
+        [hero hideBrick];
+        [heroFigureMoveOrder addObject:hero];
+        if (state == BOARD_GAME_STATE_PLAYERS_TURN_INITIAL) {
+            [objectsToMoveInTurn addObject:hero];
         }
     }
 }
 
+- (cv::Mat)projectedBoardImage {
+    if (projectedImageVersion != [Board instance].projectionVersion) {
+
+        // Rendered into a new image, as the worker may still be reading the previous one
+        cv::Mat image;
+        [[UIImage imageWithView:[Board instance]] copyToCVGrayscaleMat:image];
+        projectedImage = image;
+        projectedImageVersion = [Board instance].projectionVersion;
+    }
+    return projectedImage;
+}
+
 - (void)showPulsingMarkerViewForObject:(GameObject *)object {
     [self bringSubviewToFront:object];
     [object startMarkerPulsing];
@@ -365,7 +600,7 @@ BoardGame *boardGameInstance;
 }
 
 - (bool)isBoardReadyForStateUpdate {
-    return [BoardCalibrator instance].boardBounds.bounds.defined && ![BoardCalibrator instance].boardBounds.isBoundsObstructed;
+    return boardVisible;
 }
 
 @end
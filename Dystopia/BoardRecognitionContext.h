@@ -0,0 +1,63 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_BoardRecognitionContext_h
+#define Dystopia_BoardRecognitionContext_h
+
+#include "DetectionArena.h"
+
+#define CANNY_THRESHOLDING_MODE_COUNT 3
+
+#define CANNY_THRESHOLDING_MODE_AUTOMATIC   0
+#define CANNY_THRESHOLDING_MODE_BRIGHT_ROOM 1
+#define CANNY_THRESHOLDING_MODE_DARK_ROOM   2
+
+// Mutable state of board detections on one camera stream.
+//
+// The recognizer itself only holds immutable configuration, so any number of detections can run concurrently as long as
+// each has its own context. A context is kept across frames of the same stream: detection starts with the thresholding
+// mode that found the previous board, and the arena keeps its capacity.
+
+struct BoardRecognitionContext {
+
+    // Derived from the size of the image being detected on
+    cv::Size2f imageSize;
+    cv::Size2f borderSize;
+    float minContourArea;
+    float minLineLength;
+    float lineGroupPointDistanceAcceptMax;
+
+    int previousCannyThresholdDetectionMode;
+
+    DetectionArena arena;
+
+    BoardRecognitionContext() :
+        minContourArea(0.0f),
+        minLineLength(0.0f),
+        lineGroupPointDistanceAcceptMax(0.0f),
+        previousCannyThresholdDetectionMode(CANNY_THRESHOLDING_MODE_AUTOMATIC) {}
+};
+
+#endif
@@ -27,14 +27,34 @@
 
 #import "Util.h"
 #import "BoardUtil.h"
+#import "FramePreprocessor.h"
+#import "BoardRecognitionContext.h"
 
+typedef struct {
+    float intersectionAcceptDistanceMin;
+    float intersectionAcceptDistanceMax;
+    float squareAngleAcceptMax;
+    float lineGroupAngleAcceptMax;
+    float aspectRatioAcceptMax;
+    float boardAspectRatio;
+} BoardRecognizerConfiguration;
+
+// Holds only immutable configuration - all per-detection state lives in the context passed in, so one recognizer can
+// serve concurrent detections as long as each uses its own context.
 @interface BoardRecognizer : NSObject
 
 + (BoardRecognizer *)instance;
++ (BoardRecognizerConfiguration)defaultConfiguration;
+
+- (id)initWithConfiguration:(BoardRecognizerConfiguration)configuration;
 
-- (BoardBounds)findBoardBoundsFromImage:(cv::Mat)image;
+- (BoardBounds)findBoardBoundsFromImage:(cv::Mat)image context:(BoardRecognitionContext &)context;
+- (BoardBounds)findBoardBoundsFromImage:(cv::Mat)image blurredImage:(cv::Mat)blurredImage intensityRange:(IntensityRange)intensityRange context:(BoardRecognitionContext &)context;
 - (cv::Mat)perspectiveCorrectImage:(cv::Mat)image fromBoardBounds:(FourPoints)boardBounds;
+- (void)perspectiveCorrectImage:(cv::Mat)image intoImage:(cv::Mat &)outputImage fromBoardBounds:(FourPoints)boardBounds;
 
 - (NSArray *)boardBoundsToImages:(UIImage *)img;
 
+@property (nonatomic, readonly) BoardRecognizerConfiguration configuration;
+
 @end
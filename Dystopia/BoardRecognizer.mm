@@ -28,54 +28,10 @@
 #import "BoardUtil.h"
 #import "CameraUtil.h"
 #import "ExternalDisplay.h"
-
-#define LINE_DIRECTION_HORIZONTAL_UP   0
-#define LINE_DIRECTION_HORIZONTAL_DOWN 1
-#define LINE_DIRECTION_VERTICAL_LEFT   2
-#define LINE_DIRECTION_VERTICAL_RIGHT  3
-
-#define CANNY_THRESHOLDING_MODE_COUNT 3
-
-#define CANNY_THRESHOLDING_MODE_AUTOMATIC   0
-#define CANNY_THRESHOLDING_MODE_BRIGHT_ROOM 1
-#define CANNY_THRESHOLDING_MODE_DARK_ROOM   2
-
-float intersectionAcceptDistanceMin = 0.02f;
-float intersectionAcceptDistanceMax = 5.0f;
-float squareAngleAcceptMax = 15.0f;
-float lineGroupAngleAcceptMax = 15.0f;
-float aspectRatioAcceptMax = 0.1f;
-float lineGroupPointDistanceAcceptMax;
-
-typedef struct {
-    cv::Point p1;
-    cv::Point p2;
-    float angle;
-} LineWithAngle;
-
-typedef struct {
-    cv::vector<LineWithAngle> lines;
-    LineWithAngle minLine;
-    LineWithAngle maxLine;
-    LineWithAngle average;
-    float lineDistance;
-    float angle;
-    int direction;
-} LineGroup;
+#import "FrameBufferPool.h"
 
 @interface BoardRecognizer () {
-    float minContourArea;
-    float minLineLength;
-
-    CGSize imageSize;
-    CGSize borderSize;
-    
-    float boardAspectRatio;
-    
-    cv::vector<cv::vector<cv::Point>> approx;
-    cv::vector<bool> hasBeenApproxed;
-    
-    int previousCannyThresholdDetectionMode;
+    cv::Mat dilateElement;
 }
 
 @end
@@ -84,42 +40,63 @@ BoardRecognizer *boardRecognizerInstance = nil;
 
 @implementation BoardRecognizer
 
+@synthesize configuration;
+
 + (BoardRecognizer *)instance {
     @synchronized(self) {
         if (boardRecognizerInstance == nil) {
-            boardRecognizerInstance = [[BoardRecognizer alloc] init];
+            boardRecognizerInstance = [[BoardRecognizer alloc] initWithConfiguration:[BoardRecognizer defaultConfiguration]];
         }
         return boardRecognizerInstance;
     }
 }
 
-- (id)init {
++ (BoardRecognizerConfiguration)defaultConfiguration {
+    BoardRecognizerConfiguration defaultConfiguration = {
+        .intersectionAcceptDistanceMin = 0.02f,
+        .intersectionAcceptDistanceMax = 5.0f,
+        .squareAngleAcceptMax = 15.0f,
+        .lineGroupAngleAcceptMax = 15.0f,
+        .aspectRatioAcceptMax = 0.1f,
+        .boardAspectRatio = 1.5f
+    };
+    if ([ExternalDisplay instance].externalDisplayFound) {
+        defaultConfiguration.boardAspectRatio = [ExternalDisplay instance].widescreenBounds.size.width / [ExternalDisplay instance].widescreenBounds.size.height;
+    }
+    return defaultConfiguration;
+}
+
+- (id)initWithConfiguration:(BoardRecognizerConfiguration)c {
     if (self = [super init]) {
-        previousCannyThresholdDetectionMode = CANNY_THRESHOLDING_MODE_AUTOMATIC;
+        configuration = c;
+        dilateElement = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3.0f, 3.0f));
     }
     return self;
 }
 
-- (BoardBounds)findBoardBoundsFromImage:(cv::Mat)image {
-    BoardBounds undefinedBounds = {.bounds = {.defined = NO}};
+- (BoardBounds)findBoardBoundsFromImage:(cv::Mat)image context:(BoardRecognitionContext &)context {
+    cv::Mat blurredImage;
+    IntensityRange intensityRange = preprocessFrame(image, blurredImage);
+    return [self findBoardBoundsFromImage:image blurredImage:blurredImage intensityRange:intensityRange context:context];
+}
 
-    cv::vector<cv::vector<cv::Point>> contours[CANNY_THRESHOLDING_MODE_COUNT];
-    cv::vector<cv::Vec4i> hierarchy[CANNY_THRESHOLDING_MODE_COUNT];
+- (BoardBounds)findBoardBoundsFromImage:(cv::Mat)image blurredImage:(cv::Mat)blurredImage intensityRange:(IntensityRange)intensityRange context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    BoardBounds undefinedBounds = {.bounds = {.defined = NO}};
 
-    // Prepare image
-    cv::Mat copiedImage = image.clone();
-    [self prepareConstantsFromImage:copiedImage];
+    // Prepare constants and scratch storage
+    [self prepareConstantsFromImage:image context:context];
+    arena.reset();
 
-    // Prepare image
-    cv::Mat preparedImage = [self smooth:copiedImage];
+    // Scratch images, reused across thresholding modes
+    cv::Mat cannyImage = FrameBufferPool::instance().acquire(blurredImage.size(), CV_8UC1);
+    cv::Mat img = FrameBufferPool::instance().acquire(blurredImage.size(), CV_8UC1);
 
     // Find non-obstructed bounds
     for (int i = 0; i < CANNY_THRESHOLDING_MODE_COUNT; i++) {
 
-        cv::Mat img = preparedImage.clone();
-
         // Find canny thresholding mode
-        int thresholdingMode = [self thresholdingModeForIndex:i];
+        int thresholdingMode = [self thresholdingModeForIndex:i context:context];
 
         // Hardcoded canny levels first
         float thresholdMin;
@@ -127,7 +104,7 @@ BoardRecognizer *boardRecognizerInstance = nil;
 
         // Canny thresholding min and max
         if (thresholdingMode == CANNY_THRESHOLDING_MODE_AUTOMATIC) {
-            float meanThreshold = [self automaticThresholdingMean:img];
+            float meanThreshold = intensityRangeMean(intensityRange);
             thresholdMin = meanThreshold * 2.0f / 3.0f;
             thresholdMax = meanThreshold * 4.0f / 3.0f;
         } else if (thresholdingMode == CANNY_THRESHOLDING_MODE_BRIGHT_ROOM) {
@@ -139,19 +116,19 @@ BoardRecognizer *boardRecognizerInstance = nil;
         }
         
         // Canny image
-        img = [self applyCannyOnImage:img threshold1:thresholdMin threshold2:thresholdMax];
-        img = [self dilate:img];
+        cv::Canny(blurredImage, cannyImage, thresholdMin, thresholdMax);
+        cv::dilate(cannyImage, img, dilateElement);
         
         // Find contours
-        cv::findContours(img, contours[i], hierarchy[i], CV_RETR_TREE, CV_CHAIN_APPROX_SIMPLE);
-        if (contours[i].size() == 0) {
+        cv::findContours(img, arena.contours[i], arena.hierarchy[i], CV_RETR_TREE, CV_CHAIN_APPROX_SIMPLE);
+        if (arena.contours[i].size() == 0) {
             return undefinedBounds;
         }
         
         // Find non-obstructed bounds
-        FourPoints corners = [self findNonObstructedBoardCornersFromContours:contours[i] hierarchy:hierarchy[i]];
+        FourPoints corners = [self findNonObstructedBoardCornersFromContours:arena.contours[i] hierarchy:arena.hierarchy[i] context:context];
         if (corners.defined) {
-            previousCannyThresholdDetectionMode = thresholdingMode;
+            context.previousCannyThresholdDetectionMode = thresholdingMode;
             BoardBounds bounds = {.bounds = corners, .isBoundsObstructed = NO};
             return bounds;
         }
@@ -161,9 +138,9 @@ BoardRecognizer *boardRecognizerInstance = nil;
     for (int i = 0; i < CANNY_THRESHOLDING_MODE_COUNT; i++) {
 
         // Find obstructed bounds
-        FourPoints corners = [self findObstructedBoardCornersFromContours:contours[i]];
+        FourPoints corners = [self findObstructedBoardCornersFromContours:arena.contours[i] context:context];
         if (corners.defined) {
-            previousCannyThresholdDetectionMode = [self thresholdingModeForIndex:i];
+            context.previousCannyThresholdDetectionMode = [self thresholdingModeForIndex:i context:context];
             BoardBounds bounds = {.bounds = corners, .isBoundsObstructed = YES};
             return bounds;
         }
@@ -190,13 +167,19 @@ BoardRecognizer *boardRecognizerInstance = nil;
     return (minIndex + maxIndex) / 2.0f;
 }
 
-- (int)thresholdingModeForIndex:(int)index {
-    return (previousCannyThresholdDetectionMode + index) % CANNY_THRESHOLDING_MODE_COUNT;
+- (int)thresholdingModeForIndex:(int)index context:(BoardRecognitionContext &)context {
+    return (context.previousCannyThresholdDetectionMode + index) % CANNY_THRESHOLDING_MODE_COUNT;
 }
 
 - (cv::Mat)perspectiveCorrectImage:(cv::Mat)image fromBoardBounds:(FourPoints)boardBounds {
+    cv::Mat outputImage;
+    [self perspectiveCorrectImage:image intoImage:outputImage fromBoardBounds:boardBounds];
+    return outputImage;
+}
+
+- (void)perspectiveCorrectImage:(cv::Mat)image intoImage:(cv::Mat &)outputImage fromBoardBounds:(FourPoints)boardBounds {
     cv::Mat transformation = [self findTransformationFromBoardBounds:boardBounds];
-    return [CameraUtil perspectiveTransformImage:image withTransformation:transformation toSize:[self approxBoardSizeFromBounds:boardBounds]];
+    [CameraUtil perspectiveTransformImage:image intoImage:outputImage withTransformation:transformation toSize:[self approxBoardSizeFromBounds:boardBounds]];
 }
 
 - (cv::Mat)findTransformationFromBoardBounds:(FourPoints)boardBounds {
@@ -220,10 +203,12 @@ BoardRecognizer *boardRecognizerInstance = nil;
 }
 
 - (NSArray *)boardBoundsToImages:(UIImage *)img {
+    BoardRecognitionContext context;
+    DetectionArena &arena = context.arena;
     NSMutableArray *images = [NSMutableArray array];
 
     cv::Mat image = [img CVMat];
-    [self prepareConstantsFromImage:image];
+    [self prepareConstantsFromImage:image context:context];
 
     {
         [images addObject:[UIImage imageWithCVMat:image]];
@@ -260,6 +245,8 @@ BoardRecognizer *boardRecognizerInstance = nil;
         [images addObject:[UIImage imageWithCVMat:outputImg]];
     }
     
+    arena.reset();
+
     cv::vector<cv::vector<cv::Point>> contours;
     cv::vector<cv::Vec4i> hierarchy;
     cv::findContours(image, contours, hierarchy, CV_RETR_LIST, CV_CHAIN_APPROX_SIMPLE);
@@ -267,52 +254,52 @@ BoardRecognizer *boardRecognizerInstance = nil;
         cv::Mat outputImg = origImage.clone();
         cv::Scalar color = cv::Scalar(255, 0, 255);
         for (int i = 0; i < contours.size(); i++) {
-            cv::vector<cv::Point> approxed;
-            cv::approxPolyDP(cv::Mat(contours[i]), approxed, cv::arcLength(cv::Mat(contours[i]), true) * 0.002f, true);
-            [self drawContour:approxed ontoImage:outputImg withColor:color];
+            cv::approxPolyDP(cv::Mat(contours[i]), arena.points, cv::arcLength(cv::Mat(contours[i]), true) * 0.002f, true);
+            [self drawContour:arena.points ontoImage:outputImg withColor:color];
         }
         [images addObject:[UIImage imageWithCVMat:outputImg]];
     }
 
-    cv::vector<LineWithAngle> linesAndAngles = [self findLinesFromContours:contours minimumLineLength:MIN(imageSize.width, imageSize.height) * 0.02f];
+    [self findLinesFromContours:contours minimumLineLength:MIN(context.imageSize.width, context.imageSize.height) * 0.02f context:context];
     {
         cv::Mat outputImg = origImage.clone();
         cv::Scalar color = cv::Scalar(255, 0, 255);
-        [self drawLines:linesAndAngles ontoImage:outputImg color:color];
+        [self drawLines:arena.lines ontoImage:outputImg color:color];
         [images addObject:[UIImage imageWithCVMat:outputImg]];
     }
 
-    cv::vector<cv::vector<LineGroup>> lineGroups = [self divideLinesIntoGroups:linesAndAngles];
+    [self divideLinesIntoGroupsInContext:context];
     {
         cv::Mat outputImg = origImage.clone();
-        for (int i = 0; i < lineGroups.size(); i++) {
-            for (int j = 0; j < lineGroups[i].size(); j++) {
-                cv::Scalar color = cv::Scalar(((i + 0) * 50) % 255, ((i + 100) * 150) % 255, ((i + 0) * 20) % 255);
-                [self drawLineGroup:lineGroups[i][j] ontoImage:outputImg withColor:color];
-            }
+        for (int i = 0; i < arena.lineGroups.size(); i++) {
+            int direction = arena.lineGroups[i].direction;
+            cv::Scalar color = cv::Scalar(((direction + 0) * 50) % 255, ((direction + 100) * 150) % 255, ((direction + 0) * 20) % 255);
+            [self drawLineGroup:arena.lineGroups[i] ontoImage:outputImg withColor:color context:context];
         }
         [images addObject:[UIImage imageWithCVMat:outputImg]];
     }
 
-    cv::vector<cv::vector<LineGroup>> borderLines = [self removeNonBorderLineGroups:lineGroups];
+    [self findBorderLineGroupsInContext:context];
     {
         cv::Mat outputImg = origImage.clone();
-        for (int i = 0; i < borderLines.size(); i++) {
-            for (int j = 0; j < borderLines[i].size(); j++) {
+        for (int i = 0; i < LINE_DIRECTION_COUNT; i++) {
+            Span span = arena.borderLineGroupsInDirection[i];
+            for (int j = span.start; j < span.start + span.count; j++) {
                 cv::Scalar color = cv::Scalar(((i + 0) * 50) % 255, ((i + 100) * 150) % 255, ((i + 0) * 20) % 255);
-                [self drawLineGroup:borderLines[i][j] ontoImage:outputImg withColor:color];
+                [self drawLineGroup:arena.lineGroups[arena.borderLineGroups[j]] ontoImage:outputImg withColor:color context:context];
             }
         }
         [images addObject:[UIImage imageWithCVMat:outputImg]];
     }
 
-    [self findRepresentingLinesInLineGroups:borderLines];
+    [self findRepresentingLinesInBorderLineGroupsInContext:context];
     {
         cv::Mat outputImg = origImage.clone();
-        for (int i = 0; i < borderLines.size(); i++) {
-            for (int j = 0; j < borderLines[i].size(); j++) {
+        for (int i = 0; i < LINE_DIRECTION_COUNT; i++) {
+            Span span = arena.borderLineGroupsInDirection[i];
+            for (int j = span.start; j < span.start + span.count; j++) {
                 cv::vector<LineWithAngle> lines;
-                lines.push_back(borderLines[i][j].average);
+                lines.push_back(arena.lineGroups[arena.borderLineGroups[j]].average);
                 cv::Scalar color = cv::Scalar(((i + 0) * 50) % 255, ((i + 100) * 150) % 255, ((i + 0) * 20) % 255);
                 [self drawLines:lines ontoImage:outputImg color:color];
             }
@@ -320,47 +307,40 @@ BoardRecognizer *boardRecognizerInstance = nil;
         [images addObject:[UIImage imageWithCVMat:outputImg]];
     }
 
-    cv::vector<cv::Point> intersectionPoints = [self findIntersectionsFromLineGroups:borderLines];
+    [self findIntersectionsFromBorderLineGroupsInContext:context];
     {
         cv::Mat outputImg = origImage.clone();
         cv::Scalar color = cv::Scalar(255, 0, 255);
-        [self drawPoints:intersectionPoints image:outputImg color:color];
+        [self drawPoints:arena.intersectionPoints image:outputImg color:color];
         [images addObject:[UIImage imageWithCVMat:outputImg]];
     }
 
-    cv::vector<cv::Point> bestSquare = [self findBestSquareFromPoints:intersectionPoints scoreFunction:^float(cv::vector<cv::Point> hull) {
+    [self findBestSquareFromPoints:arena.intersectionPoints scoreFunction:^float(cv::vector<cv::Point> &hull, BoardRecognitionContext &context) {
         return cv::contourArea(hull);
-    }];
-    if (bestSquare.size() < 4) {
+    } context:context];
+    if (arena.bestSquarePoints.size() < 4) {
         return images;
     }
 
     {
         cv::Mat outputImg = origImage.clone();
         cv::Scalar color = cv::Scalar(255, 0, 255);
-        [self drawPoints:bestSquare image:outputImg color:color];
+        [self drawPoints:arena.bestSquarePoints image:outputImg color:color];
         [images addObject:[UIImage imageWithCVMat:outputImg]];
         return images;
     }
 }
 
-- (void)prepareConstantsFromImage:(cv::Mat)image {
-    imageSize = CGSizeMake(image.cols, image.rows);
-    
-    minContourArea = (imageSize.width * 0.5) * (imageSize.height * 0.5f);
-    minLineLength = MIN(imageSize.width, imageSize.height) * 0.1f;
+- (void)prepareConstantsFromImage:(cv::Mat)image context:(BoardRecognitionContext &)context {
+    context.imageSize = cv::Size2f(image.cols, image.rows);
     
-    borderSize = [[BoardUtil instance] borderSizeFromBoardSize:imageSize];
-    borderSize.width *= 1.2f;
-    borderSize.height *= 1.2f;
+    context.minContourArea = (context.imageSize.width * 0.5) * (context.imageSize.height * 0.5f);
+    context.minLineLength = MIN(context.imageSize.width, context.imageSize.height) * 0.1f;
     
-    lineGroupPointDistanceAcceptMax = MAX(borderSize.width, borderSize.height) * 1.2f;
+    CGSize borderSize = [[BoardUtil instance] borderSizeFromBoardSize:CGSizeMake(image.cols, image.rows)];
+    context.borderSize = cv::Size2f(borderSize.width * 1.2f, borderSize.height * 1.2f);
     
-    if ([ExternalDisplay instance].externalDisplayFound) {
-        boardAspectRatio = [ExternalDisplay instance].widescreenBounds.size.width / [ExternalDisplay instance].widescreenBounds.size.height;
-    } else {
-        boardAspectRatio = 1.5f;
-    }
+    context.lineGroupPointDistanceAcceptMax = MAX(context.borderSize.width, context.borderSize.height) * 1.2f;
 }
 
 - (cv::Mat)calculateHistogramFromImage:(cv::Mat)image {
@@ -393,58 +373,71 @@ BoardRecognizer *boardRecognizerInstance = nil;
     return image;
 }
 
-- (FourPoints)findNonObstructedBoardCornersFromContours:(cv::vector<cv::vector<cv::Point>> &)contours hierarchy:(cv::vector<cv::Vec4i> &)hierarchy {
+- (FourPoints)findNonObstructedBoardCornersFromContours:(cv::vector<cv::vector<cv::Point>> &)contours hierarchy:(cv::vector<cv::Vec4i> &)hierarchy context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
     FourPoints undefinedPoints = {.defined = NO};
 
-    cv::vector<cv::vector<cv::Point>> approxedContours;
-    
+    // Approximate contours into flat storage
+    arena.approxedPoints.clear();
+    arena.approxedContours.clear();
     for (int i = 0; i < contours.size(); i++) {
-        cv::vector<cv::Point> approxed;
-        cv::approxPolyDP(cv::Mat(contours[i]), approxed, cv::arcLength(cv::Mat(contours[i]), true) * 0.01f, true);
-        approxedContours.push_back(approxed);
+        cv::approxPolyDP(cv::Mat(contours[i]), arena.points, cv::arcLength(cv::Mat(contours[i]), true) * 0.01f, true);
+        arena.approxedContours.push_back(appendPointsToStorage(arena.approxedPoints, arena.points));
     }
 
     // Find best contour
-    int bestContourIndex = [self findBestContourIndex:approxedContours hierarchy:hierarchy];
+    int bestContourIndex = [self findBestContourIndexWithHierarchy:hierarchy context:context];
     if (bestContourIndex == -1) {
         return undefinedPoints;
     } else {
-        return [self squarePointsToSortedBoardPoints:approxedContours[bestContourIndex]];
+        Span contour = arena.approxedContours[bestContourIndex];
+        return [self squarePointsToSortedBoardPoints:[self pointsOfApproxedContour:contour context:context] count:contour.count context:context];
     }
 }
 
-- (int)findBestContourIndex:(cv::vector<cv::vector<cv::Point>> &)contours hierarchy:(cv::vector<cv::Vec4i> &)hierarchy {
+- (const cv::Point *)pointsOfApproxedContour:(Span)contour context:(BoardRecognitionContext &)context {
+    return context.arena.approxedPoints.data() + contour.start;
+}
+
+- (int)findBestContourIndexWithHierarchy:(cv::vector<cv::Vec4i> &)hierarchy context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+
     // Find all contours that satisfy simple contour properties
-    cv::vector<int> contourIndices;
-    for (int i = 0; i < contours.size(); i++) {
-        if ([self areContourConditionsSatisfied:contours[i]]) {
-            contourIndices.push_back(i);
+    arena.contourIndices.clear();
+    for (int i = 0; i < arena.approxedContours.size(); i++) {
+        Span contour = arena.approxedContours[i];
+        if ([self areContourConditionsSatisfied:[self pointsOfApproxedContour:contour context:context] count:contour.count context:context]) {
+            arena.contourIndices.push_back(i);
         }
     }
 
     // Find valid contours - that is, must have three "nearby" children
-    cv::vector<int> validContourIndices;
-    for (int i = 0; i < contourIndices.size(); i++) {
-        float contourArea = cv::contourArea(contours[contourIndices[i]]);
-        if ([self hasExactlyFourValidChildren:contours hierarchy:hierarchy validIndices:contourIndices index:contourIndices[i] parentArea:contourArea count:4]) {
-            validContourIndices.push_back(contourIndices[i]);
+    arena.validContourIndices.clear();
+    for (int i = 0; i < arena.contourIndices.size(); i++) {
+        Span contour = arena.approxedContours[arena.contourIndices[i]];
+        float contourArea = cv::contourArea(contourMat([self pointsOfApproxedContour:contour context:context], contour.count));
+        if ([self hasExactlyFourValidChildren:hierarchy validIndices:arena.contourIndices index:arena.contourIndices[i] parentArea:contourArea count:4 context:context]) {
+            arena.validContourIndices.push_back(arena.contourIndices[i]);
         }
     }
 
     // Select best contour among the valid ones
     float bestScore = 1000.0f;
     int bestScoreIndex = -1;
-    for (int i = 0; i < validContourIndices.size(); i++) {
-        float score = [self maxCosineFromContour:contours[validContourIndices[i]]];
+    for (int i = 0; i < arena.validContourIndices.size(); i++) {
+        Span contour = arena.approxedContours[arena.validContourIndices[i]];
+        float score = [self maxCosineFromContour:[self pointsOfApproxedContour:contour context:context] count:contour.count];
         if (score < bestScore) {
             bestScore = score;
-            bestScoreIndex = validContourIndices[i];
+            bestScoreIndex = arena.validContourIndices[i];
         }
     }
     return bestScoreIndex;
 }
 
-- (bool)hasExactlyFourValidChildren:(cv::vector<cv::vector<cv::Point>> &)contours hierarchy:(cv::vector<cv::Vec4i> &)hierarchy validIndices:(cv::vector<int> &)validIndices index:(int)index parentArea:(float)parentArea count:(int)count {
+- (bool)hasExactlyFourValidChildren:(cv::vector<cv::Vec4i> &)hierarchy validIndices:(cv::vector<int> &)validIndices index:(int)index parentArea:(float)parentArea count:(int)count context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+
     // Check if it is contour at all
     if (index == -1) {
         return NO;
@@ -462,14 +455,15 @@ BoardRecognizer *boardRecognizerInstance = nil;
     }
 
     // Must have contour size "border"-close to outmost parent contour
-    if (parentArea / cv::contourArea(contours[index]) > 1.2f) {
+    Span contour = arena.approxedContours[index];
+    if (parentArea / cv::contourArea(contourMat([self pointsOfApproxedContour:contour context:context], contour.count)) > 1.2f) {
         return NO;
     }
     
     // Children must also be valid
     int i = hierarchy[index][2];
     while (i != -1) {
-        if ([self hasExactlyFourValidChildren:contours hierarchy:hierarchy validIndices:validIndices index:i parentArea:parentArea count:(count - 1)]) {
+        if ([self hasExactlyFourValidChildren:hierarchy validIndices:validIndices index:i parentArea:parentArea count:(count - 1) context:context]) {
             return YES;
         }
         i = hierarchy[i][0];
@@ -477,50 +471,53 @@ BoardRecognizer *boardRecognizerInstance = nil;
     return count == 1; // Return true if count is one - last child must not have valid children!
 }
 
-- (FourPoints)findObstructedBoardCornersFromContours:(cv::vector<cv::vector<cv::Point>> &)contours {
+- (FourPoints)findObstructedBoardCornersFromContours:(cv::vector<cv::vector<cv::Point>> &)contours context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
     FourPoints undefinedPoints = {.defined = NO};
     
     // Find lines from contours
-    cv::vector<LineWithAngle> linesAndAngles = [self findLinesFromContours:contours minimumLineLength:MIN(imageSize.width, imageSize.height) * 0.02f];
-    if (linesAndAngles.size() < 4) {
+    [self findLinesFromContours:contours minimumLineLength:MIN(context.imageSize.width, context.imageSize.height) * 0.02f context:context];
+    if (arena.lines.size() < 4) {
         return undefinedPoints;
     }
     
     // Divide lines into groups - "close" lines divided into horizontal (left and right) and vertical (up and down)
-    cv::vector<cv::vector<LineGroup>> lineGroups = [self divideLinesIntoGroups:linesAndAngles];
+    [self divideLinesIntoGroupsInContext:context];
     
     // Remove lines that cannot be border lines. Must have at least 4 "close" lines in group
-    cv::vector<cv::vector<LineGroup>> borderLines = [self removeNonBorderLineGroups:lineGroups];
-    if (borderLines[0].size() == 0 || borderLines[1].size() == 0 || borderLines[2].size() == 0 || borderLines[3].size() == 0) {
-        return undefinedPoints;
+    [self findBorderLineGroupsInContext:context];
+    for (int i = 0; i < LINE_DIRECTION_COUNT; i++) {
+        if (arena.borderLineGroupsInDirection[i].count == 0) {
+            return undefinedPoints;
+        }
     }
     
     // Find average lines that represent each group
-    [self findRepresentingLinesInLineGroups:borderLines];
+    [self findRepresentingLinesInBorderLineGroupsInContext:context];
 
     // Find intersections between all lines
-    cv::vector<cv::Point> intersectionPoints = [self findIntersectionsFromLineGroups:borderLines];
-    if (intersectionPoints.size() < 4) {
+    [self findIntersectionsFromBorderLineGroupsInContext:context];
+    if (arena.intersectionPoints.size() < 4) {
         return undefinedPoints;
     }
     
     // Find best square points
-    cv::vector<cv::Point> bestSquarePoints = [self findBestSquareFromPoints:intersectionPoints scoreFunction:^float(cv::vector<cv::Point> hull) {
-        return [self areContourConditionsSatisfied:hull] ? cv::contourArea(hull) : -1.0f;
-    }];
-    if (bestSquarePoints.size() < 4) {
+    [self findBestSquareFromPoints:arena.intersectionPoints scoreFunction:^float(cv::vector<cv::Point> &hull, BoardRecognitionContext &context) {
+        return [self areContourConditionsSatisfied:hull.data() count:(int)hull.size() context:context] ? cv::contourArea(hull) : -1.0f;
+    } context:context];
+    if (arena.bestSquarePoints.size() < 4) {
         return undefinedPoints;
     }
     
     // Convert to FourPoints
-    return [self squarePointsToSortedBoardPoints:bestSquarePoints];
+    return [self squarePointsToSortedBoardPoints:arena.bestSquarePoints.data() count:(int)arena.bestSquarePoints.size() context:context];
 }
 
-- (FourPoints)squarePointsToSortedBoardPoints:(cv::vector<cv::Point> &)points {
-    cv::Point p1 = [self extractSortedPointFromPoints:points referencePoint:CGPointMake(0.0f,            0.0f            )];
-    cv::Point p2 = [self extractSortedPointFromPoints:points referencePoint:CGPointMake(imageSize.width, 0.0f            )];
-    cv::Point p3 = [self extractSortedPointFromPoints:points referencePoint:CGPointMake(imageSize.width, imageSize.height)];
-    cv::Point p4 = [self extractSortedPointFromPoints:points referencePoint:CGPointMake(0.0f,            imageSize.height)];
+- (FourPoints)squarePointsToSortedBoardPoints:(const cv::Point *)points count:(int)count context:(BoardRecognitionContext &)context {
+    cv::Point p1 = [self extractSortedPointFromPoints:points count:count referencePoint:CGPointMake(0.0f,                     0.0f                    )];
+    cv::Point p2 = [self extractSortedPointFromPoints:points count:count referencePoint:CGPointMake(context.imageSize.width, 0.0f                    )];
+    cv::Point p3 = [self extractSortedPointFromPoints:points count:count referencePoint:CGPointMake(context.imageSize.width, context.imageSize.height)];
+    cv::Point p4 = [self extractSortedPointFromPoints:points count:count referencePoint:CGPointMake(0.0f,                     context.imageSize.height)];
     FourPoints boardPoints = {
         .defined = YES,
         .p1 = CGPointMake(p1.x, p1.y),
@@ -531,10 +528,10 @@ BoardRecognizer *boardRecognizerInstance = nil;
     return boardPoints;
 }
 
-- (cv::Point)extractSortedPointFromPoints:(cv::vector<cv::Point> &)points referencePoint:(CGPoint)referencePoint {
+- (cv::Point)extractSortedPointFromPoints:(const cv::Point *)points count:(int)count referencePoint:(CGPoint)referencePoint {
     int minIndex = -1;
     float minDistance = 0.0f;
-    for (int i = 0; i < points.size(); i++) {
+    for (int i = 0; i < count; i++) {
         float deltaX = ABS(points[i].x - referencePoint.x);
         float deltaY = ABS(points[i].y - referencePoint.y);
         float score = deltaX * deltaX + deltaY * deltaY;
@@ -546,48 +543,48 @@ BoardRecognizer *boardRecognizerInstance = nil;
     return points[minIndex];
 }
 
-- (bool)areContourConditionsSatisfied:(cv::vector<cv::Point> &)contour {
-    if (contour.size() != 4) {
+- (bool)areContourConditionsSatisfied:(const cv::Point *)contour count:(int)count context:(BoardRecognitionContext &)context {
+    if (count != 4) {
         return NO;
     }
-    if (fabs(cv::contourArea(contour)) < minContourArea) {
+    if (fabs(cv::contourArea(contourMat(contour, count))) < context.minContourArea) {
         return NO;
     }
-    if ([self maxCosineFromContour:contour] > squareAngleAcceptMax * M_PI / 180.0f) {
+    if ([self maxCosineFromContour:contour count:count] > configuration.squareAngleAcceptMax * M_PI / 180.0f) {
         return NO;
     }
-    /*if (![self hasCorrectAspectRatio:contour]) {
+    /*if (![self hasCorrectAspectRatio:contour count:count]) {
         return NO;
     }*/
     return YES;
 }
 
-- (bool)hasCorrectAspectRatio:(cv::vector<cv::Point> &)contour {
+- (bool)hasCorrectAspectRatio:(const cv::Point *)contour count:(int)count {
     float averageWidth = 0.0f;
     float averageHeight = 0.0f;
-    for (int i = 0; i < contour.size(); i++) {
-        cv::Point p1 = contour[(i + 0) % contour.size()];
-        cv::Point p2 = contour[(i + 1) % contour.size()];
+    for (int i = 0; i < count; i++) {
+        cv::Point p1 = contour[(i + 0) % count];
+        cv::Point p2 = contour[(i + 1) % count];
 
         averageWidth += ABS(p1.x - p2.x);
         averageHeight += ABS(p1.y - p2.y);
     }
-    averageWidth /= (float)contour.size();
-    averageHeight /= (float)contour.size();
+    averageWidth /= (float)count;
+    averageHeight /= (float)count;
     float aspectRatio = MAX(averageWidth, averageHeight) / MIN(averageWidth, averageHeight);
-    return aspectRatio >= boardAspectRatio - aspectRatioAcceptMax && aspectRatio <= boardAspectRatio + aspectRatioAcceptMax;
+    return aspectRatio >= configuration.boardAspectRatio - configuration.aspectRatioAcceptMax && aspectRatio <= configuration.boardAspectRatio + configuration.aspectRatioAcceptMax;
 }
 
 - (bool)isAngleVerticalOrHorizontal:(float)angle {
     int a1 = ABS((int)angle % 90);
     int a = MIN(a1, 90 - a1);
-    return a < lineGroupAngleAcceptMax;
+    return a < configuration.lineGroupAngleAcceptMax;
 }
 
-- (float)maxCosineFromContour:(cv::vector<cv::Point> &)contour {
+- (float)maxCosineFromContour:(const cv::Point *)contour count:(int)count {
     float maxCosine = 0.0f;
-    for (int j = 2; j < contour.size() + 2; j++) {
-        float cosine = fabs(angle(contour[j % contour.size()], contour[(j - 2) % contour.size()], contour[(j - 1) % contour.size()]));
+    for (int j = 2; j < count + 2; j++) {
+        float cosine = fabs(angle(contour[j % count], contour[(j - 2) % count], contour[(j - 1) % count]));
         if (cosine > maxCosine) {
             maxCosine = cosine;
         }
@@ -595,42 +592,47 @@ BoardRecognizer *boardRecognizerInstance = nil;
     return maxCosine;
 }
 
-- (cv::vector<cv::Point>)findIntersectionsFromLineGroups:(cv::vector<cv::vector<LineGroup>> &)lineGroups {
-    cv::vector<cv::Point> intersectionPoints;
-    [self addIntersectionsBetweenLineGroups:lineGroups[0] andLineGroups:lineGroups[2] toPoints:intersectionPoints];
-    [self addIntersectionsBetweenLineGroups:lineGroups[0] andLineGroups:lineGroups[3] toPoints:intersectionPoints];
-    [self addIntersectionsBetweenLineGroups:lineGroups[1] andLineGroups:lineGroups[2] toPoints:intersectionPoints];
-    [self addIntersectionsBetweenLineGroups:lineGroups[1] andLineGroups:lineGroups[3] toPoints:intersectionPoints];
-    return intersectionPoints;
+- (void)findIntersectionsFromBorderLineGroupsInContext:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    arena.intersectionPoints.clear();
+    [self addIntersectionsBetweenBorderLineGroupsInDirection:LINE_DIRECTION_HORIZONTAL_UP andDirection:LINE_DIRECTION_VERTICAL_LEFT context:context];
+    [self addIntersectionsBetweenBorderLineGroupsInDirection:LINE_DIRECTION_HORIZONTAL_UP andDirection:LINE_DIRECTION_VERTICAL_RIGHT context:context];
+    [self addIntersectionsBetweenBorderLineGroupsInDirection:LINE_DIRECTION_HORIZONTAL_DOWN andDirection:LINE_DIRECTION_VERTICAL_LEFT context:context];
+    [self addIntersectionsBetweenBorderLineGroupsInDirection:LINE_DIRECTION_HORIZONTAL_DOWN andDirection:LINE_DIRECTION_VERTICAL_RIGHT context:context];
 }
 
-- (cv::vector<cv::Point>)addIntersectionsBetweenLineGroups:(cv::vector<LineGroup> &)lineGroups1 andLineGroups:(cv::vector<LineGroup> &)lineGroups2 toPoints:(cv::vector<cv::Point> &)intersectionPoints {
-    for (int i = 0; i < lineGroups1.size(); i++) {
-        for (int j = 0; j < lineGroups2.size(); j++) {
+- (void)addIntersectionsBetweenBorderLineGroupsInDirection:(int)direction1 andDirection:(int)direction2 context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    Span lineGroups1 = arena.borderLineGroupsInDirection[direction1];
+    Span lineGroups2 = arena.borderLineGroupsInDirection[direction2];
+    for (int i = lineGroups1.start; i < lineGroups1.start + lineGroups1.count; i++) {
+        for (int j = lineGroups2.start; j < lineGroups2.start + lineGroups2.count; j++) {
             cv::Point r;
             cv::Point2f t;
-            if ([self isAcceptableIntersectionLine1:lineGroups1[i].average line2:lineGroups2[j].average r:r t:t]) {
-                intersectionPoints.push_back(r);
+            LineWithAngle line1 = arena.lineGroups[arena.borderLineGroups[i]].average;
+            LineWithAngle line2 = arena.lineGroups[arena.borderLineGroups[j]].average;
+            if ([self isAcceptableIntersectionLine1:line1 line2:line2 r:r t:t context:context]) {
+                arena.intersectionPoints.push_back(r);
             }
         }
     }
-    return intersectionPoints;
 }
 
-- (void)findRepresentingLinesInLineGroups:(cv::vector<cv::vector<LineGroup>> &)lineGroups {
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < lineGroups[i].size(); j++) {
-            cv::vector<cv::Point> points;
-            LineGroup &lineGroup = lineGroups[i][j];
-            for (int k = 0; k < lineGroup.lines.size(); k++) {
-                LineWithAngle line = lineGroup.lines[k];
-                points.push_back(line.p1);
-                points.push_back(line.p2);
+- (void)findRepresentingLinesInBorderLineGroupsInContext:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    for (int i = 0; i < LINE_DIRECTION_COUNT; i++) {
+        Span lineGroups = arena.borderLineGroupsInDirection[i];
+        for (int j = lineGroups.start; j < lineGroups.start + lineGroups.count; j++) {
+            LineGroup &lineGroup = arena.lineGroups[arena.borderLineGroups[j]];
+            arena.points.clear();
+            for (int k = lineGroup.lines.start; k < lineGroup.lines.start + lineGroup.lines.count; k++) {
+                LineWithAngle line = arena.groupedLines[k];
+                arena.points.push_back(line.p1);
+                arena.points.push_back(line.p2);
             }
-            cv::vector<cv::Point> hull;
-            cv::convexHull(points, hull);
+            cv::convexHull(arena.points, arena.hull);
 
-            cv::RotatedRect box = cv::minAreaRect(cv::Mat(hull));
+            cv::RotatedRect box = cv::minAreaRect(cv::Mat(arena.hull));
             if (box.angle < -45.0f) {
                 std::swap(box.size.width, box.size.height);
                 box.angle += 90.0f;
@@ -659,60 +661,82 @@ BoardRecognizer *boardRecognizerInstance = nil;
     }
 }
 
-- (cv::vector<cv::vector<LineGroup>>)divideLinesIntoGroups:(cv::vector<LineWithAngle> &)lines {
-    cv::vector<cv::vector<LineGroup>> lineGroups = cv::vector<cv::vector<LineGroup>> (4);
-    for (int i = 0; i < lines.size(); i++) {
-        int direction = [self lineDirection:lines[i]];
+- (void)divideLinesIntoGroupsInContext:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    arena.lineGroups.clear();
+    arena.nextLineInGroup.assign(arena.lines.size(), -1);
+    for (int i = 0; i < arena.lines.size(); i++) {
+        LineWithAngle line = arena.lines[i];
+        int direction = [self lineDirection:line context:context];
         bool addedLine = NO;
-        for (int j = 0; j < lineGroups[direction].size(); j++) {
-            if (![self doesLine:lines[i] haveSameEndpointsAsLine:lineGroups[direction][j].minLine]) {
+        for (int j = 0; j < arena.lineGroups.size(); j++) {
+            LineGroup &lineGroup = arena.lineGroups[j];
+            if (lineGroup.direction != direction) {
                 continue;
             }
-            if (![self isLine:lines[i] closeToLine:lineGroups[direction][j].minLine]) {
+            if (![self doesLine:line haveSameEndpointsAsLine:lineGroup.minLine context:context]) {
                 continue;
             }
-            if (![self isLine:lines[i] closeToLine:lineGroups[direction][j].maxLine]) {
+            if (![self isLine:line closeToLine:lineGroup.minLine context:context]) {
+                continue;
+            }
+            if (![self isLine:line closeToLine:lineGroup.maxLine context:context]) {
                 continue;
             }
             bool doesAllOverlap = YES;
-            for (int k = 0; k < lineGroups[direction][j].lines.size(); k++) {
-                if (![self doesLine:lines[i] overlapWithLine:lineGroups[direction][j].lines[k]]) {
+            for (int k = lineGroup.firstLine; k != -1; k = arena.nextLineInGroup[k]) {
+                if (![self doesLine:line overlapWithLine:arena.lines[k]]) {
                     doesAllOverlap = NO;
                     break;
                 }
             }
             if (doesAllOverlap) {
-                [self updateGroup:lineGroups[direction][j] withLine:lines[i]];
+                [self updateGroup:lineGroup withLineIndex:i context:context];
                 addedLine = YES;
                 break;
             }
         }
         if (!addedLine) {
-            lineGroups[direction].push_back([self newLineGroupWithLine:lines[i]]);
+            arena.lineGroups.push_back([self newLineGroupWithLineIndex:i context:context]);
+        }
+    }
+
+    // Lay out lines of each group contiguously
+    arena.groupedLines.clear();
+    for (int i = 0; i < arena.lineGroups.size(); i++) {
+        LineGroup &lineGroup = arena.lineGroups[i];
+        lineGroup.lines.start = (int)arena.groupedLines.size();
+        for (int k = lineGroup.firstLine; k != -1; k = arena.nextLineInGroup[k]) {
+            arena.groupedLines.push_back(arena.lines[k]);
         }
     }
-    return lineGroups;
 }
 
-- (cv::vector<cv::vector<LineGroup>>)removeNonBorderLineGroups:(cv::vector<cv::vector<LineGroup>> &)lineGroups {
+- (void)findBorderLineGroupsInContext:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+
     // Must have 4 lines in group, two for each side of the border
-    cv::vector<cv::vector<LineGroup>> borderLines = cv::vector<cv::vector<LineGroup>> (4);
-    for (int i = 0; i < 4; i++) {
-        for (int j = 0; j < lineGroups[i].size(); j++) {
-            if (lineGroups[i][j].lines.size() >= 4) {
-                borderLines[i].push_back(lineGroups[i][j]);
+    arena.borderLineGroups.clear();
+    for (int i = 0; i < LINE_DIRECTION_COUNT; i++) {
+        Span &lineGroups = arena.borderLineGroupsInDirection[i];
+        lineGroups.start = (int)arena.borderLineGroups.size();
+        for (int j = 0; j < arena.lineGroups.size(); j++) {
+            if (arena.lineGroups[j].direction == i && arena.lineGroups[j].lines.count >= 4) {
+                arena.borderLineGroups.push_back(j);
             }
         }
+        lineGroups.count = (int)arena.borderLineGroups.size() - lineGroups.start;
     }
-    return borderLines;
 }
 
-- (LineGroup)newLineGroupWithLine:(LineWithAngle)line {
-    int direction = [self lineDirection:line];
-    cv::vector<LineWithAngle> lineGroupLines;
-    lineGroupLines.push_back(line);
+- (LineGroup)newLineGroupWithLineIndex:(int)lineIndex context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    LineWithAngle line = arena.lines[lineIndex];
+    int direction = [self lineDirection:line context:context];
     LineGroup lineGroup = {
-        .lines = lineGroupLines,
+        .lines = {.start = 0, .count = 1},
+        .firstLine = lineIndex,
+        .lastLine = lineIndex,
         .minLine = line,
         .maxLine = line,
         .lineDistance = 0.0f,
@@ -722,8 +746,12 @@ BoardRecognizer *boardRecognizerInstance = nil;
     return lineGroup;
 }
 
-- (void)updateGroup:(LineGroup &)lineGroup withLine:(LineWithAngle)line {
-    lineGroup.lines.push_back(line);
+- (void)updateGroup:(LineGroup &)lineGroup withLineIndex:(int)lineIndex context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    LineWithAngle line = arena.lines[lineIndex];
+    arena.nextLineInGroup[lineGroup.lastLine] = lineIndex;
+    lineGroup.lastLine = lineIndex;
+    lineGroup.lines.count++;
     float distanceToMinLine = [self lineDistance:line fromLine:lineGroup.minLine];
     float distanceToMaxLine = [self lineDistance:line fromLine:lineGroup.maxLine];
     if (distanceToMinLine > lineGroup.lineDistance) {
@@ -735,14 +763,14 @@ BoardRecognizer *boardRecognizerInstance = nil;
     }
 }
 
-- (bool)doesLine:(LineWithAngle)line1 haveSameEndpointsAsLine:(LineWithAngle)line2 {
+- (bool)doesLine:(LineWithAngle)line1 haveSameEndpointsAsLine:(LineWithAngle)line2 context:(BoardRecognitionContext &)context {
     CGSize deltaP1 = CGSizeMake(ABS(line1.p1.x - line2.p1.x), ABS(line1.p1.y - line2.p1.y));
     CGSize deltaP2 = CGSizeMake(ABS(line1.p2.x - line2.p2.x), ABS(line1.p2.y - line2.p2.y));
-    return deltaP1.width < lineGroupPointDistanceAcceptMax && deltaP1.height < lineGroupPointDistanceAcceptMax && deltaP2.width < lineGroupPointDistanceAcceptMax && deltaP2.height < lineGroupPointDistanceAcceptMax;
+    return deltaP1.width < context.lineGroupPointDistanceAcceptMax && deltaP1.height < context.lineGroupPointDistanceAcceptMax && deltaP2.width < context.lineGroupPointDistanceAcceptMax && deltaP2.height < context.lineGroupPointDistanceAcceptMax;
 }
 
-- (bool)isLine:(LineWithAngle)line1 closeToLine:(LineWithAngle)line2 {
-    float acceptDistance = [self isLineHorizontal:line1] ? borderSize.height : borderSize.width;
+- (bool)isLine:(LineWithAngle)line1 closeToLine:(LineWithAngle)line2 context:(BoardRecognitionContext &)context {
+    float acceptDistance = [self isLineHorizontal:line1] ? context.borderSize.height : context.borderSize.width;
     return [self lineDistance:line1 fromLine:line2] < acceptDistance;
 }
 
@@ -763,11 +791,11 @@ BoardRecognizer *boardRecognizerInstance = nil;
     }
 }
 
-- (int)lineDirection:(LineWithAngle)line {
+- (int)lineDirection:(LineWithAngle)line context:(BoardRecognitionContext &)context {
     if ([self isLineHorizontal:line]) {
-        return [self lineCenter:line].y < imageSize.height / 2.0f ? 0 : 1;
+        return [self lineCenter:line].y < context.imageSize.height / 2.0f ? 0 : 1;
     } else {
-        return [self lineCenter:line].x < imageSize.width / 2.0f ? 2 : 3;
+        return [self lineCenter:line].x < context.imageSize.width / 2.0f ? 2 : 3;
     }
 }
 
@@ -779,10 +807,11 @@ BoardRecognizer *boardRecognizerInstance = nil;
     return CGPointMake((line.p1.x + line.p2.x) / 2.0f, (line.p1.y + line.p2.y) / 2.0f);
 }
 
-- (cv::vector<LineWithAngle>)findLinesFromContours:(cv::vector<cv::vector<cv::Point>> &)contours minimumLineLength:(float)minimumLineLength {
-    cv::vector<LineWithAngle> linesAndAngles = cv::vector<LineWithAngle> (0);
-    cv::vector<cv::Point> approxedContour;
-    
+- (void)findLinesFromContours:(cv::vector<cv::vector<cv::Point>> &)contours minimumLineLength:(float)minimumLineLength context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    cv::vector<cv::Point> &approxedContour = arena.points;
+    arena.lines.clear();
+
     float minimumLineLengthSqr = minimumLineLength * minimumLineLength;
 
     for (int i = 0; i < contours.size(); i++) {
@@ -803,11 +832,10 @@ BoardRecognizer *boardRecognizerInstance = nil;
 
             line.angle = lineAngle(line.p1, line.p2);
             if ([self isAngleVerticalOrHorizontal:line.angle]) {
-                linesAndAngles.push_back([self sortLinePointsLeftUp:line]);
+                arena.lines.push_back([self sortLinePointsLeftUp:line]);
             }
         }
     }
-    return linesAndAngles;
 }
 
 - (LineWithAngle)sortLinePointsLeftUp:(LineWithAngle)line {
@@ -824,11 +852,14 @@ BoardRecognizer *boardRecognizerInstance = nil;
     }
 }
 
-- (cv::vector<cv::Point>)findBestSquareFromPoints:(cv::vector<cv::Point> &)points scoreFunction:(float(^)(cv::vector<cv::Point> hull))scoreFunction {
-    cv::vector<cv::Point> bestPoints;
-    cv::vector<cv::Point> currentPoints = cv::vector<cv::Point> (4);
-    cv::vector<cv::Point> hull;
-    
+- (void)findBestSquareFromPoints:(cv::vector<cv::Point> &)points scoreFunction:(float(^)(cv::vector<cv::Point> &hull, BoardRecognitionContext &context))scoreFunction context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    cv::vector<cv::Point> &currentPoints = arena.squarePoints;
+    cv::vector<cv::Point> &hull = arena.hull;
+
+    currentPoints.resize(4);
+    arena.bestSquarePoints.clear();
+
     float bestScore = -1.0f;
 
     for (int i1 = 0; i1 < points.size(); i1++) {
@@ -844,22 +875,21 @@ BoardRecognizer *boardRecognizerInstance = nil;
                     currentPoints[3] = points[i4];
                     cv::convexHull(currentPoints, hull);
                     
-                    float score = scoreFunction(hull);
+                    float score = scoreFunction(hull, context);
                     
-                    if (score > bestScore && [self areContourConditionsSatisfied:hull]) {
-                        bestPoints = hull;
+                    if (score > bestScore && [self areContourConditionsSatisfied:hull.data() count:(int)hull.size() context:context]) {
+                        arena.bestSquarePoints = hull;
                         bestScore = score;
                     }
                 }
             }
         }
     }
-    return bestPoints;
 }
 
-- (bool)isAcceptableIntersectionLine1:(LineWithAngle)line1 line2:(LineWithAngle)line2 r:(cv::Point &)r t:(cv::Point2f &)t {
+- (bool)isAcceptableIntersectionLine1:(LineWithAngle)line1 line2:(LineWithAngle)line2 r:(cv::Point &)r t:(cv::Point2f &)t context:(BoardRecognitionContext &)context {
     if (intersection(line1.p1, line1.p2, line2.p1, line2.p2, r, t)) {
-        if (r.x >= 0 && r.x < imageSize.width && r.y >= 0 && r.y < imageSize.height) {
+        if (r.x >= 0 && r.x < context.imageSize.width && r.y >= 0 && r.y < context.imageSize.height) {
             return [self isWithinAcceptableDistance:t.x] && [self isWithinAcceptableDistance:t.y];
         }
     }
@@ -871,11 +901,11 @@ BoardRecognizer *boardRecognizerInstance = nil;
 }
 
 - (bool)isWithinAcceptableDistanceMin:(float)t {
-    return t > -intersectionAcceptDistanceMax && t < intersectionAcceptDistanceMin;
+    return t > -configuration.intersectionAcceptDistanceMax && t < configuration.intersectionAcceptDistanceMin;
 }
 
 - (bool)isWithinAcceptableDistanceMax:(float)t {
-    return t > 1.0f - intersectionAcceptDistanceMin && t < 1.0f + intersectionAcceptDistanceMax;
+    return t > 1.0f - configuration.intersectionAcceptDistanceMin && t < 1.0f + configuration.intersectionAcceptDistanceMax;
 }
 
 - (void)drawPoints:(cv::vector<cv::Point> &)points image:(cv::Mat)image color:(cv::Scalar)color {
@@ -884,12 +914,14 @@ BoardRecognizer *boardRecognizerInstance = nil;
     }
 }
 
-- (void)drawBestTwoLineGroups:(cv::vector<LineGroup> &)bestTwoLineGroups ontoImage:(cv::Mat)image {
+- (void)drawBestTwoLineGroups:(cv::vector<LineGroup> &)bestTwoLineGroups ontoImage:(cv::Mat)image context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
     for (int i = 0; i < 2; i++) {
-        for (int j = 0; j < bestTwoLineGroups[i].lines.size(); j++) {
+        Span lines = bestTwoLineGroups[i].lines;
+        for (int j = lines.start; j < lines.start + lines.count; j++) {
             cv::vector<cv::vector<cv::Point>> line = cv::vector<cv::vector<cv::Point>> (1);
-            line[0].push_back(bestTwoLineGroups[i].lines[j].p1);
-            line[0].push_back(bestTwoLineGroups[i].lines[j].p2);
+            line[0].push_back(arena.groupedLines[j].p1);
+            line[0].push_back(arena.groupedLines[j].p2);
             
             cv::Scalar color = cv::Scalar(i == 0 ? 255 : 0, i == 1 ? 255 : 0, 0);
             cv::drawContours(image, line, 0, color);
@@ -911,11 +943,12 @@ BoardRecognizer *boardRecognizerInstance = nil;
     }
 }
 
-- (void)drawLineGroup:(LineGroup &)lineGroup ontoImage:(cv::Mat)image withColor:(cv::Scalar)color {
-    for (int i = 0; i < lineGroup.lines.size(); i++) {
+- (void)drawLineGroup:(LineGroup &)lineGroup ontoImage:(cv::Mat)image withColor:(cv::Scalar)color context:(BoardRecognitionContext &)context {
+    DetectionArena &arena = context.arena;
+    for (int i = lineGroup.lines.start; i < lineGroup.lines.start + lineGroup.lines.count; i++) {
         cv::vector<cv::vector<cv::Point>> line = cv::vector<cv::vector<cv::Point>> (1);
-        line[0].push_back(lineGroup.lines[i].p1);
-        line[0].push_back(lineGroup.lines[i].p2);
+        line[0].push_back(arena.groupedLines[i].p1);
+        line[0].push_back(arena.groupedLines[i].p2);
 
         cv::drawContours(image, line, 0, color);
     }
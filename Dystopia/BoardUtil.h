@@ -26,15 +26,11 @@
 #import <Foundation/Foundation.h>
 
 #import "Util.h"
+#import "GameRules.h"
 
 #ifndef __BOARD_UTIL__
 #define __BOARD_UTIL__
 
-    #define BOARD_WIDTH 30
-    #define BOARD_HEIGHT 20
-
-    #define BRICK_IMAGES_COUNT 11
-
     typedef struct {
         FourPoints bounds;
         bool isBoundsObstructed;
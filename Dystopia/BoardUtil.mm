@@ -26,11 +26,18 @@
 #import "BoardUtil.h"
 #import "ExternalDisplay.h"
 #import "BrickView.h"
+#import "AssetCache.h"
 
 BoardUtil *boardUtilInstance = nil;
 
+NSString *const BRICK_IMAGE_NAMES[BRICK_IMAGES_COUNT] = {
+    @"bricks1", @"bricks2", @"bricks3", @"bricks4", @"bricks5", @"bricks6", @"bricks7", @"bricks8", @"bricks9", @"exit", @"trap"
+};
+
 @interface BoardUtil () {
     UIImage *brickImages[BRICK_IMAGES_COUNT];
+    CGSize brickImageSizes[BRICK_IMAGES_COUNT];
+    float brickImageScales[BRICK_IMAGES_COUNT];
     CGSize brickSizes[BRICK_IMAGES_COUNT];
 }
 
@@ -59,20 +66,26 @@ BoardUtil *boardUtilInstance = nil;
 }
 
 - (void)loadBricks {
-    brickImages[ 0] = [UIImage imageNamed:@"bricks1.png"]; brickSizes[ 0] = CGSizeMake(3.0f, 3.0f);
-    brickImages[ 1] = [UIImage imageNamed:@"bricks2.png"]; brickSizes[ 1] = CGSizeMake(3.0f, 3.0f);
-    brickImages[ 2] = [UIImage imageNamed:@"bricks3.png"]; brickSizes[ 2] = CGSizeMake(3.0f, 3.0f);
-    brickImages[ 3] = [UIImage imageNamed:@"bricks4.png"]; brickSizes[ 3] = CGSizeMake(3.0f, 3.0f);
-    brickImages[ 4] = [UIImage imageNamed:@"bricks5.png"]; brickSizes[ 4] = CGSizeMake(3.0f, 2.0f);
-    brickImages[ 5] = [UIImage imageNamed:@"bricks6.png"]; brickSizes[ 5] = CGSizeMake(3.0f, 1.0f);
-    brickImages[ 6] = [UIImage imageNamed:@"bricks7.png"]; brickSizes[ 6] = CGSizeMake(2.0f, 1.0f);
-    brickImages[ 7] = [UIImage imageNamed:@"bricks8.png"]; brickSizes[ 7] = CGSizeMake(1.0f, 1.0f);
-    brickImages[ 8] = [UIImage imageNamed:@"bricks9.png"]; brickSizes[ 8] = CGSizeMake(1.0f, 3.0f);
-    brickImages[ 9] = [UIImage imageNamed:@"exit.png"];    brickSizes[ 9] = CGSizeMake(2.0f, 2.0f);
-    brickImages[10] = [UIImage imageNamed:@"trap.png"];    brickSizes[10] = CGSizeMake(1.0f, 1.0f);
+    for (int i = 0; i < BRICK_IMAGES_COUNT; i++) {
+        cv::Size size = brickTypeBoardSize(i);
+        brickSizes[i] = CGSizeMake(size.width, size.height);
+        brickImages[i] = nil;
+    }
 }
 
 - (UIImage *)brickImageOfType:(int)type {
+    // Bitmap at screen size is taken from the asset cache, so the PNG is only decoded on a cache miss. Kept per size and
+    // scale, as the external display can attach or change resolution after the first brick is made
+    CGSize size = [self brickTypeScreenSize:type];
+    float scale = [ExternalDisplay instance].screen.scale;
+    if (brickImages[type] == nil || !CGSizeEqualToSize(brickImageSizes[type], size) || brickImageScales[type] != scale) {
+        NSString *name = BRICK_IMAGE_NAMES[type];
+        brickImages[type] = [[AssetCache instance] imageNamed:name size:size scale:scale renderer:^(CGSize imageSize) {
+            [[UIImage imageNamed:[name stringByAppendingString:@".png"]] drawInRect:CGRectMake(0.0f, 0.0f, imageSize.width, imageSize.height)];
+        }];
+        brickImageSizes[type] = size;
+        brickImageScales[type] = scale;
+    }
     return brickImages[type];
 }
 
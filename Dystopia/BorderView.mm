@@ -28,6 +28,7 @@
 #import "BorderView.h"
 #import "ExternalDisplay.h"
 #import "BoardUtil.h"
+#import "AssetCache.h"
 
 #define BORDER_LEFT         0
 #define BORDER_RIGHT        1
@@ -52,6 +53,14 @@
 }
 
 - (void)initialize {
+    NSString *name = [NSString stringWithFormat:@"border_%ix%i", BOARD_WIDTH, BOARD_HEIGHT];
+    UIImage *borderImage = [[AssetCache instance] imageNamed:name size:self.bounds.size scale:[ExternalDisplay instance].screen.scale renderer:^(CGSize size) {
+        [self drawBorderWithImages:[self loadBorderImages] size:size];
+    }];
+    self.layer.contents = (id)borderImage.CGImage;
+}
+
+- (NSMutableArray *)loadBorderImages {
     NSMutableArray *borderImages = [NSMutableArray arrayWithCapacity:8];
     [borderImages setObject:[UIImage imageNamed:@"border_left.png"        ] atIndexedSubscript:BORDER_LEFT];
     [borderImages setObject:[UIImage imageNamed:@"border_right.png"       ] atIndexedSubscript:BORDER_RIGHT];
@@ -61,41 +70,32 @@
     [borderImages setObject:[UIImage imageNamed:@"border_top_right.png"   ] atIndexedSubscript:BORDER_TOP_RIGHT];
     [borderImages setObject:[UIImage imageNamed:@"border_bottom_left.png" ] atIndexedSubscript:BORDER_BOTTOM_LEFT];
     [borderImages setObject:[UIImage imageNamed:@"border_bottom_right.png"] atIndexedSubscript:BORDER_BOTTOM_RIGHT];
-    
-    UIImage *borderImage = [self drawBorderWithImages:borderImages];
-    self.layer.contents = (id)borderImage.CGImage;
+    return borderImages;
 }
 
-- (UIImage *)drawBorderWithImages:(NSMutableArray *)borderImages {
+- (void)drawBorderWithImages:(NSMutableArray *)borderImages size:(CGSize)size {
     int countX = ((BOARD_WIDTH * 2) - 2) / 9;
     int countY = ((BOARD_HEIGHT * 2)- 2) / 9;
     
-    CGSize singleSize = [[BoardUtil instance] borderSizeFromBoardSize:self.bounds.size];
+    CGSize singleSize = [[BoardUtil instance] borderSizeFromBoardSize:size];
     CGSize stripSize = CGSizeMake(singleSize.width * 9.0f, singleSize.height * 9.0f);
 
-    UIGraphicsBeginImageContextWithOptions(self.bounds.size, NO, [ExternalDisplay instance].screen.scale);
-
     for (int i = 0; i < countX; i++) {
         float x = (i * stripSize.width) + singleSize.width;
-        [borderImages[BORDER_TOP]    drawInRect:CGRectMake(x, 0.0f,                                        stripSize.width + 1, singleSize.height)];
-        [borderImages[BORDER_BOTTOM] drawInRect:CGRectMake(x, self.bounds.size.height - singleSize.height, stripSize.width + 1, singleSize.height)];
+        [borderImages[BORDER_TOP]    drawInRect:CGRectMake(x, 0.0f,                              stripSize.width + 1, singleSize.height)];
+        [borderImages[BORDER_BOTTOM] drawInRect:CGRectMake(x, size.height - singleSize.height, stripSize.width + 1, singleSize.height)];
     }
     
     for (int i = 0; i < countY; i++) {
         float y = (i * stripSize.height) + singleSize.height;
-        [borderImages[BORDER_LEFT]  drawInRect:CGRectMake(0.0f,                                      y, singleSize.width, stripSize.height + 1)];
-        [borderImages[BORDER_RIGHT] drawInRect:CGRectMake(self.bounds.size.width - singleSize.width, y, singleSize.width, stripSize.height + 1)];
+        [borderImages[BORDER_LEFT]  drawInRect:CGRectMake(0.0f,                           y, singleSize.width, stripSize.height + 1)];
+        [borderImages[BORDER_RIGHT] drawInRect:CGRectMake(size.width - singleSize.width, y, singleSize.width, stripSize.height + 1)];
     }
 
     [borderImages[BORDER_TOP_LEFT] drawInRect:CGRectMake(0.0f, 0.0f, singleSize.width, singleSize.height)];
-    [borderImages[BORDER_TOP_RIGHT] drawInRect:CGRectMake(self.bounds.size.width - singleSize.width, 0.0f, singleSize.width, singleSize.height)];
-    [borderImages[BORDER_BOTTOM_LEFT] drawInRect:CGRectMake(0.0f, self.bounds.size.height - singleSize.height, singleSize.width, singleSize.height)];
-    [borderImages[BORDER_BOTTOM_RIGHT] drawInRect:CGRectMake(self.bounds.size.width - singleSize.width, self.bounds.size.height - singleSize.height, singleSize.width, singleSize.height)];
-
-    UIImage *borderImage = UIGraphicsGetImageFromCurrentImageContext();
-    UIGraphicsEndImageContext();
-    
-    return borderImage;
+    [borderImages[BORDER_TOP_RIGHT] drawInRect:CGRectMake(size.width - singleSize.width, 0.0f, singleSize.width, singleSize.height)];
+    [borderImages[BORDER_BOTTOM_LEFT] drawInRect:CGRectMake(0.0f, size.height - singleSize.height, singleSize.width, singleSize.height)];
+    [borderImages[BORDER_BOTTOM_RIGHT] drawInRect:CGRectMake(size.width - singleSize.width, size.height - singleSize.height, singleSize.width, singleSize.height)];
 }
 
 @end
@@ -0,0 +1,72 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+#import "BoardCalibrator.h"
+#import "BrickRecognizer.h"
+#import "VisionEvent.h"
+
+typedef struct {
+    BoardSnapshotReference snapshot;
+    cv::Mat projectedImage;
+    cv::vector<cv::Point> controlPoints;
+    bool projectionAware;
+
+    // Figures not yet recognized on the board
+    cv::vector<cv::Point> figureLocations;
+
+    // Cells the one figure to move can move to
+    bool recognizeMovement;
+    cv::vector<cv::Point> movementLocations;
+
+    // Figures moving at the same time and the cells they can move to
+    bool recognizeOccupancyChange;
+    cv::vector<cv::Point> occupancyPositions;
+    cv::vector<cv::Point> occupancyLocations;
+
+    int tag;
+} BrickRecognitionRequest;
+
+typedef void (^BrickRecognitionCompletion)();
+
+@interface BrickRecognitionWorker : NSObject
+
++ (BrickRecognitionWorker *)instance;
+
+// Results are emitted as vision events tagged with the request tag; completion is called on the main thread once all
+// events of the request can be read
+- (bool)processRequest:(BrickRecognitionRequest)request completion:(BrickRecognitionCompletion)completion;
+
+// Runs a request right away on the calling thread and emits its results into the given queue. The recognizer is
+// shared, so several threads may do this at once as long as each has its own queue
+- (void)recognizeRequest:(const BrickRecognitionRequest &)request events:(VisionEventQueue &)eventQueue;
+
+// Main thread only
+- (bool)nextEvent:(VisionEvent &)event;
+
+@property (nonatomic, readonly) bool busy;
+
+@end
@@ -0,0 +1,147 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "BrickRecognitionWorker.h"
+
+@interface BrickRecognitionWorker () {
+    dispatch_queue_t recognitionQueue;
+
+    VisionEventQueue events;
+}
+
+@end
+
+BrickRecognitionWorker *brickRecognitionWorkerInstance = nil;
+
+@implementation BrickRecognitionWorker
+
+@synthesize busy;
+
++ (BrickRecognitionWorker *)instance {
+    @synchronized(self) {
+        if (brickRecognitionWorkerInstance == nil) {
+            brickRecognitionWorkerInstance = [[BrickRecognitionWorker alloc] init];
+        }
+        return brickRecognitionWorkerInstance;
+    }
+}
+
+- (id)init {
+    if (self = [super init]) {
+        recognitionQueue = dispatch_queue_create("dk.trollsahead.dystopia.BrickRecognitionWorker.Recognize", NULL);
+        busy = NO;
+    }
+    return self;
+}
+
+- (bool)processRequest:(BrickRecognitionRequest)request completion:(BrickRecognitionCompletion)completion {
+
+    // Called from the main thread only; one request is in flight at a time so results never queue up behind the camera
+    if (busy || !request.snapshot.isValid()) {
+        return NO;
+    }
+    busy = YES;
+    dispatch_async(recognitionQueue, ^{
+        [self recognizeRequest:request events:events];
+        dispatch_async(dispatch_get_main_queue(), ^{
+            busy = NO;
+            completion();
+        });
+    });
+    return YES;
+}
+
+- (bool)nextEvent:(VisionEvent &)event {
+    return events.pop(event);
+}
+
+- (void)recognizeRequest:(const BrickRecognitionRequest &)request events:(VisionEventQueue &)eventQueue {
+    unsigned long long frameSequenceNumber = request.snapshot->frameSequenceNumber;
+    cv::Mat boardImage = request.snapshot->image;
+    cv::Mat expectedImage;
+    if (request.projectionAware) {
+        expectedImage = [[BrickRecognizer instance] expectedImageFromProjectedImage:request.projectedImage boardImage:boardImage];
+    }
+
+    if (request.figureLocations.size() > 0) {
+        cv::vector<float> probabilities;
+        cv::vector<cv::Point> positions = [self positionOfBricksAtLocations:request.figureLocations inImage:boardImage expectedImage:expectedImage request:request probabilities:probabilities];
+        for (int i = 0; i < positions.size(); i++) {
+            [self emitEvent:visionEvent(VISION_EVENT_FIGURE_RECOGNIZED, frameSequenceNumber, probabilities[i], positions[i], request.tag) events:eventQueue];
+        }
+    }
+    if (request.recognizeMovement) {
+        float probability;
+        cv::Point position = [self positionOfBrickAtLocations:request.movementLocations inImage:boardImage expectedImage:expectedImage request:request probability:probability];
+        if (position.x != -1) {
+            [self emitEvent:visionEvent(VISION_EVENT_CELL_OCCUPIED, frameSequenceNumber, probability, position, request.tag) events:eventQueue];
+        }
+    }
+    if (request.recognizeOccupancyChange) {
+        OccupancyChange change = [self occupancyChangeOfPositions:request.occupancyPositions atLocations:request.occupancyLocations inImage:boardImage expectedImage:expectedImage request:request];
+        for (int i = 0; i < change.vacated.size(); i++) {
+            [self emitEvent:visionEvent(VISION_EVENT_CELL_VACATED, frameSequenceNumber, change.vacatedConfidences[i], change.vacated[i], request.tag) events:eventQueue];
+        }
+        for (int i = 0; i < change.occupied.size(); i++) {
+            [self emitEvent:visionEvent(VISION_EVENT_CELL_OCCUPIED, frameSequenceNumber, change.occupiedConfidences[i], change.occupied[i], request.tag) events:eventQueue];
+        }
+    }
+}
+
+- (void)emitEvent:(VisionEvent)event events:(VisionEventQueue &)eventQueue {
+    if (!eventQueue.push(event) && DEBUG) {
+        NSLog(@"Dropped vision event %i of frame %llu", event.type, event.frameSequenceNumber);
+    }
+}
+
+- (cv::Point)positionOfBrickAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage request:(const BrickRecognitionRequest &)request probability:(float &)probability {
+    if (request.projectionAware) {
+        return [[BrickRecognizer instance] positionOfBrickAtLocations:locations inImage:image expectedImage:expectedImage probability:probability];
+    } else {
+        probability = 1.0f;
+        return [[BrickRecognizer instance] positionOfBrickAtLocations:locations inImage:image];
+    }
+}
+
+- (cv::vector<cv::Point>)positionOfBricksAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage request:(const BrickRecognitionRequest &)request probabilities:(cv::vector<float> &)probabilities {
+    if (request.projectionAware) {
+        return [[BrickRecognizer instance] positionOfBricksAtLocations:locations inImage:image expectedImage:expectedImage probabilities:probabilities];
+    } else {
+        cv::vector<cv::Point> positions = [[BrickRecognizer instance] positionOfBricksAtLocations:locations inImage:image controlPoints:request.controlPoints];
+        probabilities.assign(positions.size(), 1.0f);
+        return positions;
+    }
+}
+
+- (OccupancyChange)occupancyChangeOfPositions:(cv::vector<cv::Point>)positions atLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage request:(const BrickRecognitionRequest &)request {
+    if (request.projectionAware) {
+        return [[BrickRecognizer instance] occupancyChangeOfPositions:positions atLocations:locations inImage:image expectedImage:expectedImage];
+    } else {
+        cv::vector<cv::Point> occupiedPositions = [[BrickRecognizer instance] positionOfBricksAtLocations:locations inImage:image controlPoints:request.controlPoints];
+        return [[BrickRecognizer instance] occupancyChangeOfPositions:positions fromOccupiedPositions:occupiedPositions];
+    }
+}
+
+@end
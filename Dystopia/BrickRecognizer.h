@@ -32,6 +32,18 @@ typedef struct {
     float max;
 } MedianMinMax;
 
+typedef struct {
+    float gain;
+    float offset;
+} ProjectionResponse;
+
+typedef struct {
+    cv::vector<cv::Point> vacated;
+    cv::vector<cv::Point> occupied;
+    cv::vector<float> vacatedConfidences;
+    cv::vector<float> occupiedConfidences;
+} OccupancyChange;
+
 @interface BrickRecognizer : NSObject
 
 + (BrickRecognizer *)instance;
@@ -41,4 +53,16 @@ typedef struct {
 
 - (cv::vector<float>)probabilitiesOfBricksAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image;
 
+- (cv::Mat)expectedImageFromProjectedImage:(cv::Mat)projectedImage boardImage:(cv::Mat)boardImage;
+
+- (cv::Point)positionOfBrickAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage;
+- (cv::Point)positionOfBrickAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage probability:(float &)probability;
+- (cv::vector<cv::Point>)positionOfBricksAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage;
+- (cv::vector<cv::Point>)positionOfBricksAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage probabilities:(cv::vector<float> &)probabilities;
+
+- (OccupancyChange)occupancyChangeOfPositions:(cv::vector<cv::Point>)positions atLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage;
+- (OccupancyChange)occupancyChangeOfPositions:(cv::vector<cv::Point>)positions fromOccupiedPositions:(cv::vector<cv::Point>)occupiedPositions;
+
+- (cv::vector<float>)residualProbabilitiesOfBricksAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage;
+
 @end
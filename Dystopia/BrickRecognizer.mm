@@ -28,12 +28,22 @@
 
 #import "BrickRecognizer.h"
 #import "UIImage+OpenCV.h"
+#import "ControlPointManager.h"
+#import "FrameBufferPool.h"
 
 #define HISTOGRAM_BIN_COUNT 8
 
 #define BRICK_RECOGNITION_MINIMUM_MEDIAN_DELTA 30.0f
 #define BRICK_RECOGNITION_MINIMUM_PROBABILITY 0.4f
 
+#define BRICK_RECOGNITION_RESIDUAL_THRESHOLD 40.0f
+#define BRICK_RECOGNITION_RESIDUAL_CELL_INSET 0.15f
+
+#define BRICK_RECOGNITION_RESPONSE_TRIM_ITERATIONS 2
+#define BRICK_RECOGNITION_RESPONSE_TRIM_FRACTION 0.75f
+
+#define BRICK_RECOGNITION_TILE_GRANULARITY 16
+
 BrickRecognizer *brickRecognizerInstance = nil;
 
 @implementation BrickRecognizer
@@ -89,11 +99,190 @@ BrickRecognizer *brickRecognizerInstance = nil;
         cv::Point maxProbPosition = [self maxProbabilityPositionFromLocations:brickLocations probabilities:probabilities];
         if (maxProbPosition == locations[i]) {
             positions.push_back(locations[i]);
+        } else {
+            [[ControlPointManager instance] reportOccludedControlPoint:maxProbPosition];
         }
     }
     return positions;
 }
 
+- (cv::Mat)expectedImageFromProjectedImage:(cv::Mat)projectedImage boardImage:(cv::Mat)boardImage {
+    // Board image is perspective corrected, so the projected frame maps onto it by scaling alone
+    cv::Mat expectedImage = FrameBufferPool::instance().acquire(boardImage.size(), projectedImage.type());
+    cv::resize(projectedImage, expectedImage, boardImage.size(), 0, 0, cv::INTER_AREA);
+    return expectedImage;
+}
+
+- (cv::Point)positionOfBrickAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage {
+    float probability;
+    return [self positionOfBrickAtLocations:locations inImage:image expectedImage:expectedImage probability:probability];
+}
+
+- (cv::Point)positionOfBrickAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage probability:(float &)probability {
+    cv::vector<float> probabilities = [self residualProbabilitiesOfBricksAtLocations:locations inImage:image expectedImage:expectedImage];
+    float maxProbability = [self maxProbabilityFromProbabilities:probabilities];
+    float secondMaxProbability = [self secondMaxProbabilityFromProbabilities:probabilities];
+    probability = maxProbability;
+    if (maxProbability < BRICK_RECOGNITION_MINIMUM_PROBABILITY || secondMaxProbability >= BRICK_RECOGNITION_MINIMUM_PROBABILITY) {
+        return cv::Point(-1, -1);
+    }
+    return [self maxProbabilityPositionFromLocations:locations probabilities:probabilities];
+}
+
+- (cv::vector<cv::Point>)positionOfBricksAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage {
+    cv::vector<float> positionProbabilities;
+    return [self positionOfBricksAtLocations:locations inImage:image expectedImage:expectedImage probabilities:positionProbabilities];
+}
+
+- (cv::vector<cv::Point>)positionOfBricksAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage probabilities:(cv::vector<float> &)positionProbabilities {
+    cv::vector<float> probabilities = [self residualProbabilitiesOfBricksAtLocations:locations inImage:image expectedImage:expectedImage];
+    cv::vector<cv::Point> positions;
+    positionProbabilities.clear();
+    for (int i = 0; i < locations.size(); i++) {
+        if (probabilities[i] >= BRICK_RECOGNITION_MINIMUM_PROBABILITY) {
+            positions.push_back(locations[i]);
+            positionProbabilities.push_back(probabilities[i]);
+        }
+    }
+    return positions;
+}
+
+- (OccupancyChange)occupancyChangeOfPositions:(cv::vector<cv::Point>)positions atLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage {
+    cv::vector<cv::Point> allLocations = [self allLocationsFromLocations:positions controlPoints:locations];
+    cv::vector<float> probabilities = [self residualProbabilitiesOfBricksAtLocations:allLocations inImage:image expectedImage:expectedImage];
+
+    // Positions come first in all locations
+    OccupancyChange change;
+    for (int i = 0; i < positions.size(); i++) {
+        if (probabilities[i] < BRICK_RECOGNITION_MINIMUM_PROBABILITY) {
+            change.vacated.push_back(positions[i]);
+            change.vacatedConfidences.push_back(1.0f - probabilities[i]);
+        }
+    }
+    for (int i = (int)positions.size(); i < allLocations.size(); i++) {
+        if (probabilities[i] >= BRICK_RECOGNITION_MINIMUM_PROBABILITY &&
+            std::find(positions.begin(), positions.end(), allLocations[i]) == positions.end() &&
+            std::find(change.occupied.begin(), change.occupied.end(), allLocations[i]) == change.occupied.end()) {
+            change.occupied.push_back(allLocations[i]);
+            change.occupiedConfidences.push_back(probabilities[i]);
+        }
+    }
+    return change;
+}
+
+- (OccupancyChange)occupancyChangeOfPositions:(cv::vector<cv::Point>)positions fromOccupiedPositions:(cv::vector<cv::Point>)occupiedPositions {
+
+    // Without probabilities at hand every change is taken as certain
+    OccupancyChange change;
+    for (int i = 0; i < positions.size(); i++) {
+        if (std::find(occupiedPositions.begin(), occupiedPositions.end(), positions[i]) == occupiedPositions.end()) {
+            change.vacated.push_back(positions[i]);
+            change.vacatedConfidences.push_back(1.0f);
+        }
+    }
+    for (int i = 0; i < occupiedPositions.size(); i++) {
+        if (std::find(positions.begin(), positions.end(), occupiedPositions[i]) == positions.end() &&
+            std::find(change.occupied.begin(), change.occupied.end(), occupiedPositions[i]) == change.occupied.end()) {
+            change.occupied.push_back(occupiedPositions[i]);
+            change.occupiedConfidences.push_back(1.0f);
+        }
+    }
+    return change;
+}
+
+- (cv::vector<float>)residualProbabilitiesOfBricksAtLocations:(cv::vector<cv::Point>)locations inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage {
+    CGSize brickSize = [[BoardUtil instance] singleBrickScreenSizeFromBoardSize:CGSizeMake(image.cols, image.rows)];
+    ProjectionResponse response = [self projectionResponseFromImage:image expectedImage:expectedImage];
+    cv::vector<float> probabilities;
+    for (int i = 0; i < locations.size(); i++) {
+        probabilities.push_back([self residualProbabilityOfBrickAtLocation:locations[i] inImage:image expectedImage:expectedImage response:response brickSize:brickSize]);
+    }
+    return probabilities;
+}
+
+- (float)residualProbabilityOfBrickAtLocation:(cv::Point)location inImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage response:(ProjectionResponse)response brickSize:(CGSize)brickSize {
+    cv::Rect rect = [self boardRectFromLocation:location inImage:image brickSize:brickSize];
+
+    // Skip cell edges - they carry grid lines and calibration misalignment rather than bricks
+    int insetX = (int)(rect.width * BRICK_RECOGNITION_RESIDUAL_CELL_INSET);
+    int insetY = (int)(rect.height * BRICK_RECOGNITION_RESIDUAL_CELL_INSET);
+    rect = cv::Rect(rect.x + insetX, rect.y + insetY, rect.width - (insetX * 2), rect.height - (insetY * 2)) & cv::Rect(0, 0, image.cols, image.rows);
+    if (rect.area() <= 0) {
+        return 0.0f;
+    }
+
+    int deviatingCount = 0;
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        const uchar *observedRow = image.ptr<uchar>(y);
+        const uchar *expectedRow = expectedImage.ptr<uchar>(y);
+        for (int x = rect.x; x < rect.x + rect.width; x++) {
+            float predicted = (response.gain * expectedRow[x]) + response.offset;
+            if (ABS(predicted - observedRow[x]) > BRICK_RECOGNITION_RESIDUAL_THRESHOLD) {
+                deviatingCount++;
+            }
+        }
+    }
+    return (float)deviatingCount / (float)rect.area();
+}
+
+- (ProjectionResponse)projectionResponseFromImage:(cv::Mat)image expectedImage:(cv::Mat)expectedImage {
+    ProjectionResponse response = {.gain = 1.0f, .offset = 0.0f};
+
+    // Compare cell means - fits camera exposure and ambient light against the projected intensities
+    cv::Mat observedCells = FrameBufferPool::instance().acquire(BOARD_HEIGHT, BOARD_WIDTH, image.type());
+    cv::Mat expectedCells = FrameBufferPool::instance().acquire(BOARD_HEIGHT, BOARD_WIDTH, expectedImage.type());
+    cv::resize(image, observedCells, cv::Size(BOARD_WIDTH, BOARD_HEIGHT), 0, 0, cv::INTER_AREA);
+    cv::resize(expectedImage, expectedCells, cv::Size(BOARD_WIDTH, BOARD_HEIGHT), 0, 0, cv::INTER_AREA);
+
+    cv::vector<bool> inliers = cv::vector<bool>(BOARD_WIDTH * BOARD_HEIGHT, true);
+
+    for (int iteration = 0; iteration <= BRICK_RECOGNITION_RESPONSE_TRIM_ITERATIONS; iteration++) {
+
+        // Least squares fit of observed = gain * expected + offset
+        double n = 0.0, sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+        for (int i = 0; i < BOARD_HEIGHT; i++) {
+            for (int j = 0; j < BOARD_WIDTH; j++) {
+                if (!inliers[(i * BOARD_WIDTH) + j]) {
+                    continue;
+                }
+                double x = expectedCells.at<uchar>(i, j);
+                double y = observedCells.at<uchar>(i, j);
+                n += 1.0;
+                sumX += x;
+                sumY += y;
+                sumXX += x * x;
+                sumXY += x * y;
+            }
+        }
+        double denominator = (n * sumXX) - (sumX * sumX);
+        if (n < 2.0 || ABS(denominator) < 1e-6) {
+            break;
+        }
+        response.gain = ((n * sumXY) - (sumX * sumY)) / denominator;
+        response.offset = (sumY - (response.gain * sumX)) / n;
+
+        if (iteration == BRICK_RECOGNITION_RESPONSE_TRIM_ITERATIONS) {
+            break;
+        }
+
+        // Drop the worst fitting cells - bricks and hands must not steer the response
+        cv::vector<float> residuals;
+        for (int i = 0; i < BOARD_HEIGHT; i++) {
+            for (int j = 0; j < BOARD_WIDTH; j++) {
+                float predicted = (response.gain * expectedCells.at<uchar>(i, j)) + response.offset;
+                residuals.push_back(ABS(predicted - observedCells.at<uchar>(i, j)));
+            }
+        }
+        cv::vector<float> sortedResiduals = residuals;
+        std::sort(sortedResiduals.begin(), sortedResiduals.end());
+        float acceptResidual = sortedResiduals[(int)(sortedResiduals.size() * BRICK_RECOGNITION_RESPONSE_TRIM_FRACTION)];
+        for (int i = 0; i < residuals.size(); i++) {
+            inliers[i] = residuals[i] <= acceptResidual;
+        }
+    }
+    return response;
+}
+
 - (float)maxProbabilityFromProbabilities:(cv::vector<float>)probabilities {
     float maxProb = 0.0f;
     for (int i = 0; i < probabilities.size(); i++) {
@@ -200,7 +389,7 @@ BrickRecognizer *brickRecognizerInstance = nil;
 }
 
 - (cv::Mat)calculateHistogramFromImage:(cv::Mat)image binCount:(int)binCount {
-    cv::Mat histogram;
+    cv::Mat histogram = FrameBufferPool::instance().acquire(binCount, 1, CV_32F);
     float range[] = {0, 256};
     const float *histRange = {range};
     cv::calcHist(&image, 1, 0, cv::Mat(), histogram, 1, &binCount, &histRange);
@@ -228,11 +417,13 @@ BrickRecognizer *brickRecognizerInstance = nil;
 
 - (cv::Mat)prepareImage:(cv::Mat)image withLocations:(cv::vector<cv::Point>)locations brickSize:(CGSize)brickSize {
     cv::Mat preparedImage = [self prepareImageWithoutEqualizing:image withLocations:locations brickSize:brickSize];
-    return [self equalizeImage:preparedImage];
+    cv::Mat equalizedImage = [self tileBufferWithBrickSize:brickSize count:(int)locations.size() type:preparedImage.type()];
+    cv::equalizeHist(preparedImage, equalizedImage);
+    return equalizedImage;
 }
 
 - (cv::Mat)prepareImageWithoutEqualizing:(cv::Mat)image withLocations:(cv::vector<cv::Point>)locations brickSize:(CGSize)brickSize {
-    cv::Mat tiledImage = cv::Mat((int)brickSize.height, (int)brickSize.width * locations.size(), image.type());
+    cv::Mat tiledImage = [self tileBufferWithBrickSize:brickSize count:(int)locations.size() type:image.type()];
     for (int i = 0; i < locations.size(); i++) {
         cv::Mat brickImage = [self extractBrickImageFromLocation:locations[i] image:image brickSize:brickSize];
         cv::Rect roi(cv::Point((int)brickSize.width * i, 0), brickImage.size());
@@ -241,10 +432,11 @@ BrickRecognizer *brickRecognizerInstance = nil;
     return tiledImage;
 }
 
-- (cv::Mat)equalizeImage:(cv::Mat)image {
-    cv::Mat equalizedImage;
-    cv::equalizeHist(image, equalizedImage);
-    return equalizedImage;
+- (cv::Mat)tileBufferWithBrickSize:(CGSize)brickSize count:(int)count type:(int)type {
+    // Round tile count up so calls with different location counts share pooled buffers
+    int capacity = ((count + BRICK_RECOGNITION_TILE_GRANULARITY - 1) / BRICK_RECOGNITION_TILE_GRANULARITY) * BRICK_RECOGNITION_TILE_GRANULARITY;
+    cv::Mat buffer = FrameBufferPool::instance().acquire((int)brickSize.height, (int)brickSize.width * capacity, type);
+    return buffer(cv::Rect(0, 0, (int)brickSize.width * count, (int)brickSize.height));
 }
 
 @end
@@ -25,7 +25,7 @@
 
 #import <Foundation/Foundation.h>
 
-#define BRICKVIEW_OPEN_DOOR_DURATION 3.0f
+#import "TurnTiming.h"
 
 @interface BrickView : UIView
 
@@ -33,6 +33,7 @@
 
 + (cv::Mat)perspectiveTransformImage:(cv::Mat)image withTransformation:(cv::Mat)transformation;
 + (cv::Mat)perspectiveTransformImage:(cv::Mat)src withTransformation:(cv::Mat)transformation toSize:(CGSize)toSize;
++ (void)perspectiveTransformImage:(cv::Mat)src intoImage:(cv::Mat &)dst withTransformation:(cv::Mat)transformation toSize:(CGSize)toSize;
 
 + (cv::Mat)findPerspectiveTransformationSrcPoints:(FourPoints)srcPoints dstPoints:(FourPoints)dstPoints;
 
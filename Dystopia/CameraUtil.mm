@@ -26,14 +26,20 @@
 #import "CameraUtil.h"
 #import "ExternalDisplay.h"
 #import "UIImage+OpenCV.h"
+#import "FrameBufferPool.h"
 
 @implementation CameraUtil
 
 + (UIImage *)imageFromPixelBuffer:(CVImageBufferRef)pixelBuffer {
+    static CIContext *context = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        context = [CIContext contextWithOptions:nil];
+    });
+
     CVPixelBufferLockBaseAddress(pixelBuffer, 0);
 
     CIImage *ciImage = [CIImage imageWithCVPixelBuffer:pixelBuffer];
-    CIContext *context = [CIContext contextWithOptions:nil];
     CGImageRef cgImage = [context createCGImage:ciImage fromRect:CGRectMake(0, 0, CVPixelBufferGetWidth(pixelBuffer), CVPixelBufferGetHeight(pixelBuffer))];
     
     UIImage *uiImage = [UIImage imageWithCGImage:cgImage];
@@ -51,9 +57,14 @@
 
 + (cv::Mat)perspectiveTransformImage:(cv::Mat)src withTransformation:(cv::Mat)transformation toSize:(CGSize)toSize {
     cv::Mat dst;
+    [self perspectiveTransformImage:src intoImage:dst withTransformation:transformation toSize:toSize];
+    return dst;
+}
+
++ (void)perspectiveTransformImage:(cv::Mat)src intoImage:(cv::Mat &)dst withTransformation:(cv::Mat)transformation toSize:(CGSize)toSize {
     cv::Size size = cv::Size(toSize.width, toSize.height);
+    FrameBufferPool::instance().ensure(dst, size, src.type());
     cv::warpPerspective(src, dst, transformation, size);
-    return dst;
 }
 
 + (cv::Mat)findPerspectiveTransformationSrcPoints:(FourPoints)srcPoints dstPoints:(FourPoints)dstPoints {
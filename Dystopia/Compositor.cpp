@@ -0,0 +1,324 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Compositor.h"
+
+static uint8_t clampColor(double value) {
+    return (uint8_t)std::max(0.0, std::min(255.0, value));
+}
+
+static bool layerDrawsAnything(const CompositorLayer &layer) {
+    return layer.visible && layer.alpha > 0.0f && layer.frame.area() > 0 && (layer.type == COMPOSITOR_LAYER_SOLID || !layer.image.empty());
+}
+
+CompositorLayer solidCompositorLayer(cv::Rect frame, cv::Scalar color, float alpha) {
+    CompositorLayer layer;
+    layer.type = COMPOSITOR_LAYER_SOLID;
+    layer.frame = frame;
+    layer.color = color;
+    layer.alpha = alpha;
+    layer.visible = true;
+    return layer;
+}
+
+CompositorLayer imageCompositorLayer(cv::Rect frame, const cv::Mat &image, float alpha) {
+    CompositorLayer layer;
+    layer.type = COMPOSITOR_LAYER_IMAGE;
+    layer.frame = frame;
+    layer.color = cv::Scalar(255, 255, 255, 255);
+    layer.image = image;
+    layer.alpha = alpha;
+    layer.visible = true;
+    return layer;
+}
+
+Compositor::Compositor(cv::Size size, cv::Scalar backgroundColor) : background(backgroundColor), renderedPixels(0) {
+    frameBitmap.create(size.height, size.width, CV_8UC4);
+    invalidate(cv::Rect(0, 0, size.width, size.height));
+}
+
+int Compositor::addLayer(const CompositorLayer &layer) {
+    int layerId;
+    if (freeLayerIds.size() > 0) {
+        layerId = freeLayerIds.back();
+        freeLayerIds.pop_back();
+    } else {
+        layerId = (int)layers.size();
+        layers.push_back(LayerSlot());
+    }
+    layers[layerId].layer = layer;
+    layers[layerId].used = true;
+    displayList.push_back(layerId);
+    invalidateLayer(layerId);
+    return layerId;
+}
+
+void Compositor::removeLayer(int layerId) {
+    invalidateLayer(layerId);
+    layers[layerId].used = false;
+    layers[layerId].layer = CompositorLayer();
+    displayList.erase(std::find(displayList.begin(), displayList.end(), layerId));
+    freeLayerIds.push_back(layerId);
+}
+
+const CompositorLayer &Compositor::layer(int layerId) const {
+    return layers[layerId].layer;
+}
+
+void Compositor::updateLayer(int layerId, const CompositorLayer &layer) {
+    invalidateLayer(layerId);
+    layers[layerId].layer = layer;
+    invalidateLayer(layerId);
+}
+
+void Compositor::setLayerFrame(int layerId, cv::Rect frame) {
+    if (layers[layerId].layer.frame == frame) {
+        return;
+    }
+    invalidateLayer(layerId);
+    layers[layerId].layer.frame = frame;
+    invalidateLayer(layerId);
+}
+
+void Compositor::setLayerAlpha(int layerId, float alpha) {
+    if (layers[layerId].layer.alpha != alpha) {
+        layers[layerId].layer.alpha = alpha;
+        invalidate(layers[layerId].layer.frame);
+    }
+}
+
+void Compositor::setLayerVisible(int layerId, bool visible) {
+    if (layers[layerId].layer.visible != visible) {
+        layers[layerId].layer.visible = visible;
+        invalidate(layers[layerId].layer.frame);
+    }
+}
+
+void Compositor::bringLayerToFront(int layerId) {
+    if (displayList.back() == layerId) {
+        return;
+    }
+    displayList.erase(std::find(displayList.begin(), displayList.end(), layerId));
+    displayList.push_back(layerId);
+    invalidateLayer(layerId);
+}
+
+void Compositor::invalidateLayer(int layerId) {
+    if (layerDrawsAnything(layers[layerId].layer)) {
+        invalidate(layers[layerId].layer.frame);
+    }
+}
+
+void Compositor::invalidate(cv::Rect rect) {
+    rect &= cv::Rect(0, 0, frameBitmap.cols, frameBitmap.rows);
+    if (rect.area() == 0) {
+        return;
+    }
+
+    // Overlapping rectangles are merged, and merged again with any they then overlap
+    for (int i = 0; i < dirtyRects.size(); ) {
+        if ((dirtyRects[i] & rect).area() > 0) {
+            rect |= dirtyRects[i];
+            dirtyRects.erase(dirtyRects.begin() + i);
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+    dirtyRects.push_back(rect);
+    if (dirtyRects.size() > COMPOSITOR_MAX_DIRTY_RECTS) {
+        cv::Rect bounds = dirtyRects[0];
+        for (int i = 1; i < dirtyRects.size(); i++) {
+            bounds |= dirtyRects[i];
+        }
+        dirtyRects.clear();
+        dirtyRects.push_back(bounds);
+    }
+}
+
+bool Compositor::render() {
+    lastRenderedRects = dirtyRects;
+    dirtyRects.clear();
+    renderedPixels = 0;
+    uint8_t backgroundPixel[4] = {clampColor(background[0]), clampColor(background[1]), clampColor(background[2]), clampColor(background[3])};
+    for (int i = 0; i < lastRenderedRects.size(); i++) {
+        cv::Rect rect = lastRenderedRects[i];
+        for (int y = rect.y; y < rect.y + rect.height; y++) {
+            uint8_t *row = frameBitmap.ptr<uint8_t>(y) + rect.x * 4;
+            for (int x = 0; x < rect.width; x++) {
+                memcpy(row + x * 4, backgroundPixel, 4);
+            }
+        }
+        for (int j = 0; j < displayList.size(); j++) {
+            const CompositorLayer &layer = layers[displayList[j]].layer;
+            if (layerDrawsAnything(layer)) {
+                drawLayer(layer, rect);
+            }
+        }
+        renderedPixels += rect.area();
+    }
+    return lastRenderedRects.size() > 0;
+}
+
+void Compositor::drawLayer(const CompositorLayer &layer, cv::Rect clip) {
+    cv::Rect area = layer.frame & clip;
+    if (area.area() == 0) {
+        return;
+    }
+    int layerAlpha = (int)(std::min(1.0f, layer.alpha) * 256.0f);
+    bool hasImage = layer.type == COMPOSITOR_LAYER_IMAGE;
+    bool hasMask = !layer.mask.empty();
+    uint8_t color[4] = {clampColor(layer.color[0]), clampColor(layer.color[1]), clampColor(layer.color[2]), clampColor(layer.color[3])};
+
+    // Source column of every destination column, shared by all rows
+    sourceColumns.resize(area.width);
+    for (int x = 0; x < area.width; x++) {
+        sourceColumns[x] = area.x + x - layer.frame.x;
+    }
+
+    for (int y = area.y; y < area.y + area.height; y++) {
+        int layerY = y - layer.frame.y;
+        const uint8_t *imageRow = hasImage ? layer.image.ptr<uint8_t>(layerY * layer.image.rows / layer.frame.height) : NULL;
+        const uint8_t *maskRow = hasMask ? layer.mask.ptr<uint8_t>(layerY * layer.mask.rows / layer.frame.height) : NULL;
+        uint8_t *destination = frameBitmap.ptr<uint8_t>(y) + area.x * 4;
+        for (int x = 0; x < area.width; x++, destination += 4) {
+            int layerX = sourceColumns[x];
+            const uint8_t *source = hasImage ? imageRow + (layerX * layer.image.cols / layer.frame.width) * 4 : color;
+            int alpha = source[3] * layerAlpha;
+            if (hasMask) {
+                alpha = alpha * maskRow[layerX * layer.mask.cols / layer.frame.width] / 255;
+            }
+            alpha >>= 8;
+            if (alpha == 0) {
+                continue;
+            }
+            if (alpha >= 255) {
+                destination[0] = source[0];
+                destination[1] = source[1];
+                destination[2] = source[2];
+                destination[3] = 255;
+                continue;
+            }
+            for (int c = 0; c < 3; c++) {
+                destination[c] = (uint8_t)((source[c] * alpha + destination[c] * (255 - alpha)) / 255);
+            }
+            destination[3] = (uint8_t)(alpha + destination[3] * (255 - alpha) / 255);
+        }
+    }
+}
+
+const cv::Mat &Compositor::frame() const {
+    return frameBitmap;
+}
+
+const std::vector<cv::Rect> &Compositor::renderedRects() const {
+    return lastRenderedRects;
+}
+
+long long Compositor::renderedPixelCount() const {
+    return renderedPixels;
+}
+
+#ifdef COMPOSITOR_BENCHMARK_MAIN
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "LevelImage.h"
+
+// Board frame of a level with figures walking about, timing full and incremental frames
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <level image> [frames]" << std::endl;
+        return 1;
+    }
+    LevelImage level;
+    std::string error;
+    if (!level.open(argv[1], error)) {
+        std::cerr << argv[1] << ": " << error << std::endl;
+        return 1;
+    }
+    int frameCount = argc > 2 ? atoi(argv[2]) : 1000;
+
+    cv::Size frameSize = cv::Size(1280, 720);
+    cv::Size cellSize = cv::Size(frameSize.width / BOARD_WIDTH, frameSize.height / BOARD_HEIGHT);
+    Compositor compositor(frameSize);
+
+    cv::Mat brickImage(64, 64, CV_8UC4);
+    cv::Mat figureImage(32, 32, CV_8UC4);
+    for (int y = 0; y < 64; y++) {
+        for (int x = 0; x < 64; x++) {
+            uint8_t *pixel = brickImage.ptr<uint8_t>(y) + x * 4;
+            pixel[0] = pixel[1] = pixel[2] = (uint8_t)(128 + ((x / 8 + y / 8) % 2) * 64);
+            pixel[3] = 255;
+            if (x < 32 && y < 32) {
+                pixel = figureImage.ptr<uint8_t>(y) + x * 4;
+                pixel[0] = 255;
+                pixel[1] = pixel[2] = 64;
+                pixel[3] = (x - 16) * (x - 16) + (y - 16) * (y - 16) < 256 ? 230 : 0;
+            }
+        }
+    }
+    compositor.addLayer(solidCompositorLayer(cv::Rect(0, 0, frameSize.width, frameSize.height), cv::Scalar(40, 40, 40, 255)));
+    for (int i = 0; i < level.header().brickCount; i++) {
+        const LevelImageBrick &brick = level.bricks()[i];
+        cv::Size size = brickTypeBoardSize(brick.type);
+        compositor.addLayer(imageCompositorLayer(cv::Rect(brick.x * cellSize.width, brick.y * cellSize.height, size.width * cellSize.width, size.height * cellSize.height), brickImage));
+    }
+    std::vector<int> figureLayers;
+    std::vector<cv::Point> figurePositions;
+    for (int i = 0; i < level.header().heroCount + level.header().monsterCount; i++) {
+        const LevelImageFigure &figure = i < level.header().heroCount ? level.heroes()[i] : level.monsters()[i - level.header().heroCount];
+        figurePositions.push_back(cv::Point(figure.x, figure.y));
+        figureLayers.push_back(compositor.addLayer(imageCompositorLayer(cv::Rect(figure.x * cellSize.width, figure.y * cellSize.height, cellSize.width, cellSize.height), figureImage)));
+    }
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    compositor.render();
+    double fullFrameTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    long long pixels = 0;
+    startTime = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frameCount; frame++) {
+        int figure = frame % figureLayers.size();
+        cv::Point p = figurePositions[figure];
+        p.x = p.x + (frame / figureLayers.size() % 2 == 0 ? 1 : -1);
+        figurePositions[figure] = p;
+        compositor.setLayerFrame(figureLayers[figure], cv::Rect(p.x * cellSize.width, p.y * cellSize.height, cellSize.width, cellSize.height));
+        compositor.render();
+        pixels += compositor.renderedPixelCount();
+    }
+    double incrementalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout << "Full frame: " << fullFrameTime * 1000.0 << " ms" << std::endl;
+    std::cout << "Incremental frame: " << incrementalTime * 1000.0 / frameCount << " ms, " << pixels / frameCount << " pixels redrawn" << std::endl;
+    return 0;
+}
+
+#endif
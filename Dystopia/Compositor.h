@@ -0,0 +1,114 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_Compositor_h
+#define Dystopia_Compositor_h
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#define COMPOSITOR_LAYER_SOLID 0
+#define COMPOSITOR_LAYER_IMAGE 1
+
+// Dirty rectangles kept apart before they are all merged into one
+#define COMPOSITOR_MAX_DIRTY_RECTS 32
+
+// A layer of the display list. Images are 8 bit RGBA with straight alpha, masks 8 bit single channel, and both are
+// scaled to the frame of the layer nearest neighbour. Colors are RGBA
+typedef struct {
+    int type;
+    cv::Rect frame;
+    cv::Scalar color;
+    cv::Mat image;
+    cv::Mat mask;
+    float alpha;
+    bool visible;
+} CompositorLayer;
+
+CompositorLayer solidCompositorLayer(cv::Rect frame, cv::Scalar color, float alpha = 1.0f);
+CompositorLayer imageCompositorLayer(cv::Rect frame, const cv::Mat &image, float alpha = 1.0f);
+
+// Builds a frame from a display list of layers, back to front, into a bitmap that is reused between frames.
+//
+// Changing a layer marks its old and new frame dirty, and render only redraws dirty rectangles. Free of any UI
+// framework, so frames can be made and measured headless.
+
+class Compositor {
+public:
+    explicit Compositor(cv::Size size, cv::Scalar backgroundColor = cv::Scalar(0, 0, 0, 255));
+
+    // Returns id of the new layer, placed in front of all others
+    int addLayer(const CompositorLayer &layer);
+    void removeLayer(int layerId);
+
+    const CompositorLayer &layer(int layerId) const;
+    void updateLayer(int layerId, const CompositorLayer &layer);
+
+    void setLayerFrame(int layerId, cv::Rect frame);
+    void setLayerAlpha(int layerId, float alpha);
+    void setLayerVisible(int layerId, bool visible);
+    void bringLayerToFront(int layerId);
+
+    // Content of the layer's image or mask changed in place
+    void invalidateLayer(int layerId);
+    void invalidate(cv::Rect rect);
+
+    // Redraws dirty rectangles. Returns false if nothing was dirty
+    bool render();
+
+    // RGBA, valid until the next render
+    const cv::Mat &frame() const;
+
+    // Rectangles redrawn by the last render
+    const std::vector<cv::Rect> &renderedRects() const;
+
+    long long renderedPixelCount() const;
+
+private:
+    struct LayerSlot {
+        CompositorLayer layer;
+        bool used;
+    };
+
+    void drawLayer(const CompositorLayer &layer, cv::Rect clip);
+
+    cv::Mat frameBitmap;
+    cv::Scalar background;
+
+    std::vector<LayerSlot> layers;
+    std::vector<int> displayList;
+    std::vector<int> freeLayerIds;
+
+    std::vector<cv::Rect> dirtyRects;
+    std::vector<cv::Rect> lastRenderedRects;
+    long long renderedPixels;
+
+    std::vector<int> sourceColumns;
+};
+
+#endif
@@ -26,10 +26,8 @@
 #import <UIKit/UIKit.h>
 
 #import "BrickView.h"
-
-#define CONNECTION_TYPE_VIEW_GLUE 0
-#define CONNECTION_TYPE_DOOR      1
-#define CONNECTION_TYPE_HALLWAY   2
+#import "GameRules.h"
+#import "RevealMaskAtlas.h"
 
 @interface ConnectionView : UIView
 
@@ -45,6 +43,7 @@
 - (bool)canOpen;
 
 - (void)addGradientViewWithImage:(UIImage *)image extent:(int)extent;
+- (void)setRevealMaskAtlas:(RevealMaskAtlas *)atlas region1:(int)region1 region2:(int)region2;
 
 - (CGRect)brickMaskRectPosition1:(cv::Point)p1 position2:(cv::Point)p2;
 
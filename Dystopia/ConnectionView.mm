@@ -32,6 +32,11 @@
     UIImage *gradientImage;
     int gradientExtent;
     UIView *blackOverlayView;
+
+    // Reveal mask of each side, prerendered at level load
+    RevealMaskAtlas *revealMaskAtlas;
+    int revealMaskRegion1;
+    int revealMaskRegion2;
 }
 
 @end
@@ -74,6 +79,9 @@
     self.alpha = 0.0f;
     visible = NO;
     open = NO;
+    revealMaskAtlas = nil;
+    revealMaskRegion1 = -1;
+    revealMaskRegion2 = -1;
 }
 
 - (void)show {
@@ -138,12 +146,25 @@
     gradientExtent = extent;
 }
 
+- (void)setRevealMaskAtlas:(RevealMaskAtlas *)atlas region1:(int)region1 region2:(int)region2 {
+    revealMaskAtlas = atlas;
+    revealMaskRegion1 = region1;
+    revealMaskRegion2 = region2;
+}
+
 - (void)createMaskViewWithView:(BrickView *)brickView connectedViews:(NSArray *)brickViews {
-    maskView.frame = [[BoardUtil instance] brickViewsBoundingRect:brickViews];
+    int region = brickView == brickView1 ? revealMaskRegion1 : revealMaskRegion2;
+    bool hasAtlasRegion = revealMaskAtlas != nil && revealMaskAtlas.image != NULL && region != -1;
+
+    maskView.frame = hasAtlasRegion ? [revealMaskAtlas frameForRegion:region] : [[BoardUtil instance] brickViewsBoundingRect:brickViews];
     maskView.backgroundColor = [UIColor clearColor];
     maskView.clipsToBounds = YES;
     
-    [self setupMaskLayerWithViews:brickViews];
+    if (hasAtlasRegion) {
+        [self setupMaskLayerWithAtlasRegion:region];
+    } else {
+        [self setupMaskLayerWithViews:brickViews];
+    }
     [self setupGradientViewForPosition:(brickView == brickView1 ? position1 : position2)];
     [self setupBlackOverlayViews];
 
@@ -158,6 +179,15 @@
     maskView.layer.mask = connectionMaskLayer;
 }
 
+- (void)setupMaskLayerWithAtlasRegion:(int)region {
+    connectionMaskLayer = [CALayer layer];
+    connectionMaskLayer.frame = maskView.bounds;
+    connectionMaskLayer.backgroundColor = [UIColor clearColor].CGColor;
+    connectionMaskLayer.contents = (__bridge id)revealMaskAtlas.image;
+    connectionMaskLayer.contentsRect = [revealMaskAtlas contentsRectForRegion:region];
+    maskView.layer.mask = connectionMaskLayer;
+}
+
 - (void)setupGradientViewForPosition:(cv::Point)p {
     if (gradientImage == nil) {
         return;
@@ -35,6 +35,8 @@
 - (void)addDoorAtPosition1:(cv::Point)position1 position2:(cv::Point)position2 type:(int)type;
 - (void)addHallwayConnectionAtPosition1:(cv::Point)position1 position2:(cv::Point)position2;
 
+- (void)prepareRevealMasks;
+
 - (bool)shouldOpenDoorAtPosition:(cv::Point)position;
 
 - (NSMutableArray *)reveilConnection:(ConnectionView *)connectionView;
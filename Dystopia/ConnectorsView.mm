@@ -30,7 +30,9 @@
 
 ConnectorsView *connectorsViewInstance = nil;
 
-@interface ConnectorsView ()
+@interface ConnectorsView () {
+    RevealMaskAtlas *revealMaskAtlas;
+}
 
 @end
 
@@ -97,6 +99,19 @@ ConnectorsView *connectorsViewInstance = nil;
     return NO;
 }
 
+- (void)prepareRevealMasks {
+    revealMaskAtlas = [[RevealMaskAtlas alloc] init];
+    for (ConnectionView *connectionView in connectionViews) {
+        if (connectionView.type == CONNECTION_TYPE_VIEW_GLUE) {
+            continue;
+        }
+        int region1 = [revealMaskAtlas addMaskWithBrickViews:[self connectedBrickViewsForView:connectionView.brickView1]];
+        int region2 = [revealMaskAtlas addMaskWithBrickViews:[self connectedBrickViewsForView:connectionView.brickView2]];
+        [connectionView setRevealMaskAtlas:revealMaskAtlas region1:region1 region2:region2];
+    }
+    [revealMaskAtlas render];
+}
+
 - (NSMutableArray *)reveilConnection:(ConnectionView *)connectionView {
     NSMutableArray *connectedBrickViews = [NSMutableArray array];
     if (!connectionView.brickView1.visible) {
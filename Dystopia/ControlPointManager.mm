@@ -0,0 +1,183 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "ControlPointManager.h"
+#import "Board.h"
+
+#define CONTROL_POINT_MINIMUM_RELATIVE_BRIGHTNESS 0.8f
+#define CONTROL_POINT_FIGURE_CLEARANCE 1
+
+@interface ControlPointManager () {
+    cv::vector<cv::Point> controlPoints;
+    bool occludedMap[BOARD_HEIGHT][BOARD_WIDTH];
+
+    int cachedBrickMapVersion;
+    int cachedCount;
+    bool valid;
+}
+
+@end
+
+ControlPointManager *controlPointManagerInstance = nil;
+
+@implementation ControlPointManager
+
++ (ControlPointManager *)instance {
+    @synchronized(self) {
+        if (controlPointManagerInstance == nil) {
+            controlPointManagerInstance = [[ControlPointManager alloc] init];
+        }
+        return controlPointManagerInstance;
+    }
+}
+
+- (id)init {
+    if (self = [super init]) {
+        [self clearOccludedMap];
+        valid = NO;
+    }
+    return self;
+}
+
+- (cv::vector<cv::Point>)controlPointsWithCount:(int)count inImage:(cv::Mat)image {
+    @synchronized(self) {
+        if (valid && cachedBrickMapVersion == [Board instance].brickMapVersion && cachedCount == count) {
+            return controlPoints;
+        }
+        if (cachedBrickMapVersion != [Board instance].brickMapVersion) {
+            [self clearOccludedMap];
+        }
+        controlPoints = [self stratifiedControlPointsWithCount:count inImage:image];
+        cachedBrickMapVersion = [Board instance].brickMapVersion;
+        cachedCount = count;
+        valid = YES;
+        return controlPoints;
+    }
+}
+
+- (void)reportOccludedControlPoint:(cv::Point)p {
+    @synchronized(self) {
+        if (![self isControlPoint:p]) {
+            return;
+        }
+        if (DEBUG) {
+            NSLog(@"Control point %i, %i occluded", p.x, p.y);
+        }
+        occludedMap[p.y][p.x] = YES;
+        valid = NO;
+    }
+}
+
+// Callers hold the lock, as controlPointsWithCount may replace the control points at any time
+- (bool)isControlPoint:(cv::Point)p {
+    return std::find(controlPoints.begin(), controlPoints.end(), p) != controlPoints.end();
+}
+
+- (void)invalidate {
+    @synchronized(self) {
+        [self clearOccludedMap];
+        valid = NO;
+    }
+}
+
+- (void)clearOccludedMap {
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            occludedMap[i][j] = NO;
+        }
+    }
+}
+
+- (cv::vector<cv::Point>)stratifiedControlPointsWithCount:(int)count inImage:(cv::Mat)image {
+
+    // Mean brightness of every cell
+    cv::Mat cellImage;
+    cv::resize(image, cellImage, cv::Size(BOARD_WIDTH, BOARD_HEIGHT), 0, 0, cv::INTER_AREA);
+
+    // Shadows are judged relative to the median cell brightness of the visible board
+    cv::vector<uchar> brightnesses;
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            if ([self isCandidatePosition:cv::Point(j, i)]) {
+                brightnesses.push_back(cellImage.at<uchar>(i, j));
+            }
+        }
+    }
+    if (brightnesses.size() == 0) {
+        return cv::vector<cv::Point>();
+    }
+    std::nth_element(brightnesses.begin(), brightnesses.begin() + (brightnesses.size() / 2), brightnesses.end());
+    float minimumBrightness = brightnesses[brightnesses.size() / 2] * CONTROL_POINT_MINIMUM_RELATIVE_BRIGHTNESS;
+
+    // Brightest acceptable cell within each stratum
+    cv::vector<cv::Point> strataPoints;
+    for (int sy = 0; sy < CONTROL_POINT_STRATA_Y; sy++) {
+        for (int sx = 0; sx < CONTROL_POINT_STRATA_X; sx++) {
+            cv::Point bestPosition = cv::Point(-1, -1);
+            int bestBrightness = -1;
+            for (int i = (sy * BOARD_HEIGHT) / CONTROL_POINT_STRATA_Y; i < ((sy + 1) * BOARD_HEIGHT) / CONTROL_POINT_STRATA_Y; i++) {
+                for (int j = (sx * BOARD_WIDTH) / CONTROL_POINT_STRATA_X; j < ((sx + 1) * BOARD_WIDTH) / CONTROL_POINT_STRATA_X; j++) {
+                    cv::Point p = cv::Point(j, i);
+                    int brightness = cellImage.at<uchar>(i, j);
+                    if (brightness > bestBrightness && brightness >= minimumBrightness && [self isCandidatePosition:p]) {
+                        bestBrightness = brightness;
+                        bestPosition = p;
+                    }
+                }
+            }
+            if (bestPosition.x != -1) {
+                strataPoints.push_back(bestPosition);
+            }
+        }
+    }
+
+    // Spread the requested count evenly over the non-empty strata
+    if (strataPoints.size() <= count) {
+        return strataPoints;
+    }
+    cv::vector<cv::Point> points;
+    for (int i = 0; i < count; i++) {
+        points.push_back(strataPoints[(i * strataPoints.size()) / count]);
+    }
+    return points;
+}
+
+- (bool)isCandidatePosition:(cv::Point)p {
+    if (![[Board instance] hasVisibleBrickAtPosition:p] || occludedMap[p.y][p.x]) {
+        return NO;
+    }
+
+    // Keep clear of figures - they cast shadows and hands reach around them
+    for (int i = -CONTROL_POINT_FIGURE_CLEARANCE; i <= CONTROL_POINT_FIGURE_CLEARANCE; i++) {
+        for (int j = -CONTROL_POINT_FIGURE_CLEARANCE; j <= CONTROL_POINT_FIGURE_CLEARANCE; j++) {
+            if ([[Board instance] hasObjectAtPosition:cv::Point(p.x + j, p.y + i)]) {
+                return NO;
+            }
+        }
+    }
+    return YES;
+}
+
+@end
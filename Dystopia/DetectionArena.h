@@ -0,0 +1,134 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_DetectionArena_h
+#define Dystopia_DetectionArena_h
+
+#include <opencv2/core/core.hpp>
+
+#define LINE_DIRECTION_HORIZONTAL_UP   0
+#define LINE_DIRECTION_HORIZONTAL_DOWN 1
+#define LINE_DIRECTION_VERTICAL_LEFT   2
+#define LINE_DIRECTION_VERTICAL_RIGHT  3
+
+#define LINE_DIRECTION_COUNT 4
+
+#define DETECTION_ARENA_CONTOUR_SETS 3
+
+typedef struct {
+    int start;
+    int count;
+} Span;
+
+typedef struct {
+    cv::Point p1;
+    cv::Point p2;
+    float angle;
+} LineWithAngle;
+
+typedef struct {
+    Span lines;
+    int firstLine;
+    int lastLine;
+    LineWithAngle minLine;
+    LineWithAngle maxLine;
+    LineWithAngle average;
+    float lineDistance;
+    float angle;
+    int direction;
+} LineGroup;
+
+// Scratch geometry of a board detection pass.
+//
+// Contours, lines and line groups live in flat arrays and refer to each other by index spans. The arena is reset, not freed,
+// at the start of each frame - arrays keep their capacity, so detection stops allocating once they fit a typical frame.
+//
+// Lines are linked into their group through nextLineInGroup while grouping, and are then laid out contiguously in
+// groupedLines so that each group refers to its lines by a span.
+
+struct DetectionArena {
+
+    // Contours as found by cv::findContours, one set per canny thresholding mode. Overwritten, not cleared, to keep the
+    // capacity of the inner vectors
+    cv::vector<cv::vector<cv::Point>> contours[DETECTION_ARENA_CONTOUR_SETS];
+    cv::vector<cv::Vec4i> hierarchy[DETECTION_ARENA_CONTOUR_SETS];
+
+    // Approximated contours
+    cv::vector<cv::Point> approxedPoints;
+    cv::vector<Span> approxedContours;
+    cv::vector<int> contourIndices;
+    cv::vector<int> validContourIndices;
+
+    // Lines and line groups
+    cv::vector<LineWithAngle> lines;
+    cv::vector<int> nextLineInGroup;
+    cv::vector<LineGroup> lineGroups;
+    cv::vector<LineWithAngle> groupedLines;
+    cv::vector<int> borderLineGroups;
+    Span borderLineGroupsInDirection[LINE_DIRECTION_COUNT];
+
+    // Square search
+    cv::vector<cv::Point> intersectionPoints;
+    cv::vector<cv::Point> squarePoints;
+    cv::vector<cv::Point> hull;
+    cv::vector<cv::Point> bestSquarePoints;
+
+    // General purpose point scratch
+    cv::vector<cv::Point> points;
+
+    void reset() {
+        approxedPoints.clear();
+        approxedContours.clear();
+        contourIndices.clear();
+        validContourIndices.clear();
+        lines.clear();
+        nextLineInGroup.clear();
+        lineGroups.clear();
+        groupedLines.clear();
+        borderLineGroups.clear();
+        for (int i = 0; i < LINE_DIRECTION_COUNT; i++) {
+            borderLineGroupsInDirection[i].start = 0;
+            borderLineGroupsInDirection[i].count = 0;
+        }
+        intersectionPoints.clear();
+        squarePoints.clear();
+        hull.clear();
+        bestSquarePoints.clear();
+        points.clear();
+    }
+};
+
+inline Span appendPointsToStorage(cv::vector<cv::Point> &storage, const cv::vector<cv::Point> &points) {
+    Span span = {.start = (int)storage.size(), .count = (int)points.size()};
+    storage.insert(storage.end(), points.begin(), points.end());
+    return span;
+}
+
+// Matrix header over points in flat storage, for OpenCV functions taking contours
+inline cv::Mat contourMat(const cv::Point *points, int count) {
+    return cv::Mat(count, 1, CV_32SC2, (void *)points);
+}
+
+#endif
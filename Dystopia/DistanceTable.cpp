@@ -0,0 +1,177 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+
+#include "DistanceTable.h"
+
+#define DISTANCE_TABLE_ROW_MASK ((uint32_t)((1ull << BOARD_WIDTH) - 1))
+
+void clearBitboard(Bitboard &board) {
+    memset(board.rows, 0, sizeof(board.rows));
+}
+
+bool bitboardContains(const Bitboard &board, cv::Point position) {
+    return position.x >= 0 && position.y >= 0 && position.x < BOARD_WIDTH && position.y < BOARD_HEIGHT && ((board.rows[position.y] >> position.x) & 1);
+}
+
+void setBitboardCell(Bitboard &board, cv::Point position) {
+    board.rows[position.y] |= 1u << position.x;
+}
+
+bool bitboardsEqual(const Bitboard &board1, const Bitboard &board2) {
+    return memcmp(board1.rows, board2.rows, sizeof(board1.rows)) == 0;
+}
+
+bool expandFrontier(const Bitboard &frontier, const Bitboard &allowed, Bitboard &seen, Bitboard &next) {
+    bool expanded = false;
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        uint32_t row = frontier.rows[i];
+        uint32_t neighbours = (row << 1) | (row >> 1);
+        if (i > 0) {
+            neighbours |= frontier.rows[i - 1];
+        }
+        if (i < BOARD_HEIGHT - 1) {
+            neighbours |= frontier.rows[i + 1];
+        }
+        next.rows[i] = neighbours & DISTANCE_TABLE_ROW_MASK & allowed.rows[i] & ~seen.rows[i];
+        seen.rows[i] |= next.rows[i];
+        expanded |= next.rows[i] != 0;
+    }
+    return expanded;
+}
+
+DistanceTable::DistanceTable() : reusedRegions(0) {
+    memset(regionMap, -1, sizeof(regionMap));
+    memset(cellIndexMap, -1, sizeof(cellIndexMap));
+}
+
+DistanceTable::DistanceTable(const Bitboard &walkable, const DistanceTable *previous) : reusedRegions(0) {
+    memset(regionMap, -1, sizeof(regionMap));
+    memset(cellIndexMap, -1, sizeof(cellIndexMap));
+
+    Bitboard assigned;
+    clearBitboard(assigned);
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            if (!bitboardContains(walkable, cv::Point(j, i)) || bitboardContains(assigned, cv::Point(j, i))) {
+                continue;
+            }
+
+            // Region of the cell by flood fill
+            Region region;
+            Bitboard frontier;
+            Bitboard next;
+            clearBitboard(frontier);
+            setBitboardCell(frontier, cv::Point(j, i));
+            region.cells = frontier;
+            while (expandFrontier(frontier, walkable, region.cells, next)) {
+                frontier = next;
+            }
+            region.cellCount = 0;
+            for (int y = 0; y < BOARD_HEIGHT; y++) {
+                assigned.rows[y] |= region.cells.rows[y];
+                for (uint32_t row = region.cells.rows[y]; row != 0; row &= row - 1) {
+                    int x = __builtin_ctz(row);
+                    regionMap[y][x] = regions.size();
+                    cellIndexMap[y][x] = region.cellCount++;
+                }
+            }
+
+            int previousRegion = previous != NULL ? previous->regionAtPosition(cv::Point(j, i)) : -1;
+            if (previousRegion != -1 && bitboardsEqual(previous->regions[previousRegion].cells, region.cells)) {
+                region.narrowDistances = previous->regions[previousRegion].narrowDistances;
+                region.wideDistances = previous->regions[previousRegion].wideDistances;
+                reusedRegions++;
+            } else {
+                computeRegion(region);
+            }
+            regions.push_back(region);
+        }
+    }
+}
+
+void DistanceTable::computeRegion(Region &region) {
+
+    // A byte holds every distance if the region has at most 256 cells, 255 being the longest path
+    bool narrow = region.cellCount <= 256;
+    if (narrow) {
+        region.narrowDistances.assign(region.cellCount * region.cellCount, 0);
+    } else {
+        region.wideDistances.assign(region.cellCount * region.cellCount, 0);
+    }
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (uint32_t startRow = region.cells.rows[i]; startRow != 0; startRow &= startRow - 1) {
+            int start = cellIndexMap[i][__builtin_ctz(startRow)];
+            int rowOffset = start * region.cellCount;
+
+            Bitboard frontier;
+            Bitboard seen;
+            Bitboard next;
+            clearBitboard(frontier);
+            setBitboardCell(frontier, cv::Point(__builtin_ctz(startRow), i));
+            seen = frontier;
+            for (int distance = 1; expandFrontier(frontier, region.cells, seen, next); distance++) {
+                for (int y = 0; y < BOARD_HEIGHT; y++) {
+                    for (uint32_t row = next.rows[y]; row != 0; row &= row - 1) {
+                        int cell = rowOffset + cellIndexMap[y][__builtin_ctz(row)];
+                        if (narrow) {
+                            region.narrowDistances[cell] = distance;
+                        } else {
+                            region.wideDistances[cell] = distance;
+                        }
+                    }
+                }
+                frontier = next;
+            }
+        }
+    }
+}
+
+int DistanceTable::regionAtPosition(cv::Point position) const {
+    return position.x >= 0 && position.y >= 0 && position.x < BOARD_WIDTH && position.y < BOARD_HEIGHT ? regionMap[position.y][position.x] : -1;
+}
+
+int DistanceTable::distance(cv::Point from, cv::Point to) const {
+    int region = regionAtPosition(from);
+    if (region == -1 || regionAtPosition(to) != region) {
+        return DISTANCE_TABLE_UNREACHABLE;
+    }
+    const Region &r = regions[region];
+    int cell = cellIndexMap[from.y][from.x] * r.cellCount + cellIndexMap[to.y][to.x];
+    return r.narrowDistances.size() > 0 ? r.narrowDistances[cell] : r.wideDistances[cell];
+}
+
+const Bitboard &DistanceTable::regionCells(int region) const {
+    return regions[region].cells;
+}
+
+int DistanceTable::regionCount() const {
+    return (int)regions.size();
+}
+
+int DistanceTable::reusedRegionCount() const {
+    return reusedRegions;
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_DistanceTable_h
+#define Dystopia_DistanceTable_h
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "GameRules.h"
+
+#define DISTANCE_TABLE_UNREACHABLE -1
+
+// Bit x of row y is cell (x, y)
+typedef struct {
+    uint32_t rows[BOARD_HEIGHT];
+} Bitboard;
+
+void clearBitboard(Bitboard &board);
+bool bitboardContains(const Bitboard &board, cv::Point position);
+void setBitboardCell(Bitboard &board, cv::Point position);
+bool bitboardsEqual(const Bitboard &board1, const Bitboard &board2);
+
+// Cells next to the frontier that are allowed and not yet seen, added to seen. Returns false if there were none
+bool expandFrontier(const Bitboard &frontier, const Bitboard &allowed, Bitboard &seen, Bitboard &next);
+
+// Steps between every two walkable cells of a region, regions being the groups of walkable cells connected to each
+// other. Distances are stored a byte each, or two bytes in regions too large for a byte to hold every distance.
+//
+// Built when the revealed board changes. Regions with the same cells as in the table before are copied over, so
+// opening a door only recomputes the region it merged.
+
+class DistanceTable {
+public:
+    DistanceTable();
+    DistanceTable(const Bitboard &walkable, const DistanceTable *previous);
+
+    int regionAtPosition(cv::Point position) const;
+
+    // Steps from one cell to the other, or DISTANCE_TABLE_UNREACHABLE
+    int distance(cv::Point from, cv::Point to) const;
+
+    const Bitboard &regionCells(int region) const;
+
+    int regionCount() const;
+    int reusedRegionCount() const;
+
+private:
+    struct Region {
+        Bitboard cells;
+        int cellCount;
+        std::vector<uint8_t> narrowDistances;
+        std::vector<uint16_t> wideDistances;
+    };
+
+    void computeRegion(Region &region);
+
+    int16_t regionMap[BOARD_HEIGHT][BOARD_WIDTH];
+    int16_t cellIndexMap[BOARD_HEIGHT][BOARD_WIDTH];
+    std::vector<Region> regions;
+    int reusedRegions;
+};
+
+#endif
@@ -0,0 +1,128 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+
+#include "FigureRegistry.h"
+
+#define FIGURE_BIT(flag) (1 << (flag))
+
+typedef struct {
+    int requiredFlags;
+    int excludedFlags;
+} FigureViewDefinition;
+
+// In FIGURE_VIEW_* order
+static const FigureViewDefinition FIGURE_VIEWS[FIGURE_VIEW_COUNT] = {
+    {.requiredFlags = 0, .excludedFlags = 0},
+    {.requiredFlags = FIGURE_BIT(FIGURE_FLAG_VISIBLE), .excludedFlags = 0},
+    {.requiredFlags = FIGURE_BIT(FIGURE_FLAG_VISIBLE) | FIGURE_BIT(FIGURE_FLAG_ACTIVE), .excludedFlags = 0},
+    {.requiredFlags = FIGURE_BIT(FIGURE_FLAG_HERO), .excludedFlags = 0},
+    {.requiredFlags = FIGURE_BIT(FIGURE_FLAG_MONSTER), .excludedFlags = 0},
+    {.requiredFlags = FIGURE_BIT(FIGURE_FLAG_MONSTER) | FIGURE_BIT(FIGURE_FLAG_VISIBLE), .excludedFlags = 0},
+    {.requiredFlags = FIGURE_BIT(FIGURE_FLAG_MONSTER), .excludedFlags = FIGURE_BIT(FIGURE_FLAG_VISIBLE)},
+    {.requiredFlags = FIGURE_BIT(FIGURE_FLAG_MONSTER) | FIGURE_BIT(FIGURE_FLAG_ACTIVE), .excludedFlags = 0},
+    {.requiredFlags = FIGURE_BIT(FIGURE_FLAG_MONSTER) | FIGURE_BIT(FIGURE_FLAG_ACTIVE), .excludedFlags = FIGURE_BIT(FIGURE_FLAG_RECOGNIZED)},
+    {.requiredFlags = FIGURE_BIT(FIGURE_FLAG_HERO), .excludedFlags = FIGURE_BIT(FIGURE_FLAG_RECOGNIZED)}
+};
+
+FigureRegistry::FigureRegistry() {
+    clear();
+}
+
+void FigureRegistry::clear() {
+    figureCount = 0;
+    memset(flags, 0, sizeof(flags));
+    memset(views, 0, sizeof(views));
+}
+
+int FigureRegistry::add(int kind, cv::Point position) {
+    if (figureCount >= MAX_FIGURES) {
+        return -1;
+    }
+    int index = figureCount++;
+    positions[index] = position;
+    for (int i = 0; i < FIGURE_FLAG_COUNT; i++) {
+        flags[i] &= ~((FigureSet)1 << index);
+    }
+    flags[kind] |= (FigureSet)1 << index;
+    refreshViews(index);
+    return index;
+}
+
+void FigureRegistry::remove(int index) {
+    setFlag(index, FIGURE_FLAG_HERO, false);
+    setFlag(index, FIGURE_FLAG_MONSTER, false);
+}
+
+int FigureRegistry::count() const {
+    return figureCount;
+}
+
+bool FigureRegistry::flag(int index, int flag) const {
+    return (flags[flag] >> index) & 1;
+}
+
+void FigureRegistry::setFlag(int index, int flag, bool value) {
+    if (index < 0 || index >= figureCount || this->flag(index, flag) == value) {
+        return;
+    }
+    flags[flag] ^= (FigureSet)1 << index;
+    refreshViews(index);
+}
+
+cv::Point FigureRegistry::position(int index) const {
+    return positions[index];
+}
+
+void FigureRegistry::setPosition(int index, cv::Point position) {
+    if (index >= 0 && index < figureCount) {
+        positions[index] = position;
+    }
+}
+
+FigureSet FigureRegistry::view(int view) const {
+    return views[view];
+}
+
+void FigureRegistry::refreshViews(int index) {
+    int figureFlags = 0;
+    for (int i = 0; i < FIGURE_FLAG_COUNT; i++) {
+        figureFlags |= flag(index, i) ? FIGURE_BIT(i) : 0;
+    }
+
+    // Removed figures are neither hero nor monster and belong to no view
+    bool onBoard = (figureFlags & (FIGURE_BIT(FIGURE_FLAG_HERO) | FIGURE_BIT(FIGURE_FLAG_MONSTER))) != 0;
+
+    FigureSet bit = (FigureSet)1 << index;
+    for (int i = 0; i < FIGURE_VIEW_COUNT; i++) {
+        const FigureViewDefinition &definition = FIGURE_VIEWS[i];
+        if (onBoard && (figureFlags & definition.requiredFlags) == definition.requiredFlags && (figureFlags & definition.excludedFlags) == 0) {
+            views[i] |= bit;
+        } else {
+            views[i] &= ~bit;
+        }
+    }
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_FigureRegistry_h
+#define Dystopia_FigureRegistry_h
+
+#include <stdint.h>
+
+#include <opencv2/core/core.hpp>
+
+#include "GameRules.h"
+
+#define FIGURE_FLAG_HERO       0
+#define FIGURE_FLAG_MONSTER    1
+#define FIGURE_FLAG_VISIBLE    2
+#define FIGURE_FLAG_ACTIVE     3
+#define FIGURE_FLAG_RECOGNIZED 4
+
+#define FIGURE_FLAG_COUNT 5
+
+#define FIGURE_VIEW_BOARD_OBJECTS                 0
+#define FIGURE_VIEW_VISIBLE_BOARD_OBJECTS         1
+#define FIGURE_VIEW_ACTIVE_BOARD_OBJECTS          2
+#define FIGURE_VIEW_HEROES                        3
+#define FIGURE_VIEW_MONSTERS                      4
+#define FIGURE_VIEW_VISIBLE_MONSTERS              5
+#define FIGURE_VIEW_INVISIBLE_MONSTERS            6
+#define FIGURE_VIEW_ACTIVE_MONSTERS               7
+#define FIGURE_VIEW_UNRECOGNIZED_ACTIVE_MONSTERS  8
+#define FIGURE_VIEW_UNRECOGNIZED_HEROES           9
+
+#define FIGURE_VIEW_COUNT 10
+
+// One bit per figure index
+typedef uint64_t FigureSet;
+
+// Figure positions and flags stored column wise, one bitset per flag. Each view is the set of figures whose flags
+// match it and is kept up to date as flags change, so reading a view is a single load.
+
+class FigureRegistry {
+public:
+    FigureRegistry();
+
+    void clear();
+
+    // Returns index of the new figure, or -1 if the registry is full. Kind is FIGURE_FLAG_HERO or FIGURE_FLAG_MONSTER
+    int add(int kind, cv::Point position);
+
+    // Leaves the figure out of every view. Its index is not reused until cleared
+    void remove(int index);
+
+    int count() const;
+
+    bool flag(int index, int flag) const;
+    void setFlag(int index, int flag, bool value);
+
+    cv::Point position(int index) const;
+    void setPosition(int index, cv::Point position);
+
+    FigureSet view(int view) const;
+
+private:
+    void refreshViews(int index);
+
+    int figureCount;
+    cv::Point positions[MAX_FIGURES];
+    FigureSet flags[FIGURE_FLAG_COUNT];
+    FigureSet views[FIGURE_VIEW_COUNT];
+};
+
+// Iterates the figures of a set in index order, mapping each index through a table of figures. Does not allocate, and
+// the set is copied so flags may change while iterating.
+
+template <typename T> class FigureSetRange {
+public:
+    class iterator {
+    public:
+        iterator(FigureSet s, T const *f) : set(s), figures(f) {}
+
+        T operator*() const { return figures[__builtin_ctzll(set)]; }
+        iterator &operator++() { set &= set - 1; return *this; }
+        bool operator!=(const iterator &other) const { return set != other.set; }
+
+    private:
+        FigureSet set;
+        T const *figures;
+    };
+
+    FigureSetRange(FigureSet s, T const *f) : set(s), figures(f) {}
+
+    iterator begin() const { return iterator(set, figures); }
+    iterator end() const { return iterator(0, figures); }
+
+    int count() const { return __builtin_popcountll(set); }
+
+private:
+    FigureSet set;
+    T const *figures;
+};
+
+#endif
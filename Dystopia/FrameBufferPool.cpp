@@ -0,0 +1,92 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "FrameBufferPool.h"
+
+FrameBufferPool &FrameBufferPool::instance() {
+    static FrameBufferPool frameBufferPoolInstance;
+    return frameBufferPoolInstance;
+}
+
+FrameBufferPool::FrameBufferPool() : allocations(0) {
+    buffers.reserve(FRAME_BUFFER_POOL_CAPACITY);
+}
+
+cv::Mat FrameBufferPool::acquire(int rows, int cols, int type) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Reuse free buffer of same size and type
+    int evictableIndex = -1;
+    for (int i = 0; i < buffers.size(); i++) {
+        if (!isBufferFree(buffers[i])) {
+            continue;
+        }
+        if (buffers[i].rows == rows && buffers[i].cols == cols && buffers[i].type() == type) {
+            return buffers[i];
+        }
+        evictableIndex = i;
+    }
+
+    // Allocate new buffer
+    cv::Mat buffer(rows, cols, type);
+    allocations++;
+
+    if (buffers.size() < FRAME_BUFFER_POOL_CAPACITY) {
+        buffers.push_back(buffer);
+    } else if (evictableIndex != -1) {
+        buffers[evictableIndex] = buffer;
+    }
+    return buffer;
+}
+
+cv::Mat FrameBufferPool::acquire(cv::Size size, int type) {
+    return acquire(size.height, size.width, type);
+}
+
+void FrameBufferPool::ensure(cv::Mat &image, int rows, int cols, int type) {
+    if (image.rows == rows && image.cols == cols && image.type() == type && image.isContinuous()) {
+        return;
+    }
+    image = acquire(rows, cols, type);
+}
+
+void FrameBufferPool::ensure(cv::Mat &image, cv::Size size, int type) {
+    ensure(image, size.height, size.width, type);
+}
+
+int FrameBufferPool::allocationCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return allocations;
+}
+
+void FrameBufferPool::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffers.clear();
+}
+
+bool FrameBufferPool::isBufferFree(const cv::Mat &buffer) {
+    // Only referenced by the pool itself. Other threads release their references with atomic decrements, so read it atomically
+    return buffer.refcount != NULL && __atomic_load_n(buffer.refcount, __ATOMIC_ACQUIRE) == 1;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_FrameBufferPool_h
+#define Dystopia_FrameBufferPool_h
+
+#include <mutex>
+#include <opencv2/core/core.hpp>
+
+#define FRAME_BUFFER_POOL_CAPACITY 32
+
+// Pool of image buffers for the vision pipeline, keyed by size and type.
+//
+// Buffers are handed out as ordinary cv::Mat's. A buffer is free again once the last cv::Mat referencing it is released,
+// so stages never return buffers explicitly. Stages write into caller-provided buffers and only take a buffer from the
+// pool if the provided one does not fit, so the frame loop stops allocating once every buffer size has been seen.
+
+class FrameBufferPool {
+public:
+    static FrameBufferPool &instance();
+
+    // Returns a buffer of the given size and type which nobody else references
+    cv::Mat acquire(int rows, int cols, int type);
+    cv::Mat acquire(cv::Size size, int type);
+
+    // Makes sure image is a buffer of the given size and type, keeping it if it already is
+    void ensure(cv::Mat &image, int rows, int cols, int type);
+    void ensure(cv::Mat &image, cv::Size size, int type);
+
+    // Number of buffers allocated so far - stays constant in steady state
+    int allocationCount();
+
+    void clear();
+
+private:
+    FrameBufferPool();
+
+    bool isBufferFree(const cv::Mat &buffer);
+
+    std::mutex mutex;
+    cv::vector<cv::Mat> buffers;
+    int allocations;
+};
+
+#endif
@@ -0,0 +1,431 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#define FRAME_PREPROCESSOR_NEON 1
+#include <arm_neon.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#define FRAME_PREPROCESSOR_X86 1
+#include <immintrin.h>
+#endif
+
+#include "FramePreprocessor.h"
+#include "FrameBufferPool.h"
+
+// RGB to luma weights in 8-bit fixed point (0.299, 0.587, 0.114)
+#define FRAME_PREPROCESSOR_GRAY_WEIGHT_R 77
+#define FRAME_PREPROCESSOR_GRAY_WEIGHT_G 150
+#define FRAME_PREPROCESSOR_GRAY_WEIGHT_B 29
+#define FRAME_PREPROCESSOR_GRAY_SHIFT 8
+
+// Separable 3x3 gaussian with sigma 1 (0.274, 0.452, 0.274) in 6-bit fixed point
+#define FRAME_PREPROCESSOR_BLUR_SIDE_WEIGHT 18
+#define FRAME_PREPROCESSOR_BLUR_CENTER_WEIGHT 28
+#define FRAME_PREPROCESSOR_BLUR_SHIFT 6
+
+typedef void (*GrayRowFunction)(const unsigned char *rgba, unsigned char *gray, int count);
+typedef void (*BlendRowFunction)(const unsigned char *a, const unsigned char *b, const unsigned char *c, unsigned char *dst, int count);
+typedef void (*RangeOfRowFunction)(const unsigned char *row, int count, unsigned char *min, unsigned char *max);
+
+typedef struct {
+    const char *name;
+    GrayRowFunction grayRow;
+    BlendRowFunction blendRow;
+    RangeOfRowFunction rangeOfRow;
+} FramePreprocessorKernels;
+
+static inline unsigned char grayPixel(const unsigned char *rgba) {
+    return (unsigned char)((rgba[0] * FRAME_PREPROCESSOR_GRAY_WEIGHT_R +
+                            rgba[1] * FRAME_PREPROCESSOR_GRAY_WEIGHT_G +
+                            rgba[2] * FRAME_PREPROCESSOR_GRAY_WEIGHT_B +
+                            (1 << (FRAME_PREPROCESSOR_GRAY_SHIFT - 1))) >> FRAME_PREPROCESSOR_GRAY_SHIFT);
+}
+
+static inline unsigned char blendPixel(unsigned char a, unsigned char b, unsigned char c) {
+    return (unsigned char)(((a + c) * FRAME_PREPROCESSOR_BLUR_SIDE_WEIGHT +
+                            b * FRAME_PREPROCESSOR_BLUR_CENTER_WEIGHT +
+                            (1 << (FRAME_PREPROCESSOR_BLUR_SHIFT - 1))) >> FRAME_PREPROCESSOR_BLUR_SHIFT);
+}
+
+static inline int reflectedIndex(int index, int count) {
+    if (count == 1) {
+        return 0;
+    }
+    if (index < 0) {
+        return -index;
+    }
+    if (index >= count) {
+        return count * 2 - 2 - index;
+    }
+    return index;
+}
+
+// Scalar kernels, also used for the tails of the vectorized ones
+
+static void grayRowScalar(const unsigned char *rgba, unsigned char *gray, int count) {
+    for (int i = 0; i < count; i++) {
+        gray[i] = grayPixel(rgba + i * 4);
+    }
+}
+
+static void blendRowScalar(const unsigned char *a, const unsigned char *b, const unsigned char *c, unsigned char *dst, int count) {
+    for (int i = 0; i < count; i++) {
+        dst[i] = blendPixel(a[i], b[i], c[i]);
+    }
+}
+
+static void rangeOfRowScalar(const unsigned char *row, int count, unsigned char *min, unsigned char *max) {
+    unsigned char rowMin = *min;
+    unsigned char rowMax = *max;
+    for (int i = 0; i < count; i++) {
+        rowMin = std::min(rowMin, row[i]);
+        rowMax = std::max(rowMax, row[i]);
+    }
+    *min = rowMin;
+    *max = rowMax;
+}
+
+#if FRAME_PREPROCESSOR_X86
+
+// SSE2 kernels
+
+static inline __m128i grayOfFourPixelsSSE2(__m128i pixels) {
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    __m128i r = _mm_and_si128(pixels, mask);
+    __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 8), mask);
+    __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 16), mask);
+
+    // Upper halves of the 32-bit lanes are zero, so 16-bit multiplies give exact 32-bit products
+    __m128i sum = _mm_mullo_epi16(r, _mm_set1_epi32(FRAME_PREPROCESSOR_GRAY_WEIGHT_R));
+    sum = _mm_add_epi32(sum, _mm_mullo_epi16(g, _mm_set1_epi32(FRAME_PREPROCESSOR_GRAY_WEIGHT_G)));
+    sum = _mm_add_epi32(sum, _mm_mullo_epi16(b, _mm_set1_epi32(FRAME_PREPROCESSOR_GRAY_WEIGHT_B)));
+    sum = _mm_add_epi32(sum, _mm_set1_epi32(1 << (FRAME_PREPROCESSOR_GRAY_SHIFT - 1)));
+    return _mm_srli_epi32(sum, FRAME_PREPROCESSOR_GRAY_SHIFT);
+}
+
+static void grayRowSSE2(const unsigned char *rgba, unsigned char *gray, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i *source = (const __m128i *)(rgba + i * 4);
+        __m128i gray0 = grayOfFourPixelsSSE2(_mm_loadu_si128(source + 0));
+        __m128i gray1 = grayOfFourPixelsSSE2(_mm_loadu_si128(source + 1));
+        __m128i gray2 = grayOfFourPixelsSSE2(_mm_loadu_si128(source + 2));
+        __m128i gray3 = grayOfFourPixelsSSE2(_mm_loadu_si128(source + 3));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(gray0, gray1), _mm_packs_epi32(gray2, gray3));
+        _mm_storeu_si128((__m128i *)(gray + i), packed);
+    }
+    grayRowScalar(rgba + i * 4, gray + i, count - i);
+}
+
+static inline __m128i blendHalfSSE2(__m128i a, __m128i b, __m128i c) {
+    __m128i sum = _mm_mullo_epi16(_mm_add_epi16(a, c), _mm_set1_epi16(FRAME_PREPROCESSOR_BLUR_SIDE_WEIGHT));
+    sum = _mm_add_epi16(sum, _mm_mullo_epi16(b, _mm_set1_epi16(FRAME_PREPROCESSOR_BLUR_CENTER_WEIGHT)));
+    sum = _mm_add_epi16(sum, _mm_set1_epi16(1 << (FRAME_PREPROCESSOR_BLUR_SHIFT - 1)));
+    return _mm_srli_epi16(sum, FRAME_PREPROCESSOR_BLUR_SHIFT);
+}
+
+static void blendRowSSE2(const unsigned char *a, const unsigned char *b, const unsigned char *c, unsigned char *dst, int count) {
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i vc = _mm_loadu_si128((const __m128i *)(c + i));
+        __m128i low = blendHalfSSE2(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero), _mm_unpacklo_epi8(vc, zero));
+        __m128i high = blendHalfSSE2(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero), _mm_unpackhi_epi8(vc, zero));
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(low, high));
+    }
+    blendRowScalar(a + i, b + i, c + i, dst + i, count - i);
+}
+
+static void rangeOfRowSSE2(const unsigned char *row, int count, unsigned char *min, unsigned char *max) {
+    int i = 0;
+    if (count >= 16) {
+        __m128i rowMin = _mm_set1_epi8((char)*min);
+        __m128i rowMax = _mm_set1_epi8((char)*max);
+        for (; i + 16 <= count; i += 16) {
+            __m128i values = _mm_loadu_si128((const __m128i *)(row + i));
+            rowMin = _mm_min_epu8(rowMin, values);
+            rowMax = _mm_max_epu8(rowMax, values);
+        }
+        unsigned char lanes[16];
+        _mm_storeu_si128((__m128i *)lanes, rowMin);
+        rangeOfRowScalar(lanes, 16, min, max);
+        _mm_storeu_si128((__m128i *)lanes, rowMax);
+        rangeOfRowScalar(lanes, 16, min, max);
+    }
+    rangeOfRowScalar(row + i, count - i, min, max);
+}
+
+// AVX2 kernels; compiled for AVX2 regardless of target flags and only used if the CPU supports it
+
+#define FRAME_PREPROCESSOR_AVX2 __attribute__((target("avx2")))
+
+FRAME_PREPROCESSOR_AVX2 static inline __m256i grayOfEightPixelsAVX2(__m256i pixels) {
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    __m256i r = _mm256_and_si256(pixels, mask);
+    __m256i g = _mm256_and_si256(_mm256_srli_epi32(pixels, 8), mask);
+    __m256i b = _mm256_and_si256(_mm256_srli_epi32(pixels, 16), mask);
+
+    __m256i sum = _mm256_mullo_epi16(r, _mm256_set1_epi32(FRAME_PREPROCESSOR_GRAY_WEIGHT_R));
+    sum = _mm256_add_epi32(sum, _mm256_mullo_epi16(g, _mm256_set1_epi32(FRAME_PREPROCESSOR_GRAY_WEIGHT_G)));
+    sum = _mm256_add_epi32(sum, _mm256_mullo_epi16(b, _mm256_set1_epi32(FRAME_PREPROCESSOR_GRAY_WEIGHT_B)));
+    sum = _mm256_add_epi32(sum, _mm256_set1_epi32(1 << (FRAME_PREPROCESSOR_GRAY_SHIFT - 1)));
+    return _mm256_srli_epi32(sum, FRAME_PREPROCESSOR_GRAY_SHIFT);
+}
+
+FRAME_PREPROCESSOR_AVX2 static void grayRowAVX2(const unsigned char *rgba, unsigned char *gray, int count) {
+    // Packing works within 128-bit lanes, so the 4-pixel groups are put back in order afterwards
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        const __m256i *source = (const __m256i *)(rgba + i * 4);
+        __m256i gray0 = grayOfEightPixelsAVX2(_mm256_loadu_si256(source + 0));
+        __m256i gray1 = grayOfEightPixelsAVX2(_mm256_loadu_si256(source + 1));
+        __m256i gray2 = grayOfEightPixelsAVX2(_mm256_loadu_si256(source + 2));
+        __m256i gray3 = grayOfEightPixelsAVX2(_mm256_loadu_si256(source + 3));
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(gray0, gray1), _mm256_packs_epi32(gray2, gray3));
+        _mm256_storeu_si256((__m256i *)(gray + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    grayRowSSE2(rgba + i * 4, gray + i, count - i);
+}
+
+FRAME_PREPROCESSOR_AVX2 static inline __m256i blendHalfAVX2(__m256i a, __m256i b, __m256i c) {
+    __m256i sum = _mm256_mullo_epi16(_mm256_add_epi16(a, c), _mm256_set1_epi16(FRAME_PREPROCESSOR_BLUR_SIDE_WEIGHT));
+    sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(b, _mm256_set1_epi16(FRAME_PREPROCESSOR_BLUR_CENTER_WEIGHT)));
+    sum = _mm256_add_epi16(sum, _mm256_set1_epi16(1 << (FRAME_PREPROCESSOR_BLUR_SHIFT - 1)));
+    return _mm256_srli_epi16(sum, FRAME_PREPROCESSOR_BLUR_SHIFT);
+}
+
+FRAME_PREPROCESSOR_AVX2 static void blendRowAVX2(const unsigned char *a, const unsigned char *b, const unsigned char *c, unsigned char *dst, int count) {
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i vc = _mm256_loadu_si256((const __m256i *)(c + i));
+        __m256i low = blendHalfAVX2(_mm256_unpacklo_epi8(va, zero), _mm256_unpacklo_epi8(vb, zero), _mm256_unpacklo_epi8(vc, zero));
+        __m256i high = blendHalfAVX2(_mm256_unpackhi_epi8(va, zero), _mm256_unpackhi_epi8(vb, zero), _mm256_unpackhi_epi8(vc, zero));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_packus_epi16(low, high));
+    }
+    blendRowSSE2(a + i, b + i, c + i, dst + i, count - i);
+}
+
+FRAME_PREPROCESSOR_AVX2 static void rangeOfRowAVX2(const unsigned char *row, int count, unsigned char *min, unsigned char *max) {
+    int i = 0;
+    if (count >= 32) {
+        __m256i rowMin = _mm256_set1_epi8((char)*min);
+        __m256i rowMax = _mm256_set1_epi8((char)*max);
+        for (; i + 32 <= count; i += 32) {
+            __m256i values = _mm256_loadu_si256((const __m256i *)(row + i));
+            rowMin = _mm256_min_epu8(rowMin, values);
+            rowMax = _mm256_max_epu8(rowMax, values);
+        }
+        unsigned char lanes[32];
+        _mm256_storeu_si256((__m256i *)lanes, rowMin);
+        rangeOfRowScalar(lanes, 32, min, max);
+        _mm256_storeu_si256((__m256i *)lanes, rowMax);
+        rangeOfRowScalar(lanes, 32, min, max);
+    }
+    rangeOfRowSSE2(row + i, count - i, min, max);
+}
+
+#endif
+
+#if FRAME_PREPROCESSOR_NEON
+
+// NEON kernels
+
+static void grayRowNEON(const unsigned char *rgba, unsigned char *gray, int count) {
+    const uint8x8_t weightR = vdup_n_u8(FRAME_PREPROCESSOR_GRAY_WEIGHT_R);
+    const uint8x8_t weightG = vdup_n_u8(FRAME_PREPROCESSOR_GRAY_WEIGHT_G);
+    const uint8x8_t weightB = vdup_n_u8(FRAME_PREPROCESSOR_GRAY_WEIGHT_B);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t pixels = vld4q_u8(rgba + i * 4);
+        uint16x8_t low = vmull_u8(vget_low_u8(pixels.val[0]), weightR);
+        low = vmlal_u8(low, vget_low_u8(pixels.val[1]), weightG);
+        low = vmlal_u8(low, vget_low_u8(pixels.val[2]), weightB);
+        uint16x8_t high = vmull_u8(vget_high_u8(pixels.val[0]), weightR);
+        high = vmlal_u8(high, vget_high_u8(pixels.val[1]), weightG);
+        high = vmlal_u8(high, vget_high_u8(pixels.val[2]), weightB);
+        vst1q_u8(gray + i, vcombine_u8(vrshrn_n_u16(low, FRAME_PREPROCESSOR_GRAY_SHIFT), vrshrn_n_u16(high, FRAME_PREPROCESSOR_GRAY_SHIFT)));
+    }
+    grayRowScalar(rgba + i * 4, gray + i, count - i);
+}
+
+static inline uint8x8_t blendHalfNEON(uint8x8_t a, uint8x8_t b, uint8x8_t c) {
+    uint16x8_t sum = vmulq_n_u16(vaddl_u8(a, c), FRAME_PREPROCESSOR_BLUR_SIDE_WEIGHT);
+    sum = vmlal_u8(sum, b, vdup_n_u8(FRAME_PREPROCESSOR_BLUR_CENTER_WEIGHT));
+    return vrshrn_n_u16(sum, FRAME_PREPROCESSOR_BLUR_SHIFT);
+}
+
+static void blendRowNEON(const unsigned char *a, const unsigned char *b, const unsigned char *c, unsigned char *dst, int count) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t va = vld1q_u8(a + i);
+        uint8x16_t vb = vld1q_u8(b + i);
+        uint8x16_t vc = vld1q_u8(c + i);
+        uint8x8_t low = blendHalfNEON(vget_low_u8(va), vget_low_u8(vb), vget_low_u8(vc));
+        uint8x8_t high = blendHalfNEON(vget_high_u8(va), vget_high_u8(vb), vget_high_u8(vc));
+        vst1q_u8(dst + i, vcombine_u8(low, high));
+    }
+    blendRowScalar(a + i, b + i, c + i, dst + i, count - i);
+}
+
+static void rangeOfRowNEON(const unsigned char *row, int count, unsigned char *min, unsigned char *max) {
+    int i = 0;
+    if (count >= 16) {
+        uint8x16_t rowMin = vdupq_n_u8(*min);
+        uint8x16_t rowMax = vdupq_n_u8(*max);
+        for (; i + 16 <= count; i += 16) {
+            uint8x16_t values = vld1q_u8(row + i);
+            rowMin = vminq_u8(rowMin, values);
+            rowMax = vmaxq_u8(rowMax, values);
+        }
+        unsigned char lanes[16];
+        vst1q_u8(lanes, rowMin);
+        rangeOfRowScalar(lanes, 16, min, max);
+        vst1q_u8(lanes, rowMax);
+        rangeOfRowScalar(lanes, 16, min, max);
+    }
+    rangeOfRowScalar(row + i, count - i, min, max);
+}
+
+#endif
+
+static FramePreprocessorKernels selectKernels() {
+#if FRAME_PREPROCESSOR_NEON
+    FramePreprocessorKernels neonKernels = {"neon", grayRowNEON, blendRowNEON, rangeOfRowNEON};
+    return neonKernels;
+#elif FRAME_PREPROCESSOR_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        FramePreprocessorKernels avx2Kernels = {"avx2", grayRowAVX2, blendRowAVX2, rangeOfRowAVX2};
+        return avx2Kernels;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        FramePreprocessorKernels sse2Kernels = {"sse2", grayRowSSE2, blendRowSSE2, rangeOfRowSSE2};
+        return sse2Kernels;
+    }
+#endif
+    FramePreprocessorKernels scalarKernels = {"scalar", grayRowScalar, blendRowScalar, rangeOfRowScalar};
+    return scalarKernels;
+}
+
+static const FramePreprocessorKernels &frameProcessorKernels() {
+    static const FramePreprocessorKernels kernels = selectKernels();
+    return kernels;
+}
+
+static IntensityRange preprocessRows(const unsigned char *rgba, size_t rgbaStride,
+                                     const unsigned char *grayInput, unsigned char *grayOutput, size_t grayStride,
+                                     int width, int height,
+                                     unsigned char *blurred, size_t blurredStride) {
+    IntensityRange range = {.min = 0, .max = 0};
+    if (width <= 0 || height <= 0) {
+        return range;
+    }
+    const FramePreprocessorKernels &kernels = frameProcessorKernels();
+
+    // Vertically blurred row, blurred horizontally into the output row
+    std::vector<unsigned char> columnBlurredRow(width);
+    unsigned char *column = &columnBlurredRow[0];
+
+    unsigned char rangeMin = 255;
+    unsigned char rangeMax = 0;
+    int convertedRows = 0;
+
+    for (int y = 0; y < height; y++) {
+        int rowAbove = reflectedIndex(y - 1, height);
+        int rowBelow = reflectedIndex(y + 1, height);
+
+        // Convert rows just before the blur needs them
+        if (rgba != NULL) {
+            int lastNeededRow = std::max(y, rowBelow);
+            for (; convertedRows <= lastNeededRow; convertedRows++) {
+                kernels.grayRow(rgba + convertedRows * rgbaStride, grayOutput + convertedRows * grayStride, width);
+            }
+        }
+
+        // Vertical pass
+        kernels.blendRow(grayInput + rowAbove * grayStride, grayInput + y * grayStride, grayInput + rowBelow * grayStride, column, width);
+
+        // Horizontal pass with reflected borders
+        unsigned char *output = blurred + y * blurredStride;
+        if (width == 1) {
+            output[0] = column[0];
+        } else {
+            output[0] = blendPixel(column[1], column[0], column[1]);
+            kernels.blendRow(column, column + 1, column + 2, output + 1, width - 2);
+            output[width - 1] = blendPixel(column[width - 2], column[width - 1], column[width - 2]);
+        }
+
+        // Intensity range while the row is still in cache
+        kernels.rangeOfRow(output, width, &rangeMin, &rangeMax);
+    }
+
+    range.min = rangeMin;
+    range.max = rangeMax;
+    return range;
+}
+
+IntensityRange preprocessRGBAFrame(const unsigned char *rgba, int width, int height, size_t rgbaStride,
+                                   unsigned char *gray, size_t grayStride,
+                                   unsigned char *blurred, size_t blurredStride) {
+    return preprocessRows(rgba, rgbaStride, gray, gray, grayStride, width, height, blurred, blurredStride);
+}
+
+IntensityRange preprocessGrayFrame(const unsigned char *gray, int width, int height, size_t grayStride,
+                                   unsigned char *blurred, size_t blurredStride) {
+    return preprocessRows(NULL, 0, gray, NULL, grayStride, width, height, blurred, blurredStride);
+}
+
+const char *framePreprocessorKernelName() {
+    return frameProcessorKernels().name;
+}
+
+float intensityRangeMean(IntensityRange range) {
+    return (range.min + range.max) / 2.0f;
+}
+
+IntensityRange preprocessFrame(const cv::Mat &rgbaImage, cv::Mat &grayImage, cv::Mat &blurredImage) {
+    CV_Assert(rgbaImage.type() == CV_8UC4);
+    FrameBufferPool::instance().ensure(grayImage, rgbaImage.rows, rgbaImage.cols, CV_8UC1);
+    FrameBufferPool::instance().ensure(blurredImage, rgbaImage.rows, rgbaImage.cols, CV_8UC1);
+    return preprocessRGBAFrame(rgbaImage.data, rgbaImage.cols, rgbaImage.rows, rgbaImage.step,
+                               grayImage.data, grayImage.step,
+                               blurredImage.data, blurredImage.step);
+}
+
+IntensityRange preprocessFrame(const cv::Mat &grayImage, cv::Mat &blurredImage) {
+    CV_Assert(grayImage.type() == CV_8UC1);
+    FrameBufferPool::instance().ensure(blurredImage, grayImage.rows, grayImage.cols, CV_8UC1);
+    return preprocessGrayFrame(grayImage.data, grayImage.cols, grayImage.rows, grayImage.step,
+                               blurredImage.data, blurredImage.step);
+}
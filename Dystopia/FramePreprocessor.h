@@ -0,0 +1,59 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_FramePreprocessor_h
+#define Dystopia_FramePreprocessor_h
+
+#include <stddef.h>
+#include <opencv2/core/core.hpp>
+
+// Fused frame preprocessing: grayscale conversion, 3x3 gaussian blur (sigma 1) and min/max intensity in one streamed pass.
+// Rows are converted just before they are needed by the blur, so every source row is touched once while it is still in cache.
+
+typedef struct {
+    int min;
+    int max;
+} IntensityRange;
+
+// Converts an RGBA (or RGBX) frame to gray and blurred gray while computing the intensity range of the blurred image
+IntensityRange preprocessRGBAFrame(const unsigned char *rgba, int width, int height, size_t rgbaStride,
+                                   unsigned char *gray, size_t grayStride,
+                                   unsigned char *blurred, size_t blurredStride);
+
+// Blurs an already grayscaled frame while computing the intensity range of the blurred image
+IntensityRange preprocessGrayFrame(const unsigned char *gray, int width, int height, size_t grayStride,
+                                   unsigned char *blurred, size_t blurredStride);
+
+// Name of the kernel set picked at runtime (scalar, sse2, avx2 or neon)
+const char *framePreprocessorKernelName();
+
+// Mean of min and max intensity, as used for automatic canny thresholding
+float intensityRangeMean(IntensityRange range);
+
+// Convenience wrappers; output images are taken from the frame buffer pool unless they already fit
+IntensityRange preprocessFrame(const cv::Mat &rgbaImage, cv::Mat &grayImage, cv::Mat &blurredImage);
+IntensityRange preprocessFrame(const cv::Mat &grayImage, cv::Mat &blurredImage);
+
+#endif
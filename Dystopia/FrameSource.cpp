@@ -0,0 +1,113 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "FrameSource.h"
+#include "FrameBufferPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static double currentTime() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RawFrameSource::RawFrameSource(int fd, int w, int h, float fps) : fileDescriptor(fd), width(w), height(h), framesPerSecond(fps), nextFrameTime(0.0) {
+}
+
+RawFrameSource::~RawFrameSource() {
+    if (fileDescriptor != -1) {
+        close(fileDescriptor);
+    }
+}
+
+RawFrameSource *RawFrameSource::openFile(const char *path, int width, int height, float framesPerSecond) {
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) {
+        return NULL;
+    }
+    return new RawFrameSource(fd, width, height, framesPerSecond);
+}
+
+RawFrameSource *RawFrameSource::connect(const char *host, int port, int width, int height) {
+    char portString[16];
+    snprintf(portString, sizeof(portString), "%i", port);
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    struct addrinfo *addresses;
+    if (getaddrinfo(host, portString, &hints, &addresses) != 0) {
+        return NULL;
+    }
+    int fd = -1;
+    for (struct addrinfo *address = addresses; address != NULL && fd == -1; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd != -1 && ::connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(addresses);
+    return fd != -1 ? new RawFrameSource(fd, width, height) : NULL;
+}
+
+bool RawFrameSource::nextFrame(cv::Mat &image) {
+    if (framesPerSecond > 0.0f) {
+        double now = currentTime();
+        if (nextFrameTime > now) {
+            std::this_thread::sleep_for(std::chrono::duration<double>(nextFrameTime - now));
+        }
+        nextFrameTime = std::max(now, nextFrameTime) + (1.0 / framesPerSecond);
+    }
+    FrameBufferPool::instance().ensure(image, height, width, CV_8UC1);
+    return readFully(image.data, width * height);
+}
+
+void RawFrameSource::interrupt() {
+
+    // Only unblocks sockets; reads from files never block for long
+    shutdown(fileDescriptor, SHUT_RDWR);
+}
+
+bool RawFrameSource::readFully(unsigned char *data, size_t length) {
+    size_t offset = 0;
+    while (offset < length) {
+        ssize_t count = read(fileDescriptor, data + offset, length - offset);
+        if (count <= 0) {
+            return false;
+        }
+        offset += count;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_FrameSource_h
+#define Dystopia_FrameSource_h
+
+#include <opencv2/core/core.hpp>
+
+// Stream of camera frames from something other than the device camera.
+class FrameSource {
+public:
+    virtual ~FrameSource() {}
+
+    // Reads the next frame into image, reusing its buffer if it fits. Returns false once the stream has ended
+    virtual bool nextFrame(cv::Mat &image) = 0;
+
+    // Makes a blocked nextFrame return so the reading thread can be stopped
+    virtual void interrupt() {}
+};
+
+// Raw 8 bit grayscale frames of a fixed size, back to back on a file descriptor - a recorded file or a connected socket.
+class RawFrameSource : public FrameSource {
+public:
+    RawFrameSource(int fileDescriptor, int width, int height, float framesPerSecond = 0.0f);
+    ~RawFrameSource();
+
+    // Both return NULL if the file could not be opened or the connection failed
+    static RawFrameSource *openFile(const char *path, int width, int height, float framesPerSecond = 0.0f);
+    static RawFrameSource *connect(const char *host, int port, int width, int height);
+
+    bool nextFrame(cv::Mat &image);
+    void interrupt();
+
+private:
+    bool readFully(unsigned char *data, size_t length);
+
+    int fileDescriptor;
+    int width;
+    int height;
+
+    // Recorded files are played back at this rate; 0 reads as fast as the consumer takes frames
+    float framesPerSecond;
+    double nextFrameTime;
+};
+
+#endif
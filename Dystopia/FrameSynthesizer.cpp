@@ -0,0 +1,626 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "FrameSynthesizer.h"
+
+// Camera response, applied after the light on a surface has been summed up
+#define FRAME_SYNTHESIZER_CAMERA_GAMMA 2.2f
+
+// Share of ambient light reflected by the black feet of the bricks
+#define FRAME_SYNTHESIZER_FOOT_REFLECTANCE 0.05f
+
+// Length of the forearm drawn behind a palm, in cells
+#define FRAME_SYNTHESIZER_ARM_LENGTH 8.0f
+
+#define FRAME_SYNTHESIZER_FINGER_COUNT 4
+
+namespace {
+
+    typedef struct {
+        cv::Point2f p1;
+        cv::Point2f p2;
+        float radius;
+    } Capsule;
+
+    float linearLight(int value, float gamma) {
+        return powf(value / 255.0f, gamma);
+    }
+
+    uint8_t cameraValue(float light) {
+        return (uint8_t)(powf(std::min(std::max(light, 0.0f), 1.0f), 1.0f / FRAME_SYNTHESIZER_CAMERA_GAMMA) * 255.0f + 0.5f);
+    }
+
+    bool capsuleCovers(const Capsule &capsule, cv::Point2f p) {
+        cv::Point2f d = capsule.p2 - capsule.p1;
+        float lengthSquared = d.dot(d);
+        float t = lengthSquared > 0.0f ? std::min(std::max((p - capsule.p1).dot(d) / lengthSquared, 0.0f), 1.0f) : 0.0f;
+        cv::Point2f offset = p - (capsule.p1 + d * t);
+        return offset.dot(offset) <= capsule.radius * capsule.radius;
+    }
+
+    // Palm, fingers, thumb and forearm
+    std::vector<Capsule> handCapsules(const HandOccluder &hand) {
+        std::vector<Capsule> capsules;
+        cv::Point2f direction = cv::Point2f(cosf(hand.angle), sinf(hand.angle));
+        capsules.push_back((Capsule){.p1 = hand.palm, .p2 = hand.palm, .radius = hand.palmRadius});
+        capsules.push_back((Capsule){.p1 = hand.palm, .p2 = hand.palm - direction * FRAME_SYNTHESIZER_ARM_LENGTH, .radius = hand.palmRadius * 0.75f});
+        for (int i = 0; i < FRAME_SYNTHESIZER_FINGER_COUNT; i++) {
+            float angle = hand.angle + (i - (FRAME_SYNTHESIZER_FINGER_COUNT - 1) / 2.0f) * 0.28f;
+            cv::Point2f fingerDirection = cv::Point2f(cosf(angle), sinf(angle));
+            cv::Point2f base = hand.palm + fingerDirection * (hand.palmRadius * 0.8f);
+            capsules.push_back((Capsule){.p1 = base, .p2 = base + fingerDirection * hand.fingerLength, .radius = hand.palmRadius * 0.22f});
+        }
+        float thumbAngle = hand.angle + 1.2f;
+        cv::Point2f thumbDirection = cv::Point2f(cosf(thumbAngle), sinf(thumbAngle));
+        cv::Point2f thumbBase = hand.palm + thumbDirection * (hand.palmRadius * 0.8f);
+        capsules.push_back((Capsule){.p1 = thumbBase, .p2 = thumbBase + thumbDirection * (hand.fingerLength * 0.7f), .radius = hand.palmRadius * 0.25f});
+        return capsules;
+    }
+
+    bool handsCover(const std::vector<std::vector<Capsule> > &hands, cv::Point2f p) {
+        for (const std::vector<Capsule> &capsules : hands) {
+            for (const Capsule &capsule : capsules) {
+                if (capsuleCovers(capsule, p)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Plain 8x8 solve of the four point correspondence, h[8] = 1
+    bool homographyFromPoints(const cv::Point2f src[4], const cv::Point2f dst[4], double h[9]) {
+        double a[8][9];
+        for (int i = 0; i < 4; i++) {
+            double x = src[i].x, y = src[i].y, u = dst[i].x, v = dst[i].y;
+            double row1[9] = {x, y, 1.0, 0.0, 0.0, 0.0, -x * u, -y * u, u};
+            double row2[9] = {0.0, 0.0, 0.0, x, y, 1.0, -x * v, -y * v, v};
+            memcpy(a[i * 2], row1, sizeof(row1));
+            memcpy(a[i * 2 + 1], row2, sizeof(row2));
+        }
+        for (int column = 0; column < 8; column++) {
+            int pivot = column;
+            for (int row = column + 1; row < 8; row++) {
+                if (fabs(a[row][column]) > fabs(a[pivot][column])) {
+                    pivot = row;
+                }
+            }
+            if (fabs(a[pivot][column]) < 1e-12) {
+                return false;
+            }
+            for (int k = 0; k < 9; k++) {
+                std::swap(a[column][k], a[pivot][k]);
+            }
+            for (int row = 0; row < 8; row++) {
+                if (row == column) {
+                    continue;
+                }
+                double factor = a[row][column] / a[column][column];
+                for (int k = column; k < 9; k++) {
+                    a[row][k] -= factor * a[column][k];
+                }
+            }
+        }
+        for (int i = 0; i < 8; i++) {
+            h[i] = a[i][8] / a[i][i];
+        }
+        h[8] = 1.0;
+        return true;
+    }
+
+}
+
+FrameSynthesizerSettings defaultFrameSynthesizerSettings(cv::Size frameSize) {
+    FrameSynthesizerSettings settings;
+    settings.frameSize = frameSize;
+    settings.projectionCorners[0] = cv::Point2f(frameSize.width * 0.08f, frameSize.height * 0.10f);
+    settings.projectionCorners[1] = cv::Point2f(frameSize.width * 0.93f, frameSize.height * 0.06f);
+    settings.projectionCorners[2] = cv::Point2f(frameSize.width * 0.96f, frameSize.height * 0.93f);
+    settings.projectionCorners[3] = cv::Point2f(frameSize.width * 0.05f, frameSize.height * 0.90f);
+    settings.lensDistortion[0] = -0.05f;
+    settings.lensDistortion[1] = 0.01f;
+    settings.projectorGamma = 2.2f;
+    settings.projectorBrightness = 0.85f;
+    settings.ambientLight = 0.2f;
+    settings.tableColor = cv::Scalar(150, 115, 80);
+    settings.skinColor = cv::Scalar(225, 170, 140);
+    settings.lightingGradient[0] = 0.1f;
+    settings.lightingGradient[1] = -0.05f;
+    settings.brickAlbedo = 0.8f;
+    settings.brickInset = 0.06f;
+    settings.brickFootWidth = 0.1f;
+    settings.blurRadius = 1;
+    settings.noiseSigma = 4.0f;
+    return settings;
+}
+
+FrameSynthesizerSettings jitteredFrameSynthesizerSettings(const FrameSynthesizerSettings &settings, std::mt19937 &random) {
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    FrameSynthesizerSettings jittered = settings;
+    for (int i = 0; i < 4; i++) {
+        jittered.projectionCorners[i].x += unit(random) * settings.frameSize.width * 0.02f;
+        jittered.projectionCorners[i].y += unit(random) * settings.frameSize.height * 0.02f;
+    }
+    jittered.lensDistortion[0] += unit(random) * 0.03f;
+    jittered.projectorGamma = std::max(1.0f, settings.projectorGamma + unit(random) * 0.2f);
+    jittered.projectorBrightness = std::max(0.1f, settings.projectorBrightness + unit(random) * 0.1f);
+    jittered.ambientLight = std::max(0.0f, settings.ambientLight + unit(random) * 0.05f);
+    jittered.lightingGradient[0] += unit(random) * 0.1f;
+    jittered.lightingGradient[1] += unit(random) * 0.1f;
+    return jittered;
+}
+
+FrameSynthesizer::FrameSynthesizer(const FrameSynthesizerSettings &settings, const cv::Mat &projectedImage, unsigned int seed) : frameSettings(settings), random(seed), builtMaps(0) {
+    projectedSource = projectedImage;
+    buildProjection();
+    buildMap();
+    buildNoiseTable();
+}
+
+const FrameSynthesizerSettings &FrameSynthesizer::settings() const {
+    return frameSettings;
+}
+
+void FrameSynthesizer::setSettings(const FrameSynthesizerSettings &settings) {
+    bool geometryChanged = settings.frameSize != frameSettings.frameSize || settings.lensDistortion[0] != frameSettings.lensDistortion[0] || settings.lensDistortion[1] != frameSettings.lensDistortion[1] ||
+                           settings.lightingGradient[0] != frameSettings.lightingGradient[0] || settings.lightingGradient[1] != frameSettings.lightingGradient[1] ||
+                           settings.ambientLight != frameSettings.ambientLight || settings.tableColor != frameSettings.tableColor;
+    for (int i = 0; i < 4; i++) {
+        geometryChanged |= settings.projectionCorners[i] != frameSettings.projectionCorners[i];
+    }
+    bool noiseChanged = settings.noiseSigma != frameSettings.noiseSigma || settings.frameSize.width != frameSettings.frameSize.width;
+    frameSettings = settings;
+
+    buildProjection();
+    if (geometryChanged) {
+        buildMap();
+    }
+    if (noiseChanged) {
+        buildNoiseTable();
+    }
+}
+
+void FrameSynthesizer::setProjectedImage(const cv::Mat &projectedImage) {
+    bool sizeChanged = projectedImage.size() != projectedSource.size();
+    projectedSource = projectedImage;
+    buildProjection();
+    if (sizeChanged) {
+        buildMap();
+    }
+}
+
+int FrameSynthesizer::mapBuildCount() const {
+    return builtMaps;
+}
+
+void FrameSynthesizer::buildProjection() {
+    // Light reaching the camera from the table, brick tops and hands for each projected value
+    uint8_t surfaceValues[3][256];
+    for (int v = 0; v < 256; v++) {
+        float projectedLight = frameSettings.projectorBrightness * linearLight(v, frameSettings.projectorGamma);
+        for (int c = 0; c < 3; c++) {
+            surfaceValues[c][v] = cameraValue(projectedLight + frameSettings.ambientLight * frameSettings.tableColor[c] / 255.0f);
+            brickValues[c][v] = cameraValue(frameSettings.brickAlbedo * (projectedLight + frameSettings.ambientLight));
+            skinValues[c][v] = cameraValue(frameSettings.skinColor[c] / 255.0f * (projectedLight + frameSettings.ambientLight));
+        }
+    }
+    footValue = cameraValue(frameSettings.ambientLight * FRAME_SYNTHESIZER_FOOT_REFLECTANCE);
+
+    litProjection.create(projectedSource.rows, projectedSource.cols, CV_8UC4);
+    for (int y = 0; y < projectedSource.rows; y++) {
+        const uint8_t *source = projectedSource.ptr<uint8_t>(y);
+        uint8_t *lit = litProjection.ptr<uint8_t>(y);
+        for (int x = 0; x < projectedSource.cols; x++, source += 4, lit += 4) {
+            lit[0] = surfaceValues[0][source[0]];
+            lit[1] = surfaceValues[1][source[1]];
+            lit[2] = surfaceValues[2][source[2]];
+            lit[3] = 255;
+        }
+    }
+    litProjection.copyTo(sceneImage);
+    drawnRects.clear();
+}
+
+void FrameSynthesizer::buildMap() {
+    builtMaps++;
+    int width = frameSettings.frameSize.width;
+    int height = frameSettings.frameSize.height;
+    sourceOffsets.resize(width * height);
+    gains.resize(width * height);
+
+    for (int c = 0; c < 3; c++) {
+        tablePixel[c] = cameraValue(frameSettings.ambientLight * frameSettings.tableColor[c] / 255.0f);
+    }
+    tablePixel[3] = 255;
+
+    cv::Point2f sceneCorners[4] = {
+        cv::Point2f(0.0f, 0.0f),
+        cv::Point2f(projectedSource.cols, 0.0f),
+        cv::Point2f(projectedSource.cols, projectedSource.rows),
+        cv::Point2f(0.0f, projectedSource.rows)
+    };
+    double h[9];
+    if (!homographyFromPoints(frameSettings.projectionCorners, sceneCorners, h)) {
+        std::fill(sourceOffsets.begin(), sourceOffsets.end(), -1);
+        std::fill(gains.begin(), gains.end(), 256);
+        return;
+    }
+
+    float centerX = width / 2.0f;
+    float centerY = height / 2.0f;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            // Frame pixel to undistorted camera position to projected image position
+            cv::Point2f camera = undistortedFramePosition(cv::Point2f(x + 0.5f, y + 0.5f));
+            double cameraX = camera.x;
+            double cameraY = camera.y;
+            double w = h[6] * cameraX + h[7] * cameraY + h[8];
+            double sceneX = (h[0] * cameraX + h[1] * cameraY + h[2]) / w;
+            double sceneY = (h[3] * cameraX + h[4] * cameraY + h[5]) / w;
+
+            int i = y * width + x;
+            bool inside = w > 0.0 && sceneX >= 0.0 && sceneY >= 0.0 && sceneX < projectedSource.cols && sceneY < projectedSource.rows;
+            sourceOffsets[i] = inside ? ((int)sceneY * projectedSource.cols + (int)sceneX) * 4 : -1;
+
+            float gain = 1.0f + frameSettings.lightingGradient[0] * (x - centerX) / centerX + frameSettings.lightingGradient[1] * (y - centerY) / centerY;
+            gains[i] = (uint16_t)(std::min(std::max(gain, 0.0f), 4.0f) * 256.0f);
+        }
+    }
+}
+
+void FrameSynthesizer::buildNoiseTable() {
+    // Long enough to read a full row from any offset, and alpha is left alone
+    noiseTable.resize(FRAME_SYNTHESIZER_NOISE_TABLE_SIZE + frameSettings.frameSize.width * 4);
+    std::normal_distribution<float> normal(0.0f, std::max(frameSettings.noiseSigma, 0.0f));
+    for (int i = 0; i < (int)noiseTable.size(); i++) {
+        noiseTable[i] = i % 4 != 3 && frameSettings.noiseSigma > 0.0f ? (int8_t)std::min(std::max(roundf(normal(random)), -127.0f), 127.0f) : 0;
+    }
+}
+
+SyntheticScene FrameSynthesizer::randomScene(int maxBrickCount, int maxHandCount) {
+    SyntheticScene scene;
+    std::uniform_int_distribution<int> brickCount(0, maxBrickCount);
+    std::uniform_int_distribution<int> handCount(0, maxHandCount);
+    std::uniform_int_distribution<int> cellX(1, BOARD_WIDTH - 2);
+    std::uniform_int_distribution<int> cellY(1, BOARD_HEIGHT - 2);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    for (int i = brickCount(random); i > 0; i--) {
+        cv::Point position = cv::Point(cellX(random), cellY(random));
+        if (std::find(scene.brickPositions.begin(), scene.brickPositions.end(), position) == scene.brickPositions.end()) {
+            scene.brickPositions.push_back(position);
+        }
+    }
+    for (int i = handCount(random); i > 0; i--) {
+        HandOccluder hand;
+        hand.palm = cv::Point2f(unit(random) * BOARD_WIDTH, unit(random) * BOARD_HEIGHT);
+        hand.palmRadius = 1.3f + unit(random) * 0.5f;
+        hand.fingerLength = 2.0f + unit(random) * 1.0f;
+
+        // Reaching in from the nearest edge
+        cv::Point2f center = cv::Point2f(BOARD_WIDTH / 2.0f, BOARD_HEIGHT / 2.0f);
+        hand.angle = atan2f(center.y - hand.palm.y, center.x - hand.palm.x) + (unit(random) - 0.5f);
+        scene.hands.push_back(hand);
+    }
+    return scene;
+}
+
+void FrameSynthesizer::render(const SyntheticScene &scene, cv::Mat &frame, SyntheticFrameLabel &label) {
+    restoreScene();
+    for (const cv::Point &position : scene.brickPositions) {
+        drawBrick(position);
+    }
+    for (const HandOccluder &hand : scene.hands) {
+        drawHand(hand);
+    }
+
+    // Perspective, lens and lighting by table lookup
+    frame.create(frameSettings.frameSize.height, frameSettings.frameSize.width, CV_8UC4);
+    const uint8_t *scenePixels = sceneImage.ptr<uint8_t>(0);
+    int width = frame.cols;
+    for (int y = 0; y < frame.rows; y++) {
+        uint8_t *pixel = frame.ptr<uint8_t>(y);
+        const int32_t *offsets = &sourceOffsets[y * width];
+        const uint16_t *rowGains = &gains[y * width];
+        for (int x = 0; x < width; x++, pixel += 4) {
+            const uint8_t *source = offsets[x] >= 0 ? scenePixels + offsets[x] : tablePixel;
+            int gain = rowGains[x];
+            pixel[0] = (uint8_t)std::min((source[0] * gain) >> 8, 255);
+            pixel[1] = (uint8_t)std::min((source[1] * gain) >> 8, 255);
+            pixel[2] = (uint8_t)std::min((source[2] * gain) >> 8, 255);
+            pixel[3] = 255;
+        }
+    }
+    blurFrame(frame);
+    addNoise(frame);
+
+    std::vector<std::vector<Capsule> > hands;
+    for (const HandOccluder &hand : scene.hands) {
+        hands.push_back(handCapsules(hand));
+    }
+    for (int i = 0; i < 4; i++) {
+        label.boardCorners[i] = distortedFramePosition(frameSettings.projectionCorners[i]);
+    }
+    label.brickPositions.clear();
+    label.occludedPositions.clear();
+    for (int y = 0; y < BOARD_HEIGHT; y++) {
+        for (int x = 0; x < BOARD_WIDTH; x++) {
+            if (handsCover(hands, cv::Point2f(x + 0.5f, y + 0.5f))) {
+                label.occludedPositions.push_back(cv::Point(x, y));
+            }
+        }
+    }
+    for (const cv::Point &position : scene.brickPositions) {
+        if (std::find(label.occludedPositions.begin(), label.occludedPositions.end(), position) == label.occludedPositions.end()) {
+            label.brickPositions.push_back(position);
+        }
+    }
+}
+
+void FrameSynthesizer::restoreScene() {
+    // Only what the last frame drew on top of the projection is copied back
+    for (const cv::Rect &rect : drawnRects) {
+        for (int y = rect.y; y < rect.y + rect.height; y++) {
+            memcpy(sceneImage.ptr<uint8_t>(y) + rect.x * 4, litProjection.ptr<uint8_t>(y) + rect.x * 4, rect.width * 4);
+        }
+    }
+    drawnRects.clear();
+}
+
+void FrameSynthesizer::drawBrick(cv::Point position) {
+    float cellWidth = projectedSource.cols / (float)BOARD_WIDTH;
+    float cellHeight = projectedSource.rows / (float)BOARD_HEIGHT;
+    int x1 = std::max(0, (int)((position.x + frameSettings.brickInset) * cellWidth));
+    int y1 = std::max(0, (int)((position.y + frameSettings.brickInset) * cellHeight));
+    int x2 = std::min(projectedSource.cols, (int)((position.x + 1.0f - frameSettings.brickInset) * cellWidth));
+    int y2 = std::min(projectedSource.rows, (int)((position.y + 1.0f - frameSettings.brickInset) * cellHeight));
+    int footX = std::max(1, (int)(frameSettings.brickFootWidth * cellWidth));
+    int footY = std::max(1, (int)(frameSettings.brickFootWidth * cellHeight));
+    if (x2 <= x1 || y2 <= y1) {
+        return;
+    }
+    drawnRects.push_back(cv::Rect(x1, y1, x2 - x1, y2 - y1));
+
+    for (int y = y1; y < y2; y++) {
+        const uint8_t *source = projectedSource.ptr<uint8_t>(y) + x1 * 4;
+        uint8_t *pixel = sceneImage.ptr<uint8_t>(y) + x1 * 4;
+        bool footRow = y < y1 + footY || y >= y2 - footY;
+        for (int x = x1; x < x2; x++, source += 4, pixel += 4) {
+            if (footRow || x < x1 + footX || x >= x2 - footX) {
+                pixel[0] = pixel[1] = pixel[2] = footValue;
+            } else {
+                pixel[0] = brickValues[0][source[0]];
+                pixel[1] = brickValues[1][source[1]];
+                pixel[2] = brickValues[2][source[2]];
+            }
+        }
+    }
+}
+
+void FrameSynthesizer::drawHand(const HandOccluder &hand) {
+    float cellWidth = projectedSource.cols / (float)BOARD_WIDTH;
+    float cellHeight = projectedSource.rows / (float)BOARD_HEIGHT;
+
+    // Each capsule is filled within its own bounds, in cell coordinates
+    for (const Capsule &capsule : handCapsules(hand)) {
+        int x1 = std::max(0, (int)((std::min(capsule.p1.x, capsule.p2.x) - capsule.radius) * cellWidth));
+        int y1 = std::max(0, (int)((std::min(capsule.p1.y, capsule.p2.y) - capsule.radius) * cellHeight));
+        int x2 = std::min(projectedSource.cols, (int)ceilf((std::max(capsule.p1.x, capsule.p2.x) + capsule.radius) * cellWidth));
+        int y2 = std::min(projectedSource.rows, (int)ceilf((std::max(capsule.p1.y, capsule.p2.y) + capsule.radius) * cellHeight));
+        if (x2 <= x1 || y2 <= y1) {
+            continue;
+        }
+        drawnRects.push_back(cv::Rect(x1, y1, x2 - x1, y2 - y1));
+        for (int y = y1; y < y2; y++) {
+            const uint8_t *source = projectedSource.ptr<uint8_t>(y) + x1 * 4;
+            uint8_t *pixel = sceneImage.ptr<uint8_t>(y) + x1 * 4;
+            for (int x = x1; x < x2; x++, source += 4, pixel += 4) {
+                cv::Point2f p = cv::Point2f((x + 0.5f) / cellWidth, (y + 0.5f) / cellHeight);
+                if (capsuleCovers(capsule, p)) {
+                    pixel[0] = skinValues[0][source[0]];
+                    pixel[1] = skinValues[1][source[1]];
+                    pixel[2] = skinValues[2][source[2]];
+                }
+            }
+        }
+    }
+}
+
+void FrameSynthesizer::blurFrame(cv::Mat &frame) {
+    int radius = frameSettings.blurRadius;
+    if (radius <= 0) {
+        return;
+    }
+    int width = frame.cols;
+    int height = frame.rows;
+    int scale = 65536 / (radius * 2 + 1);
+    blurImage.create(height, width, CV_8UC4);
+
+    // Box blur, rows into the blur image and then columns back into the frame. Rows are summed tap by tap from an
+    // edge padded copy, so each pass is a straight loop
+    int rowBytes = width * 4;
+    std::vector<uint8_t> paddedRow((width + radius * 2) * 4);
+    std::vector<int> rowSums(rowBytes);
+    uint8_t *padded = paddedRow.data();
+    int *sums = rowSums.data();
+    for (int y = 0; y < height; y++) {
+        const uint8_t *row = frame.ptr<uint8_t>(y);
+        uint8_t *output = blurImage.ptr<uint8_t>(y);
+        for (int k = 0; k < radius; k++) {
+            memcpy(padded + k * 4, row, 4);
+            memcpy(padded + (radius + width + k) * 4, row + (width - 1) * 4, 4);
+        }
+        memcpy(padded + radius * 4, row, rowBytes);
+        memset(sums, 0, rowBytes * sizeof(int));
+        for (int k = 0; k <= radius * 2; k++) {
+            const uint8_t *tap = padded + k * 4;
+            for (int i = 0; i < rowBytes; i++) {
+                sums[i] += tap[i];
+            }
+        }
+        for (int i = 0; i < rowBytes; i++) {
+            output[i] = (uint8_t)((sums[i] * scale + 32768) >> 16);
+        }
+    }
+    memset(sums, 0, rowBytes * sizeof(int));
+    for (int k = -radius; k <= radius; k++) {
+        const uint8_t *row = blurImage.ptr<uint8_t>(std::min(std::max(k, 0), height - 1));
+        for (int i = 0; i < rowBytes; i++) {
+            sums[i] += row[i];
+        }
+    }
+    for (int y = 0; y < height; y++) {
+        uint8_t *output = frame.ptr<uint8_t>(y);
+        const uint8_t *addedRow = blurImage.ptr<uint8_t>(std::min(y + radius + 1, height - 1));
+        const uint8_t *removedRow = blurImage.ptr<uint8_t>(std::max(y - radius, 0));
+        for (int i = 0; i < rowBytes; i++) {
+            output[i] = (uint8_t)((sums[i] * scale + 32768) >> 16);
+            sums[i] += addedRow[i] - removedRow[i];
+        }
+    }
+}
+
+void FrameSynthesizer::addNoise(cv::Mat &frame) {
+    if (frameSettings.noiseSigma <= 0.0f) {
+        return;
+    }
+
+    // Each row reads the table from a random pixel offset, so frames get different noise without drawing new numbers
+    std::uniform_int_distribution<int> offsets(0, FRAME_SYNTHESIZER_NOISE_TABLE_SIZE / 4 - 1);
+    int rowBytes = frame.cols * 4;
+    for (int y = 0; y < frame.rows; y++) {
+        uint8_t *pixel = frame.ptr<uint8_t>(y);
+        const int8_t *noise = &noiseTable[offsets(random) * 4];
+        for (int i = 0; i < rowBytes; i++) {
+            pixel[i] = (uint8_t)std::min(std::max(pixel[i] + noise[i], 0), 255);
+        }
+    }
+}
+
+cv::Point2f FrameSynthesizer::distortedFramePosition(cv::Point2f p) const {
+    float centerX = frameSettings.frameSize.width / 2.0f;
+    float centerY = frameSettings.frameSize.height / 2.0f;
+    float halfDiagonal = sqrtf(centerX * centerX + centerY * centerY);
+
+    cv::Point2f d = cv::Point2f((p.x - centerX) / halfDiagonal, (p.y - centerY) / halfDiagonal);
+    float r2 = d.dot(d);
+    float f = 1.0f + frameSettings.lensDistortion[0] * r2 + frameSettings.lensDistortion[1] * r2 * r2;
+    return cv::Point2f(centerX + d.x * f * halfDiagonal, centerY + d.y * f * halfDiagonal);
+}
+
+cv::Point2f FrameSynthesizer::undistortedFramePosition(cv::Point2f p) const {
+    float centerX = frameSettings.frameSize.width / 2.0f;
+    float centerY = frameSettings.frameSize.height / 2.0f;
+    float halfDiagonal = sqrtf(centerX * centerX + centerY * centerY);
+
+    // Inverts the lens model by fixed point iteration
+    cv::Point2f target = cv::Point2f((p.x - centerX) / halfDiagonal, (p.y - centerY) / halfDiagonal);
+    cv::Point2f d = target;
+    for (int i = 0; i < 10; i++) {
+        float r2 = d.dot(d);
+        d = target * (1.0f / (1.0f + frameSettings.lensDistortion[0] * r2 + frameSettings.lensDistortion[1] * r2 * r2));
+    }
+    return cv::Point2f(centerX + d.x * halfDiagonal, centerY + d.y * halfDiagonal);
+}
+
+void synthesizeFrames(const FrameSynthesizerSettings &settings, const cv::Mat &projectedImage, int frameCount, int maxBrickCount, int maxHandCount, unsigned int seed, WorkStealingPool &pool,
+                      const std::function<void(int, const cv::Mat &, const SyntheticFrameLabel &)> &frameHandler) {
+
+    // One synthesizer per batch, as building the lookup table is the expensive part
+    int batchCount = std::max(1, std::min(frameCount, pool.workerCount()));
+    for (int batch = 0; batch < batchCount; batch++) {
+        pool.submit([&, batch]() {
+            FrameSynthesizer synthesizer(settings, projectedImage, seed + batch);
+            cv::Mat frame;
+            SyntheticFrameLabel label;
+            for (int i = batch; i < frameCount; i += batchCount) {
+                synthesizer.render(synthesizer.randomScene(maxBrickCount, maxHandCount), frame, label);
+                frameHandler(i, frame, label);
+            }
+        });
+    }
+    pool.waitUntilIdle();
+}
+
+#ifdef FRAME_SYNTHESIZER_BENCHMARK_MAIN
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+// Frames of random scenes over a projected board grid, timed on one thread and on all cores
+int main(int argc, char *argv[]) {
+    int frameCount = argc > 1 ? atoi(argv[1]) : 2000;
+    cv::Size frameSize = argc > 3 ? cv::Size(atoi(argv[2]), atoi(argv[3])) : cv::Size(640, 480);
+
+    cv::Size projectedSize = cv::Size(BOARD_WIDTH * 32, BOARD_HEIGHT * 32);
+    cv::Mat projectedImage(projectedSize.height, projectedSize.width, CV_8UC4);
+    for (int y = 0; y < projectedSize.height; y++) {
+        for (int x = 0; x < projectedSize.width; x++) {
+            bool border = x < 32 || y < 32 || x >= projectedSize.width - 32 || y >= projectedSize.height - 32;
+            bool gridLine = x % 32 < 2 || y % 32 < 2;
+            uint8_t *pixel = projectedImage.ptr<uint8_t>(y) + x * 4;
+            pixel[0] = pixel[1] = pixel[2] = border ? 0 : (gridLine ? 90 : 200);
+            pixel[3] = 255;
+        }
+    }
+    FrameSynthesizerSettings settings = defaultFrameSynthesizerSettings(frameSize);
+
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    FrameSynthesizer synthesizer(settings, projectedImage, 1);
+    double setupTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    cv::Mat frame;
+    SyntheticFrameLabel label;
+    long long labeledBricks = 0;
+    long long occludedCells = 0;
+    startTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < frameCount; i++) {
+        synthesizer.render(synthesizer.randomScene(12, 2), frame, label);
+        labeledBricks += label.brickPositions.size();
+        occludedCells += label.occludedPositions.size();
+    }
+    double singleTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    WorkStealingPool pool;
+    std::atomic<long long> checksum(0);
+    startTime = std::chrono::steady_clock::now();
+    synthesizeFrames(settings, projectedImage, frameCount, 12, 2, 1, pool, [&](int index, const cv::Mat &frame, const SyntheticFrameLabel &label) {
+        checksum += frame.ptr<uint8_t>(frame.rows / 2)[frame.cols * 2] + label.brickPositions.size();
+    });
+    double poolTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::cout << "Frame " << frameSize.width << "x" << frameSize.height << ", setup " << setupTime * 1000.0 << " ms" << std::endl;
+    std::cout << "One thread: " << frameCount / singleTime << " frames/s, " << (double)labeledBricks / frameCount << " visible bricks and " << (double)occludedCells / frameCount << " occluded cells per frame" << std::endl;
+    std::cout << pool.workerCount() << " workers: " << frameCount / poolTime << " frames/s (checksum " << checksum << ")" << std::endl;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,151 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_FrameSynthesizer_h
+#define Dystopia_FrameSynthesizer_h
+
+#include <stdint.h>
+
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "GameRules.h"
+#include "WorkStealingPool.h"
+
+#define FRAME_SYNTHESIZER_NOISE_TABLE_SIZE 65536
+
+// Camera and table conditions. Projection corners are where the corners of the projected image land in the camera
+// frame before lens distortion, clockwise from top left. Colors are RGB, lens distortion is radial (k1, k2, negative
+// for barrel) in half-diagonals of the frame and the lighting gradient is the gain change from frame center to right and bottom edge
+typedef struct {
+    cv::Size frameSize;
+    cv::Point2f projectionCorners[4];
+    float lensDistortion[2];
+    float projectorGamma;
+    float projectorBrightness;
+    float ambientLight;
+    cv::Scalar tableColor;
+    cv::Scalar skinColor;
+    float lightingGradient[2];
+    float brickAlbedo;
+    float brickInset;
+    float brickFootWidth;
+    int blurRadius;
+    float noiseSigma;
+} FrameSynthesizerSettings;
+
+FrameSynthesizerSettings defaultFrameSynthesizerSettings(cv::Size frameSize);
+
+// Same conditions with the camera, lens and lighting moved about a little
+FrameSynthesizerSettings jitteredFrameSynthesizerSettings(const FrameSynthesizerSettings &settings, std::mt19937 &random);
+
+// Hand reaching in over the board, in cells. The arm leaves the palm opposite the fingers
+typedef struct {
+    cv::Point2f palm;
+    float palmRadius;
+    float angle;
+    float fingerLength;
+} HandOccluder;
+
+typedef struct {
+    std::vector<cv::Point> brickPositions;
+    std::vector<HandOccluder> hands;
+} SyntheticScene;
+
+// Ground truth of a frame. Board corners are in frame pixels after lens distortion, and bricks under a hand are
+// listed as occluded instead of as bricks
+typedef struct {
+    cv::Point2f boardCorners[4];
+    std::vector<cv::Point> brickPositions;
+    std::vector<cv::Point> occludedPositions;
+} SyntheticFrameLabel;
+
+// Renders camera frames of the projected board with bricks and hands on it, RGBA like the frames from the camera.
+//
+// Lens and perspective are baked into a lookup table when the settings change, so a frame is the projected image with
+// bricks and hands drawn on, one table lookup per pixel, blur and noise. Not thread safe, use one per thread.
+
+class FrameSynthesizer {
+public:
+    FrameSynthesizer(const FrameSynthesizerSettings &settings, const cv::Mat &projectedImage, unsigned int seed = 0);
+
+    const FrameSynthesizerSettings &settings() const;
+    void setSettings(const FrameSynthesizerSettings &settings);
+
+    // RGBA image shown by the projector, covering the board cells edge to edge
+    void setProjectedImage(const cv::Mat &projectedImage);
+
+    SyntheticScene randomScene(int maxBrickCount, int maxHandCount);
+
+    void render(const SyntheticScene &scene, cv::Mat &frame, SyntheticFrameLabel &label);
+
+    // Times the lookup table was rebuilt
+    int mapBuildCount() const;
+
+private:
+    void buildMap();
+    void buildProjection();
+    void buildNoiseTable();
+
+    void restoreScene();
+    void drawBrick(cv::Point position);
+    void drawHand(const HandOccluder &hand);
+    void blurFrame(cv::Mat &frame);
+    void addNoise(cv::Mat &frame);
+
+    cv::Point2f distortedFramePosition(cv::Point2f p) const;
+    cv::Point2f undistortedFramePosition(cv::Point2f p) const;
+
+    FrameSynthesizerSettings frameSettings;
+    std::mt19937 random;
+
+    cv::Mat projectedSource;
+    cv::Mat litProjection;
+    cv::Mat sceneImage;
+    std::vector<cv::Rect> drawnRects;
+    cv::Mat blurImage;
+
+    // Camera values of brick tops and skin under each projected value
+    uint8_t brickValues[3][256];
+    uint8_t skinValues[3][256];
+    uint8_t footValue;
+
+    std::vector<int32_t> sourceOffsets;
+    std::vector<uint16_t> gains;
+    uint8_t tablePixel[4];
+
+    std::vector<int8_t> noiseTable;
+    int builtMaps;
+};
+
+// Renders frames of random scenes on the pool, one synthesizer per task. Frame handler is called on the worker
+// threads with the index of each frame, and must not keep the frame
+void synthesizeFrames(const FrameSynthesizerSettings &settings, const cv::Mat &projectedImage, int frameCount, int maxBrickCount, int maxHandCount, unsigned int seed, WorkStealingPool &pool,
+                      const std::function<void(int, const cv::Mat &, const SyntheticFrameLabel &)> &frameHandler);
+
+#endif
@@ -58,6 +58,9 @@
 @property (nonatomic) bool active;
 @property (nonatomic, readonly) int type;
 
+// Index in the board's figure registry, or -1 if not on the board
+@property (nonatomic) int figureIndex;
+
 @end
 
 
@@ -69,8 +72,6 @@
 - (cv::vector<cv::Point>)moveablePositions;
 - (cv::vector<cv::Point>)floodFillMoveablePositions;
 
-- (bool)canMoveToLocation:(cv::Point)location withMovementCount:(int)movementCount;
-
 @property (nonatomic) int movementLength;
 
 @end
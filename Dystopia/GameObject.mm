@@ -43,11 +43,13 @@
 @synthesize visible;
 @synthesize active;
 @synthesize type;
+@synthesize figureIndex;
 
 - (id)initWithPosition:(cv::Point)p type:(int)t {
     if (self = [super init]) {
         position = p;
         type = t;
+        figureIndex = -1;
         [self initialize];
     }
     return self;
@@ -87,6 +89,32 @@
     }
 }
 
+- (void)setPosition:(cv::Point)p {
+    position = p;
+    [self figureChanged];
+}
+
+- (void)setVisible:(bool)v {
+    visible = v;
+    [self figureChanged];
+}
+
+- (void)setActive:(bool)a {
+    active = a;
+    [self figureChanged];
+}
+
+- (void)setRecognizedOnBoard:(bool)recognized {
+    recognizedOnBoard = recognized;
+    [self figureChanged];
+}
+
+- (void)figureChanged {
+    if (figureIndex != -1) {
+        [[Board instance] figureChanged:self];
+    }
+}
+
 - (CGRect)brickFrame {
     return CGRectMake(0.0f, 0.0f, self.frame.size.width, self.frame.size.height);
 }
@@ -109,18 +137,23 @@
 
 - (void)showMarker {
     [markerView show];
+    [[Board instance] projectionChangedWithAnimationDuration:GAME_OBJECT_BRICK_ANIMATION_DURATION];
 }
 
 - (void)hideMarker {
     [markerView hide];
+    [[Board instance] projectionChangedWithAnimationDuration:GAME_OBJECT_BRICK_ANIMATION_DURATION];
 }
 
+// Pulsing goes on until stopped, so only the marker appearing counts as an animation of the projection
 - (void)startMarkerPulsing {
     [markerView startPulsing];
+    [[Board instance] projectionChangedWithAnimationDuration:GAME_OBJECT_BRICK_ANIMATION_DURATION];
 }
 
 - (void)stopMarkerPulsing {
     [markerView stopPulsing];
+    [[Board instance] projectionChangedWithAnimationDuration:GAME_OBJECT_BRICK_PULSING_STOP_DURATION];
 }
 
 - (bool)isValidPosition:(cv::Point)p {
@@ -150,49 +183,7 @@
 }
 
 - (cv::vector<cv::Point>)floodFillMoveablePositions {
-    typedef struct {
-        cv::Point position;
-        int movementCount;
-    } PositionQueueElement;
-    
-    int movementBoard[BOARD_HEIGHT][BOARD_WIDTH];
-    for (int i = 0; i < BOARD_HEIGHT; i++) {
-        for (int j = 0; j < BOARD_WIDTH; j++) {
-            cv::Point p = cv::Point(j, i);
-            movementBoard[i][j] = [[Board instance] hasVisibleBrickAtPosition:p] && ![[Board instance] hasObjectAtPosition:p] ? 0 : -1;
-        }
-    }
-    movementBoard[self.position.y][self.position.x] = 0;
-    
-    cv::vector<cv::Point> positions;
-    cv::vector<PositionQueueElement> positionQueue;
-    positionQueue.push_back(PositionQueueElement {.position = self.position, .movementCount = 0});
-
-    int DIR_X[4] = {-1, 1,  0, 0};
-    int DIR_Y[4] = { 0, 0, -1, 1};
-    
-    int queueIndex = 0;
-    while (positionQueue.size() > 0 && queueIndex < positionQueue.size()) {
-        PositionQueueElement e = positionQueue[queueIndex++];
-        if (movementBoard[e.position.y][e.position.x] != 0) {
-            continue;
-        }
-        movementBoard[e.position.y][e.position.x] = 1;
-        positions.push_back(e.position);
-
-        for (int i = 0; i < 4; i++) {
-            cv::Point p = cv::Point(e.position.x + DIR_X[i], e.position.y + DIR_Y[i]);
-            if ([self isValidPosition:p] && [self canMoveToLocation:p withMovementCount:(e.movementCount + 1)]) {
-                positionQueue.push_back(PositionQueueElement {.position = p, e.movementCount + 1});
-            }
-        }
-    }
-    return positions;
-}
-
-- (bool)canMoveToLocation:(cv::Point)location withMovementCount:(int)movementCount {
-    [NSException raise:NSInternalInconsistencyException format:@"You must override %@ in a subclass", NSStringFromSelector(_cmd)];
-    return NO;
+    return [[Board instance] reachablePositionsFromPosition:self.position movementLength:self.movementLength];
 }
 
 @end
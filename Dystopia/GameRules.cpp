@@ -0,0 +1,269 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+
+#include "GameRules.h"
+
+const int HERO_MOVEMENT_LENGTH[HEROES_COUNT] = {4, 8, 8, 6, 5};
+const int MONSTER_MOVEMENT_LENGTH[MONSTERS_COUNT] = {10};
+
+const int BRICK_TYPE_SIZE[BRICK_IMAGES_COUNT][2] = {{3, 3}, {3, 3}, {3, 3}, {3, 3}, {3, 2}, {3, 1}, {2, 1}, {1, 1}, {1, 3}, {2, 2}, {1, 1}};
+
+const int DIR_X[4] = {-1, 1,  0, 0};
+const int DIR_Y[4] = { 0, 0, -1, 1};
+
+cv::Size brickTypeBoardSize(int type) {
+    return cv::Size(BRICK_TYPE_SIZE[type][0], BRICK_TYPE_SIZE[type][1]);
+}
+
+GameState::GameState(const LevelDefinition &level, int heroCount) {
+    memset(brickIndexMap, -1, sizeof(brickIndexMap));
+    for (int k = 0; k < level.bricks.size(); k++) {
+        BrickState brick = {.type = level.bricks[k].type, .position = level.bricks[k].position, .size = brickTypeBoardSize(level.bricks[k].type), .visible = false};
+        bricks.push_back(brick);
+        for (int i = std::max(brick.position.y, 0); i < std::min(brick.position.y + brick.size.height, BOARD_HEIGHT); i++) {
+            for (int j = std::max(brick.position.x, 0); j < std::min(brick.position.x + brick.size.width, BOARD_WIDTH); j++) {
+                if (brickIndexMap[i][j] == -1) {
+                    brickIndexMap[i][j] = k;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < level.connections.size(); i++) {
+        const LevelConnection &c = level.connections[i];
+        ConnectionState connection = {.type = c.type, .position1 = c.position1, .position2 = c.position2, .brick1 = brickIndexAtPosition(c.position1), .brick2 = brickIndexAtPosition(c.position2), .open = false};
+        connections.push_back(connection);
+    }
+
+    // Heroes not placed on the board are left out, as after the initial players turn
+    for (int i = 0; i < std::min(heroCount, (int)level.heroes.size()); i++) {
+        FigureState hero = {.type = level.heroes[i].type, .position = level.heroes[i].position, .movementLength = HERO_MOVEMENT_LENGTH[level.heroes[i].type], .active = true, .visible = true};
+        heroes.push_back(hero);
+    }
+    for (int i = 0; i < level.monsters.size(); i++) {
+        FigureState monster = {.type = level.monsters[i].type, .position = level.monsters[i].position, .movementLength = MONSTER_MOVEMENT_LENGTH[level.monsters[i].type], .active = false, .visible = false};
+        monsters.push_back(monster);
+    }
+    positionQueue.reserve(BOARD_WIDTH * BOARD_HEIGHT * 4);
+
+    refreshObjectMap();
+    if (bricks.size() > 0) {
+        makeBrickVisible(0);
+    }
+    refreshBrickMap();
+}
+
+void GameState::refreshBrickMap() {
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            brickMap[i][j] = -1;
+            brickVisibilityMap[i][j] = false;
+        }
+    }
+    for (int k = 0; k < bricks.size(); k++) {
+        const BrickState &brick = bricks[k];
+
+        // Bricks of a level that has not been through the level compiler may reach over the board edge
+        for (int i = std::max(brick.position.y, 0); i < std::min(brick.position.y + brick.size.height, BOARD_HEIGHT); i++) {
+            for (int j = std::max(brick.position.x, 0); j < std::min(brick.position.x + brick.size.width, BOARD_WIDTH); j++) {
+                brickMap[i][j] = brick.type;
+                brickVisibilityMap[i][j] = brick.visible;
+            }
+        }
+    }
+}
+
+void GameState::refreshObjectMap() {
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            objectMap[i][j] = false;
+        }
+    }
+    for (int i = 0; i < heroes.size(); i++) {
+        objectMap[heroes[i].position.y][heroes[i].position.x] = true;
+    }
+    for (int i = 0; i < monsters.size(); i++) {
+        objectMap[monsters[i].position.y][monsters[i].position.x] = true;
+    }
+}
+
+bool GameState::isValidPosition(cv::Point p) const {
+    return p.x >= 0 && p.y >= 0 && p.x < BOARD_WIDTH && p.y < BOARD_HEIGHT;
+}
+
+bool GameState::hasBrickAtPosition(cv::Point position) const {
+    return isValidPosition(position) && brickMap[position.y][position.x] != -1;
+}
+
+bool GameState::hasVisibleBrickAtPosition(cv::Point position) const {
+    return isValidPosition(position) && brickVisibilityMap[position.y][position.x];
+}
+
+bool GameState::hasObjectAtPosition(cv::Point position) const {
+    return isValidPosition(position) && objectMap[position.y][position.x];
+}
+
+int GameState::brickTypeAtPosition(cv::Point position) const {
+    return isValidPosition(position) ? brickMap[position.y][position.x] : -1;
+}
+
+void GameState::floodFillMoveablePositions(const FigureState &figure, std::vector<cv::Point> &positions) const {
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            movementBoard[i][j] = brickVisibilityMap[i][j] && !objectMap[i][j] ? 0 : -1;
+        }
+    }
+    movementBoard[figure.position.y][figure.position.x] = 0;
+
+    positions.clear();
+    positionQueue.clear();
+    positionQueue.push_back(cv::Point3i(figure.position.x, figure.position.y, 0));
+
+    int queueIndex = 0;
+    while (queueIndex < positionQueue.size()) {
+        cv::Point3i e = positionQueue[queueIndex++];
+        if (movementBoard[e.y][e.x] != 0) {
+            continue;
+        }
+        movementBoard[e.y][e.x] = 1;
+        positions.push_back(cv::Point(e.x, e.y));
+
+        if (e.z + 1 > figure.movementLength) {
+            continue;
+        }
+        for (int i = 0; i < 4; i++) {
+            cv::Point p = cv::Point(e.x + DIR_X[i], e.y + DIR_Y[i]);
+            if (isValidPosition(p) && movementBoard[p.y][p.x] == 0) {
+                positionQueue.push_back(cv::Point3i(p.x, p.y, e.z + 1));
+            }
+        }
+    }
+}
+
+bool GameState::canOpen(const ConnectionState &connection) const {
+    return !connection.open && connection.type != CONNECTION_TYPE_VIEW_GLUE;
+}
+
+bool GameState::shouldOpenDoorAtPosition(cv::Point position) const {
+    for (int i = 0; i < connections.size(); i++) {
+        if (canOpen(connections[i]) && (connections[i].position1 == position || connections[i].position2 == position)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int GameState::openDoorAtPosition(cv::Point position) {
+    int activatedCount = 0;
+    for (int i = 0; i < connections.size(); i++) {
+        ConnectionState &connection = connections[i];
+        if (canOpen(connection) && (connection.position1 == position || connection.position2 == position)) {
+            activatedCount += makeBrickVisible(connection.brick1);
+            activatedCount += makeBrickVisible(connection.brick2);
+            connection.open = true;
+        }
+    }
+    refreshBrickMap();
+    return activatedCount;
+}
+
+bool GameState::allDoorsOpen() const {
+    for (int i = 0; i < connections.size(); i++) {
+        if (canOpen(connections[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int GameState::brickIndexAtPosition(cv::Point p) const {
+    return isValidPosition(p) ? brickIndexMap[p.y][p.x] : -1;
+}
+
+int GameState::makeBrickVisible(int brickIndex) {
+    if (brickIndex == -1 || bricks[brickIndex].visible) {
+        return 0;
+    }
+
+    // Reveal the room and wake up its monsters
+    int activatedCount = 0;
+    std::vector<int> connectedBricks;
+    addConnectedBricks(brickIndex, connectedBricks);
+    for (int i = 0; i < connectedBricks.size(); i++) {
+        bricks[connectedBricks[i]].visible = true;
+        for (int j = 0; j < monsters.size(); j++) {
+            if (brickIndexAtPosition(monsters[j].position) == connectedBricks[i]) {
+                activatedCount += monsters[j].active ? 0 : 1;
+                monsters[j].active = true;
+                monsters[j].visible = true;
+            }
+        }
+    }
+
+    // Monsters behind closed doors of the room can be seen through them
+    for (int i = 0; i < connections.size(); i++) {
+        const ConnectionState &connection = connections[i];
+        if (connection.type == CONNECTION_TYPE_VIEW_GLUE) {
+            continue;
+        }
+        if (std::find(connectedBricks.begin(), connectedBricks.end(), connection.brick1) == connectedBricks.end() &&
+            std::find(connectedBricks.begin(), connectedBricks.end(), connection.brick2) == connectedBricks.end()) {
+            continue;
+        }
+        int sides[2] = {connection.brick1, connection.brick2};
+        for (int k = 0; k < 2; k++) {
+            if (sides[k] == -1 || std::find(connectedBricks.begin(), connectedBricks.end(), sides[k]) != connectedBricks.end()) {
+                continue;
+            }
+            std::vector<int> closedBricks;
+            addConnectedBricks(sides[k], closedBricks);
+            for (int j = 0; j < closedBricks.size(); j++) {
+                for (int m = 0; m < monsters.size(); m++) {
+                    if (!monsters[m].visible && brickIndexAtPosition(monsters[m].position) == closedBricks[j]) {
+                        monsters[m].visible = true;
+                    }
+                }
+            }
+        }
+    }
+    return activatedCount;
+}
+
+void GameState::addConnectedBricks(int brickIndex, std::vector<int> &connectedBricks) const {
+    connectedBricks.push_back(brickIndex);
+    for (int i = 0; i < connections.size(); i++) {
+        const ConnectionState &connection = connections[i];
+        if (connection.type != CONNECTION_TYPE_VIEW_GLUE || (connection.brick1 != brickIndex && connection.brick2 != brickIndex)) {
+            continue;
+        }
+        if (connection.brick1 != -1 && std::find(connectedBricks.begin(), connectedBricks.end(), connection.brick1) == connectedBricks.end()) {
+            addConnectedBricks(connection.brick1, connectedBricks);
+        }
+        if (connection.brick2 != -1 && std::find(connectedBricks.begin(), connectedBricks.end(), connection.brick2) == connectedBricks.end()) {
+            addConnectedBricks(connection.brick2, connectedBricks);
+        }
+    }
+}
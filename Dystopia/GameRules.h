@@ -0,0 +1,164 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_GameRules_h
+#define Dystopia_GameRules_h
+
+#include <algorithm>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#define BOARD_WIDTH 30
+#define BOARD_HEIGHT 20
+
+#define BRICK_IMAGES_COUNT 11
+
+#define BRICK_TYPE_EXIT 9
+#define BRICK_TYPE_TRAP 10
+
+#define HEROES_COUNT 5
+
+#define HERO_DWERF   0
+#define HERO_ARCHOR  1
+#define HERO_ELF     2
+#define HERO_WARRIOR 3
+#define HERO_WIZARD  4
+
+#define MONSTERS_COUNT 1
+
+#define MONSTER_GLOBNIC 0
+
+// Heroes and monsters on a board together
+#define MAX_FIGURES 64
+
+#define CONNECTION_TYPE_VIEW_GLUE 0
+#define CONNECTION_TYPE_DOOR      1
+#define CONNECTION_TYPE_HALLWAY   2
+
+extern const int HERO_MOVEMENT_LENGTH[HEROES_COUNT];
+extern const int MONSTER_MOVEMENT_LENGTH[MONSTERS_COUNT];
+
+// Size of a brick type in board cells
+cv::Size brickTypeBoardSize(int type);
+
+typedef struct {
+    int type;
+    cv::Point position;
+} LevelBrick;
+
+typedef struct {
+    int type;
+    cv::Point position1;
+    cv::Point position2;
+} LevelConnection;
+
+typedef struct {
+    int type;
+    cv::Point position;
+} LevelFigure;
+
+// The first brick is visible when the level starts
+typedef struct {
+    std::vector<LevelBrick> bricks;
+    std::vector<LevelConnection> connections;
+    std::vector<LevelFigure> heroes;
+    std::vector<LevelFigure> monsters;
+} LevelDefinition;
+
+typedef struct {
+    int type;
+    cv::Point position;
+    int movementLength;
+    bool active;
+    bool visible;
+} FigureState;
+
+// UI free board state and rules, mirroring Board, ConnectorsView and MoveableGameObject.
+//
+// Used by the headless game simulation, so kept free of allocations on the hot paths.
+
+class GameState {
+public:
+    explicit GameState(const LevelDefinition &level, int heroCount = HEROES_COUNT);
+
+    void refreshBrickMap();
+    void refreshObjectMap();
+
+    bool hasBrickAtPosition(cv::Point position) const;
+    bool hasVisibleBrickAtPosition(cv::Point position) const;
+    bool hasObjectAtPosition(cv::Point position) const;
+    int brickTypeAtPosition(cv::Point position) const;
+
+    // Cells the figure can reach with its movement length, its own position included
+    void floodFillMoveablePositions(const FigureState &figure, std::vector<cv::Point> &positions) const;
+
+    bool shouldOpenDoorAtPosition(cv::Point position) const;
+
+    // Returns number of monsters activated by the rooms behind the door
+    int openDoorAtPosition(cv::Point position);
+
+    bool allDoorsOpen() const;
+
+    std::vector<FigureState> heroes;
+    std::vector<FigureState> monsters;
+
+private:
+    struct BrickState {
+        int type;
+        cv::Point position;
+        cv::Size size;
+        bool visible;
+    };
+
+    struct ConnectionState {
+        int type;
+        cv::Point position1;
+        cv::Point position2;
+        int brick1;
+        int brick2;
+        bool open;
+    };
+
+    bool isValidPosition(cv::Point p) const;
+    bool canOpen(const ConnectionState &connection) const;
+    int brickIndexAtPosition(cv::Point p) const;
+
+    int makeBrickVisible(int brickIndex);
+    void addConnectedBricks(int brickIndex, std::vector<int> &connectedBricks) const;
+
+    std::vector<BrickState> bricks;
+    std::vector<ConnectionState> connections;
+
+    int brickMap[BOARD_HEIGHT][BOARD_WIDTH];
+    int brickIndexMap[BOARD_HEIGHT][BOARD_WIDTH];
+    bool brickVisibilityMap[BOARD_HEIGHT][BOARD_WIDTH];
+    bool objectMap[BOARD_HEIGHT][BOARD_WIDTH];
+
+    mutable int movementBoard[BOARD_HEIGHT][BOARD_WIDTH];
+    mutable std::vector<cv::Point3i> positionQueue;
+};
+
+#endif
@@ -0,0 +1,51 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import <Foundation/Foundation.h>
+
+typedef void (^GameSchedulerBlock)();
+
+@interface GameScheduler : NSObject
+
++ (GameScheduler *)instance;
+
+// Main thread only
+- (void)performBlock:(GameSchedulerBlock)block afterDelay:(double)delay;
+
+// Replaces wall clock time with a clock that only moves by runUntilIdle. Blocks already scheduled keep their
+// remaining delay on the virtual clock
+- (void)useVirtualClock;
+
+// Runs all scheduled blocks, jumping over the delays when on a virtual clock. Returns number of blocks run
+- (int)runUntilIdle;
+
+// As runUntilIdle, but stops after maxBlocks blocks. Repeating blocks, like the pulsing of bricks, never leave the
+// scheduler idle
+- (int)runUntilIdleWithMaxBlocks:(int)maxBlocks;
+
+@property (nonatomic, readonly) double now;
+@property (nonatomic, readonly) bool virtualClock;
+
+@end
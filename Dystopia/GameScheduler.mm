@@ -0,0 +1,107 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "GameScheduler.h"
+#import "Scheduler.h"
+
+@interface GameScheduler () {
+    RealTimeClock realTimeClock;
+    VirtualClock simulatedClock;
+    Scheduler *scheduler;
+}
+
+@end
+
+GameScheduler *gameSchedulerInstance = nil;
+
+@implementation GameScheduler
+
+@synthesize virtualClock;
+
++ (GameScheduler *)instance {
+    @synchronized(self) {
+        if (gameSchedulerInstance == nil) {
+            gameSchedulerInstance = [[GameScheduler alloc] init];
+        }
+        return gameSchedulerInstance;
+    }
+}
+
+- (id)init {
+    if (self = [super init]) {
+        scheduler = new Scheduler(realTimeClock);
+        virtualClock = NO;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    delete scheduler;
+}
+
+- (void)useVirtualClock {
+    if (virtualClock) {
+        return;
+    }
+    Scheduler *virtualScheduler = new Scheduler(simulatedClock);
+    scheduler->moveTasksTo(*virtualScheduler);
+    delete scheduler;
+    scheduler = virtualScheduler;
+    virtualClock = YES;
+}
+
+- (void)performBlock:(GameSchedulerBlock)block afterDelay:(double)delay {
+    GameSchedulerBlock task = [block copy];
+    scheduler->schedule(delay, [task]() {
+        task();
+    });
+    if (virtualClock) {
+        return;
+    }
+
+    // Wake up when the block is due; blocks that are due at the same time are run by the first wake-up
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MAX(delay, 0.0) * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+
+        // The block has been moved to the virtual clock in the meantime and is run by runUntilIdle
+        if (virtualClock) {
+            return;
+        }
+        scheduler->runDueTasks();
+    });
+}
+
+- (int)runUntilIdle {
+    return scheduler->runUntilIdle();
+}
+
+- (int)runUntilIdleWithMaxBlocks:(int)maxBlocks {
+    return scheduler->runUntilIdle(maxBlocks);
+}
+
+- (double)now {
+    return scheduler->clock().now();
+}
+
+@end
@@ -0,0 +1,252 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <chrono>
+#include <mutex>
+
+#include "GameSimulation.h"
+
+RandomMovePolicy::RandomMovePolicy(float doorSeekingProbability) : doorSeekingProbability(doorSeekingProbability) {
+}
+
+cv::Point RandomMovePolicy::chooseMove(const GameState &state, const FigureState &figure, const std::vector<cv::Point> &reachablePositions, std::mt19937 &random) {
+    if (reachablePositions.size() == 0) {
+        return figure.position;
+    }
+    if (doorSeekingProbability > 0.0f && std::uniform_real_distribution<float>(0.0f, 1.0f)(random) < doorSeekingProbability) {
+        doorPositions.clear();
+        for (int i = 0; i < reachablePositions.size(); i++) {
+            if (state.shouldOpenDoorAtPosition(reachablePositions[i])) {
+                doorPositions.push_back(reachablePositions[i]);
+            }
+        }
+        if (doorPositions.size() > 0) {
+            return doorPositions[std::uniform_int_distribution<int>(0, (int)doorPositions.size() - 1)(random)];
+        }
+    }
+    return reachablePositions[std::uniform_int_distribution<int>(0, (int)reachablePositions.size() - 1)(random)];
+}
+
+ScriptedMovePolicy::ScriptedMovePolicy(const std::vector<cv::Point> &moves) : moves(moves), nextMove(0) {
+}
+
+cv::Point ScriptedMovePolicy::chooseMove(const GameState &, const FigureState &figure, const std::vector<cv::Point> &reachablePositions, std::mt19937 &) {
+    if (nextMove >= moves.size()) {
+        return figure.position;
+    }
+    cv::Point move = moves[nextMove++];
+    return std::find(reachablePositions.begin(), reachablePositions.end(), move) != reachablePositions.end() ? move : figure.position;
+}
+
+SimulationSettings defaultSimulationSettings() {
+    SimulationSettings settings = {.heroCount = HEROES_COUNT, .maxRounds = GAME_SIMULATION_DEFAULT_MAX_ROUNDS, .heroDoorSeekingProbability = 0.5f, .monsterDoorSeekingProbability = 0.0f};
+    return settings;
+}
+
+GameSimulation::GameSimulation(const LevelDefinition &level, const SimulationSettings &settings, unsigned int seed) : state(level, settings.heroCount), settings(settings), random(seed) {
+    result.won = false;
+    result.rounds = 0;
+    result.heroMoves = 0;
+    result.monsterMoves = 0;
+    result.doorsOpened = 0;
+    result.monstersActivated = 0;
+    reachablePositions.reserve(BOARD_WIDTH * BOARD_HEIGHT);
+}
+
+SimulationResult GameSimulation::run(MovePolicy &heroPolicy, MovePolicy &monsterPolicy) {
+    playersTurnInitial(heroPolicy);
+    result.rounds = 1;
+    while (!isWon() && result.rounds < settings.maxRounds) {
+        monstersTurn(monsterPolicy);
+        playersTurn(heroPolicy);
+        result.rounds++;
+    }
+    result.won = isWon();
+    return result;
+}
+
+void GameSimulation::playersTurnInitial(MovePolicy &policy) {
+    for (int i = 0; i < state.heroes.size(); i++) {
+        FigureState &hero = state.heroes[i];
+        state.floodFillMoveablePositions(hero, reachablePositions);
+        cv::Point position = policy.chooseMove(state, hero, reachablePositions, random);
+        if (position != hero.position) {
+            hero.position = position;
+            result.heroMoves++;
+            state.refreshObjectMap();
+        }
+        openDoorAtPosition(hero.position);
+    }
+}
+
+void GameSimulation::playersTurn(MovePolicy &policy) {
+
+    // Reachable sets are taken with all heroes in place, as in a simultaneous turn of BoardGame
+    simultaneousMoves.clear();
+    for (int i = 0; i < state.heroes.size(); i++) {
+        FigureState &hero = state.heroes[i];
+        state.floodFillMoveablePositions(hero, reachablePositions);
+        for (int j = 0; j < simultaneousMoves.size(); j++) {
+            reachablePositions.erase(std::remove(reachablePositions.begin(), reachablePositions.end(), simultaneousMoves[j]), reachablePositions.end());
+        }
+        simultaneousMoves.push_back(policy.chooseMove(state, hero, reachablePositions, random));
+    }
+    for (int i = 0; i < state.heroes.size(); i++) {
+        if (simultaneousMoves[i] != state.heroes[i].position) {
+            state.heroes[i].position = simultaneousMoves[i];
+            result.heroMoves++;
+        }
+    }
+    state.refreshObjectMap();
+    for (int i = 0; i < state.heroes.size(); i++) {
+        openDoorAtPosition(state.heroes[i].position);
+    }
+}
+
+void GameSimulation::monstersTurn(MovePolicy &policy) {
+    for (int i = 0; i < state.monsters.size(); i++) {
+        FigureState &monster = state.monsters[i];
+        if (!monster.active) {
+            continue;
+        }
+        state.floodFillMoveablePositions(monster, reachablePositions);
+        cv::Point position = policy.chooseMove(state, monster, reachablePositions, random);
+        if (position != monster.position) {
+            monster.position = position;
+            result.monsterMoves++;
+            state.refreshObjectMap();
+        }
+    }
+}
+
+void GameSimulation::openDoorAtPosition(cv::Point position) {
+    if (!state.shouldOpenDoorAtPosition(position)) {
+        return;
+    }
+    result.monstersActivated += state.openDoorAtPosition(position);
+    result.doorsOpened++;
+}
+
+bool GameSimulation::isWon() const {
+    for (int i = 0; i < state.heroes.size(); i++) {
+        if (state.brickTypeAtPosition(state.heroes[i].position) == BRICK_TYPE_EXIT) {
+            return true;
+        }
+    }
+    return state.allDoorsOpen();
+}
+
+SimulationStatistics simulateGames(const LevelDefinition &level, const SimulationSettings &settings, int gameCount, unsigned int seed, WorkStealingPool &pool) {
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+    // Games are played in batches to keep per task overhead low, with the results merged once per batch
+    int batchCount = std::max(1, std::min(gameCount, pool.workerCount() * 8));
+    std::vector<SimulationStatistics> batchStatistics(batchCount);
+    for (int batch = 0; batch < batchCount; batch++) {
+        pool.submit([&, batch]() {
+            SimulationStatistics &statistics = batchStatistics[batch];
+            statistics.games = 0;
+            statistics.wins = 0;
+            statistics.meanRounds = 0.0f;
+            statistics.minRounds = settings.maxRounds;
+            statistics.maxRounds = 0;
+            statistics.meanDoorsOpened = 0.0f;
+            statistics.meanMonstersActivated = 0.0f;
+
+            RandomMovePolicy heroPolicy(settings.heroDoorSeekingProbability);
+            RandomMovePolicy monsterPolicy(settings.monsterDoorSeekingProbability);
+            for (int game = batch; game < gameCount; game += batchCount) {
+                GameSimulation simulation(level, settings, seed + game);
+                SimulationResult result = simulation.run(heroPolicy, monsterPolicy);
+                statistics.games++;
+                statistics.wins += result.won ? 1 : 0;
+                statistics.meanRounds += result.rounds;
+                statistics.minRounds = std::min(statistics.minRounds, result.rounds);
+                statistics.maxRounds = std::max(statistics.maxRounds, result.rounds);
+                statistics.meanDoorsOpened += result.doorsOpened;
+                statistics.meanMonstersActivated += result.monstersActivated;
+            }
+        });
+    }
+    pool.waitUntilIdle();
+
+    SimulationStatistics statistics = {.games = 0, .wins = 0, .winRate = 0.0f, .meanRounds = 0.0f, .minRounds = settings.maxRounds, .maxRounds = 0, .meanDoorsOpened = 0.0f, .meanMonstersActivated = 0.0f, .gamesPerSecond = 0.0};
+    for (int i = 0; i < batchCount; i++) {
+        statistics.games += batchStatistics[i].games;
+        statistics.wins += batchStatistics[i].wins;
+        statistics.meanRounds += batchStatistics[i].meanRounds;
+        statistics.minRounds = std::min(statistics.minRounds, batchStatistics[i].minRounds);
+        statistics.maxRounds = std::max(statistics.maxRounds, batchStatistics[i].maxRounds);
+        statistics.meanDoorsOpened += batchStatistics[i].meanDoorsOpened;
+        statistics.meanMonstersActivated += batchStatistics[i].meanMonstersActivated;
+    }
+    float games = std::max(1, statistics.games);
+    statistics.winRate = statistics.wins / games;
+    statistics.meanRounds /= games;
+    statistics.meanDoorsOpened /= games;
+    statistics.meanMonstersActivated /= games;
+    statistics.gamesPerSecond = statistics.games / std::max(1e-9, std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
+    return statistics;
+}
+
+#ifdef GAME_SIMULATION_MAIN
+
+#include <cstdlib>
+#include <iostream>
+
+#include "LevelImage.h"
+
+// Random games of a compiled level, spread over all cores
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <level image> [games] [seed] [heroes]" << std::endl;
+        return 1;
+    }
+    int gameCount = argc > 2 ? atoi(argv[2]) : 10000;
+    unsigned int seed = argc > 3 ? (unsigned int)atoi(argv[3]) : 1;
+    SimulationSettings settings = defaultSimulationSettings();
+    if (argc > 4) {
+        settings.heroCount = atoi(argv[4]);
+    }
+
+    LevelImage levelImage;
+    std::string error;
+    if (!levelImage.open(argv[1], error)) {
+        std::cerr << argv[1] << ": " << error << std::endl;
+        return 1;
+    }
+    WorkStealingPool pool;
+    SimulationStatistics statistics = simulateGames(levelImage.definition(), settings, gameCount, seed, pool);
+
+    std::cout << statistics.games << " games with " << settings.heroCount << " heroes on " << pool.workerCount() << " workers, "
+              << statistics.gamesPerSecond << " games per second" << std::endl;
+    std::cout << "Win rate " << statistics.winRate * 100.0f << "% (" << statistics.wins << " of " << statistics.games
+              << ", round limit " << settings.maxRounds << ")" << std::endl;
+    std::cout << "Rounds mean " << statistics.meanRounds << ", min " << statistics.minRounds << ", max " << statistics.maxRounds << std::endl;
+    std::cout << "Doors opened mean " << statistics.meanDoorsOpened << ", monsters activated mean " << statistics.meanMonstersActivated << std::endl;
+    return 0;
+}
+
+#endif
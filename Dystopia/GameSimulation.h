@@ -0,0 +1,135 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_GameSimulation_h
+#define Dystopia_GameSimulation_h
+
+#include <random>
+#include <vector>
+
+#include "GameRules.h"
+#include "WorkStealingPool.h"
+
+#define GAME_SIMULATION_DEFAULT_MAX_ROUNDS 100
+
+// Chooses where a figure moves to among the cells it can reach
+class MovePolicy {
+public:
+    virtual ~MovePolicy() {}
+
+    virtual cv::Point chooseMove(const GameState &state, const FigureState &figure, const std::vector<cv::Point> &reachablePositions, std::mt19937 &random) = 0;
+};
+
+// Uniformly random moves, heading for a closed door with the given probability when one is in reach
+class RandomMovePolicy : public MovePolicy {
+public:
+    explicit RandomMovePolicy(float doorSeekingProbability = 0.0f);
+
+    cv::Point chooseMove(const GameState &state, const FigureState &figure, const std::vector<cv::Point> &reachablePositions, std::mt19937 &random);
+
+private:
+    float doorSeekingProbability;
+    std::vector<cv::Point> doorPositions;
+};
+
+// Plays back a fixed list of moves, staying in place if a move is not reachable or the list has run out
+class ScriptedMovePolicy : public MovePolicy {
+public:
+    explicit ScriptedMovePolicy(const std::vector<cv::Point> &moves);
+
+    cv::Point chooseMove(const GameState &state, const FigureState &figure, const std::vector<cv::Point> &reachablePositions, std::mt19937 &random);
+
+private:
+    std::vector<cv::Point> moves;
+    int nextMove;
+};
+
+typedef struct {
+    int heroCount;
+    int maxRounds;
+    float heroDoorSeekingProbability;
+    float monsterDoorSeekingProbability;
+} SimulationSettings;
+
+SimulationSettings defaultSimulationSettings();
+
+typedef struct {
+
+    // The heroes have opened every door of the level or reached the exit within the round limit
+    bool won;
+
+    int rounds;
+    int heroMoves;
+    int monsterMoves;
+    int doorsOpened;
+    int monstersActivated;
+} SimulationResult;
+
+typedef struct {
+    int games;
+    int wins;
+    float winRate;
+    float meanRounds;
+    int minRounds;
+    int maxRounds;
+    float meanDoorsOpened;
+    float meanMonstersActivated;
+    double gamesPerSecond;
+} SimulationStatistics;
+
+// One game with the turn order of BoardGame: an initial players turn with heroes moving one at a time, then monsters
+// and players taking turns, all heroes moving at the same time. Timing is left out, as it has no effect on the rules
+
+class GameSimulation {
+public:
+    GameSimulation(const LevelDefinition &level, const SimulationSettings &settings, unsigned int seed);
+
+    SimulationResult run(MovePolicy &heroPolicy, MovePolicy &monsterPolicy);
+
+private:
+    void playersTurnInitial(MovePolicy &policy);
+    void playersTurn(MovePolicy &policy);
+    void monstersTurn(MovePolicy &policy);
+
+    void openDoorAtPosition(cv::Point position);
+    bool isWon() const;
+
+    GameState state;
+    SimulationSettings settings;
+    SimulationResult result;
+    std::mt19937 random;
+
+    std::vector<cv::Point> reachablePositions;
+    std::vector<cv::Point> simultaneousMoves;
+};
+
+// Plays the given number of random games spread over the pool; game i is seeded with seed + i, so results do not
+// depend on the number of workers. Estimate the balance of a shipped level with
+//
+//   c++ -std=c++11 -O2 -DGAME_SIMULATION_MAIN GameSimulation.cpp GameRules.cpp LevelImage.cpp WorkStealingPool.cpp -lopencv_core -lpthread -o gamesim
+//   gamesim Levels/level1.level 10000
+SimulationStatistics simulateGames(const LevelDefinition &level, const SimulationSettings &settings, int gameCount, unsigned int seed, WorkStealingPool &pool);
+
+#endif
@@ -30,6 +30,7 @@
 #import "FakeCameraUtil.h"
 #import "ExternalDislayCalibrationBorderView.h"
 #import "BrickRecognizer.h"
+#import "FramePreprocessor.h"
 
 @interface GameViewController () {
     ExternalDislayCalibrationBorderView *externalDislayCalibrationBorderView;
@@ -113,30 +114,37 @@
 
 - (void)processFrame:(UIImage *)image {
     @autoreleasepool {
+        unsigned long long frameSequenceNumber = 0;
         if (gameState >= GAME_STATE_GAME) {
-            cv::Mat grayscaledImage = [self grayscaledImage:image];
-            [self calibrateBoard:grayscaledImage];
+            [self calibrateBoardFromFrame:image];
+            frameSequenceNumber = [BoardCalibrator instance].frameSequenceNumber;
         }
-        [self updateGameStateAccordingToFrame];
+        [self updateGameStateAccordingToFrame:frameSequenceNumber];
         [self previewFrame:image];
         //NSArray *images = [[BoardRecognizer instance] boardBoundsToImages:image];
         //[self previewFrame:[images objectAtIndex:5]];
     }
 }
 
-- (void)updateGameStateAccordingToFrame {
+- (void)updateGameStateAccordingToFrame:(unsigned long long)frameSequenceNumber {
     dispatch_async(dispatch_get_main_queue(), ^{
         [self setFrameUpdateIntervalAccordingToGameState];
+        if (frameSequenceNumber > 0) {
+            [[BoardGame instance] frameProcessed:frameSequenceNumber];
+        }
         [CameraSession instance].readyToProcessFrame = YES;
     });
 }
 
-- (cv::Mat)grayscaledImage:(UIImage *)image {
+- (void)calibrateBoardFromFrame:(UIImage *)image {
     cv::Mat img = [image CVMat];
-    
-    cv::Mat outputImage;
-    cv::cvtColor(img, outputImage, CV_RGB2GRAY);
-    return outputImage;
+
+    // Grayscale, blur and intensity range in one pass
+    cv::Mat grayscaledImage;
+    cv::Mat blurredImage;
+    IntensityRange intensityRange = preprocessFrame(img, grayscaledImage, blurredImage);
+
+    [[BoardCalibrator instance] updateBoundsWithImage:grayscaledImage blurredImage:blurredImage intensityRange:intensityRange];
 }
 
 - (void)setFrameUpdateIntervalAccordingToGameState {
@@ -176,10 +184,6 @@
     NSLog(@"Board game finished!");
 }
 
-- (void)calibrateBoard:(cv::Mat)image {
-    [[BoardCalibrator instance] updateBoundsWithImage:image];
-}
-
 - (UIImage *)requestSimulatedImageIfNoCamera {
     //UIImage *image = [[FakeCameraUtil instance] fakeOutputImage];
     UIImage *image;
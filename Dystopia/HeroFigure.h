@@ -26,14 +26,7 @@
 #import <Foundation/Foundation.h>
 
 #import "GameObject.h"
-
-#define HEROES_COUNT 5
-
-#define HERO_DWERF   0
-#define HERO_ARCHOR  1
-#define HERO_ELF     2
-#define HERO_WARRIOR 3
-#define HERO_WIZARD  4
+#import "GameRules.h"
 
 @interface HeroFigure : MoveableGameObject
 
@@ -25,7 +25,6 @@
 
 #import "HeroFigure.h"
 
-const int HERO_MOVEMENT_LENGTH[HEROES_COUNT] = {4, 8, 8, 6, 5};
 const NSArray *HERO_MARKER_IMAGE = [NSArray arrayWithObjects:@"marker_dwerf.png", @"marker_archor.png", @"marker_elf.png", @"marker_warrior.png", @"marker_wizard.png", nil];
 
 @interface HeroFigure () {
@@ -49,8 +48,4 @@ const NSArray *HERO_MARKER_IMAGE = [NSArray arrayWithObjects:@"marker_dwerf.png"
     self.active = NO;
 }
 
-- (bool)canMoveToLocation:(cv::Point)location withMovementCount:(int)movementCount {
-    return movementCount <= self.movementLength;
-}
-
 @end
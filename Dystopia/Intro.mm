@@ -27,6 +27,7 @@
 
 #import "Intro.h"
 #import "ExternalDisplay.h"
+#import "GameScheduler.h"
 
 #define INTRO_TROLLS_AHEAD_FADE_IN_DURATION 3.0f
 #define INTRO_TROLLS_AHEAD_FADE_OUT_DURATION 3.0f
@@ -93,7 +94,9 @@
         [UIView animateWithDuration:INTRO_TROLLS_AHEAD_FADE_IN_DURATION animations:^{
             logoView.layer.opacity = 1.0f;
         } completion:^(BOOL finished) {
-            [NSTimer scheduledTimerWithTimeInterval:INTRO_TROLLS_AHEAD_PRESENT_DURATION target:self selector:@selector(hideTrollsAhead) userInfo:nil repeats:NO];
+            [[GameScheduler instance] performBlock:^{
+                [self hideTrollsAhead];
+            } afterDelay:INTRO_TROLLS_AHEAD_PRESENT_DURATION];
         }];
     });
 }
@@ -114,7 +117,9 @@
             dystopiaView.layer.opacity = 1.0f;
             dystopiaView.transform = CGAffineTransformMakeScale(0.4f, 0.4f);
         } completion:^(BOOL finished) {
-            [NSTimer scheduledTimerWithTimeInterval:INTRO_DYSTOPIA_PRESENT_DURATION target:self selector:@selector(hideDystopia) userInfo:nil repeats:NO];
+            [[GameScheduler instance] performBlock:^{
+                [self hideDystopia];
+            } afterDelay:INTRO_DYSTOPIA_PRESENT_DURATION];
         }];
     });
 }
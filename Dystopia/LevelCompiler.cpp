@@ -0,0 +1,304 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "LevelCompiler.h"
+
+const char *HERO_NAMES[HEROES_COUNT] = {"dwerf", "archor", "elf", "warrior", "wizard"};
+const char *MONSTER_NAMES[MONSTERS_COUNT] = {"globnic"};
+
+static int typeFromName(const std::string &name, const char **names, int count) {
+    for (int i = 0; i < count; i++) {
+        if (name == names[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static std::string lineError(int lineNumber, const std::string &message) {
+    std::ostringstream stream;
+    stream << "line " << lineNumber << ": " << message;
+    return stream.str();
+}
+
+bool parseLevel(const std::string &source, LevelDefinition &definition, std::string &error) {
+    definition = LevelDefinition();
+    std::istringstream sourceStream(source);
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(sourceStream, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream lineStream(line);
+        std::string keyword;
+        if (!(lineStream >> keyword)) {
+            continue;
+        }
+        if (keyword == "brick") {
+            LevelBrick brick;
+            if (!(lineStream >> brick.type >> brick.position.x >> brick.position.y)) {
+                error = lineError(lineNumber, "expected brick <type> <x> <y>");
+                return false;
+            }
+            definition.bricks.push_back(brick);
+        } else if (keyword == "door" || keyword == "hallway" || keyword == "glue") {
+            LevelConnection connection;
+            connection.type = keyword == "door" ? CONNECTION_TYPE_DOOR : (keyword == "hallway" ? CONNECTION_TYPE_HALLWAY : CONNECTION_TYPE_VIEW_GLUE);
+            if (!(lineStream >> connection.position1.x >> connection.position1.y >> connection.position2.x >> connection.position2.y)) {
+                error = lineError(lineNumber, "expected " + keyword + " <x1> <y1> <x2> <y2>");
+                return false;
+            }
+            definition.connections.push_back(connection);
+        } else if (keyword == "hero" || keyword == "monster") {
+            std::string name;
+            LevelFigure figure;
+            if (!(lineStream >> name >> figure.position.x >> figure.position.y)) {
+                error = lineError(lineNumber, "expected " + keyword + " <name> <x> <y>");
+                return false;
+            }
+            figure.type = keyword == "hero" ? typeFromName(name, HERO_NAMES, HEROES_COUNT) : typeFromName(name, MONSTER_NAMES, MONSTERS_COUNT);
+            if (figure.type == -1) {
+                error = lineError(lineNumber, "unknown " + keyword + " " + name);
+                return false;
+            }
+            (keyword == "hero" ? definition.heroes : definition.monsters).push_back(figure);
+        } else {
+            error = lineError(lineNumber, "unknown item " + keyword);
+            return false;
+        }
+        std::string rest;
+        if (lineStream >> rest) {
+            error = lineError(lineNumber, "unexpected " + rest);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isValidBoardPosition(cv::Point p) {
+    return p.x >= 0 && p.y >= 0 && p.x < BOARD_WIDTH && p.y < BOARD_HEIGHT;
+}
+
+static int findRoom(std::vector<int> &rooms, int brick) {
+    while (rooms[brick] != brick) {
+        brick = rooms[brick] = rooms[rooms[brick]];
+    }
+    return brick;
+}
+
+template <typename T> static void appendItems(std::vector<unsigned char> &image, const std::vector<T> &items) {
+    if (items.size() > 0) {
+        image.insert(image.end(), (const unsigned char *)&items[0], (const unsigned char *)&items[0] + items.size() * sizeof(T));
+    }
+}
+
+bool compileLevel(const LevelDefinition &definition, std::vector<unsigned char> &image, std::string &error) {
+    std::ostringstream message;
+    if (definition.bricks.size() == 0 || definition.bricks.size() > 127 || definition.connections.size() > 255) {
+        error = "level must have between 1 and 127 bricks and at most 255 connections";
+        return false;
+    }
+    if (definition.heroes.size() == 0 || definition.heroes.size() > HEROES_COUNT || definition.heroes.size() + definition.monsters.size() > MAX_FIGURES) {
+        error = "level must have between 1 and 5 heroes and at most 64 figures in total";
+        return false;
+    }
+
+    // Brick map
+    std::vector<int8_t> brickMap(BOARD_WIDTH * BOARD_HEIGHT, -1);
+    for (int i = 0; i < definition.bricks.size(); i++) {
+        const LevelBrick &brick = definition.bricks[i];
+        if (brick.type < 0 || brick.type >= BRICK_IMAGES_COUNT) {
+            message << "brick " << i << " has unknown type " << brick.type;
+            error = message.str();
+            return false;
+        }
+        cv::Size size = brickTypeBoardSize(brick.type);
+        if (!isValidBoardPosition(brick.position) || !isValidBoardPosition(brick.position + cv::Point(size.width - 1, size.height - 1))) {
+            message << "brick " << i << " is outside the board";
+            error = message.str();
+            return false;
+        }
+        for (int y = brick.position.y; y < brick.position.y + size.height; y++) {
+            for (int x = brick.position.x; x < brick.position.x + size.width; x++) {
+                if (brickMap[y * BOARD_WIDTH + x] != -1) {
+                    message << "brick " << i << " overlaps brick " << (int)brickMap[y * BOARD_WIDTH + x] << " at " << x << ", " << y;
+                    error = message.str();
+                    return false;
+                }
+                brickMap[y * BOARD_WIDTH + x] = i;
+            }
+        }
+    }
+
+    // Connections must join neighbouring cells of two bricks
+    std::vector<LevelImageConnection> connections;
+    std::vector<int> roomOfBrick(definition.bricks.size());
+    for (int i = 0; i < roomOfBrick.size(); i++) {
+        roomOfBrick[i] = i;
+    }
+    for (int i = 0; i < definition.connections.size(); i++) {
+        const LevelConnection &c = definition.connections[i];
+        int brick1 = isValidBoardPosition(c.position1) ? brickMap[c.position1.y * BOARD_WIDTH + c.position1.x] : -1;
+        int brick2 = isValidBoardPosition(c.position2) ? brickMap[c.position2.y * BOARD_WIDTH + c.position2.x] : -1;
+        if (brick1 == -1 || brick2 == -1 || brick1 == brick2) {
+            message << "connection " << i << " does not join two bricks";
+            error = message.str();
+            return false;
+        }
+        if (std::max(std::abs(c.position1.x - c.position2.x), std::abs(c.position1.y - c.position2.y)) != 1) {
+            message << "connection " << i << " joins cells that are not next to each other";
+            error = message.str();
+            return false;
+        }
+        LevelImageConnection connection = {.type = (int8_t)c.type, .x1 = (int8_t)c.position1.x, .y1 = (int8_t)c.position1.y, .x2 = (int8_t)c.position2.x, .y2 = (int8_t)c.position2.y, .brick1 = (int8_t)brick1, .brick2 = (int8_t)brick2, .reserved = 0};
+        connections.push_back(connection);
+        if (c.type == CONNECTION_TYPE_VIEW_GLUE) {
+            roomOfBrick[findRoom(roomOfBrick, brick1)] = findRoom(roomOfBrick, brick2);
+        }
+    }
+
+    // Rooms are the bricks joined by view glue, numbered in brick order
+    std::vector<int> roomIndex(definition.bricks.size(), -1);
+    std::vector<LevelImageBrick> bricks;
+    int roomCount = 0;
+    for (int i = 0; i < definition.bricks.size(); i++) {
+        int root = findRoom(roomOfBrick, i);
+        if (roomIndex[root] == -1) {
+            roomIndex[root] = roomCount++;
+        }
+        LevelImageBrick brick = {.type = (int8_t)definition.bricks[i].type, .x = (int8_t)definition.bricks[i].position.x, .y = (int8_t)definition.bricks[i].position.y, .room = (int8_t)roomIndex[root]};
+        bricks.push_back(brick);
+    }
+    if (roomCount > LEVEL_IMAGE_MAX_ROOMS) {
+        message << "level has " << roomCount << " rooms, at most " << LEVEL_IMAGE_MAX_ROOMS << " are supported";
+        error = message.str();
+        return false;
+    }
+    std::vector<LevelImageRoom> rooms(roomCount);
+    for (int i = 0; i < roomCount; i++) {
+        rooms[i].adjacentRooms = 0;
+    }
+    for (int i = 0; i < connections.size(); i++) {
+        int room1 = bricks[connections[i].brick1].room;
+        int room2 = bricks[connections[i].brick2].room;
+        if (connections[i].type != CONNECTION_TYPE_VIEW_GLUE && room1 != room2) {
+            rooms[room1].adjacentRooms |= 1u << room2;
+            rooms[room2].adjacentRooms |= 1u << room1;
+        }
+    }
+
+    // Figures must spawn on a brick, one per cell
+    std::vector<LevelImageFigure> heroes;
+    std::vector<LevelImageFigure> monsters;
+    std::vector<bool> occupied(BOARD_WIDTH * BOARD_HEIGHT, false);
+    for (int i = 0; i < definition.heroes.size() + definition.monsters.size(); i++) {
+        bool hero = i < definition.heroes.size();
+        const LevelFigure &f = hero ? definition.heroes[i] : definition.monsters[i - definition.heroes.size()];
+        if (f.type < 0 || f.type >= (hero ? HEROES_COUNT : MONSTERS_COUNT)) {
+            message << (hero ? "hero " : "monster ") << f.type << " is unknown";
+            error = message.str();
+            return false;
+        }
+        if (!isValidBoardPosition(f.position) || brickMap[f.position.y * BOARD_WIDTH + f.position.x] == -1) {
+            message << (hero ? "hero" : "monster") << " at " << f.position.x << ", " << f.position.y << " is not on a brick";
+            error = message.str();
+            return false;
+        }
+        if (occupied[f.position.y * BOARD_WIDTH + f.position.x]) {
+            message << "two figures at " << f.position.x << ", " << f.position.y;
+            error = message.str();
+            return false;
+        }
+        occupied[f.position.y * BOARD_WIDTH + f.position.x] = true;
+        LevelImageFigure figure = {.type = (int8_t)f.type, .x = (int8_t)f.position.x, .y = (int8_t)f.position.y, .reserved = 0};
+        (hero ? heroes : monsters).push_back(figure);
+    }
+
+    LevelImageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = LEVEL_IMAGE_MAGIC;
+    header.version = LEVEL_IMAGE_VERSION;
+    header.headerSize = sizeof(LevelImageHeader);
+    header.boardWidth = BOARD_WIDTH;
+    header.boardHeight = BOARD_HEIGHT;
+    header.brickCount = bricks.size();
+    header.connectionCount = connections.size();
+    header.roomCount = roomCount;
+    header.heroCount = heroes.size();
+    header.monsterCount = monsters.size();
+    header.fileSize = (uint32_t)levelImageSize(header);
+
+    image.assign((const unsigned char *)&header, (const unsigned char *)&header + sizeof(header));
+    appendItems(image, bricks);
+    appendItems(image, connections);
+    appendItems(image, rooms);
+    appendItems(image, heroes);
+    appendItems(image, monsters);
+    appendItems(image, brickMap);
+
+    LevelImageHeader *imageHeader = (LevelImageHeader *)&image[0];
+    imageHeader->checksum = levelImageChecksum(&image[sizeof(LevelImageHeader)], image.size() - sizeof(LevelImageHeader));
+    return verifyLevelImage(&image[0], image.size(), error);
+}
+
+#ifdef LEVEL_COMPILER_MAIN
+
+#include <fstream>
+#include <iostream>
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <level description> <level image>" << std::endl;
+        return 1;
+    }
+    std::ifstream input(argv[1]);
+    if (!input) {
+        std::cerr << argv[1] << ": could not open file" << std::endl;
+        return 1;
+    }
+    std::stringstream source;
+    source << input.rdbuf();
+
+    LevelDefinition definition;
+    std::vector<unsigned char> image;
+    std::string error;
+    if (!parseLevel(source.str(), definition, error) || !compileLevel(definition, image, error)) {
+        std::cerr << argv[1] << ": " << error << std::endl;
+        return 1;
+    }
+    std::ofstream output(argv[2], std::ios::binary);
+    output.write((const char *)&image[0], image.size());
+    if (!output) {
+        std::cerr << argv[2] << ": could not write file" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+#endif
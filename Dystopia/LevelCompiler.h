@@ -0,0 +1,55 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_LevelCompiler_h
+#define Dystopia_LevelCompiler_h
+
+#include <string>
+#include <vector>
+
+#include "GameRules.h"
+#include "LevelImage.h"
+
+// Compiles level descriptions into level images. A description has one item per line, # starting a comment:
+//
+//   brick <type> <x> <y>
+//   door <x1> <y1> <x2> <y2>
+//   hallway <x1> <y1> <x2> <y2>
+//   glue <x1> <y1> <x2> <y2>
+//   hero <dwerf|archor|elf|warrior|wizard> <x> <y>
+//   monster <globnic> <x> <y>
+//
+// The first brick is the room the heroes start in. Build the command line compiler with
+//
+//   c++ -std=c++11 -DLEVEL_COMPILER_MAIN LevelCompiler.cpp LevelImage.cpp GameRules.cpp -o levelc
+//
+// and run it as levelc Levels/level1.txt Levels/level1.level after changing a level.
+
+bool parseLevel(const std::string &source, LevelDefinition &definition, std::string &error);
+
+// Validates the level and builds its image with brick map, rooms, doors and figure spawns
+bool compileLevel(const LevelDefinition &definition, std::vector<unsigned char> &image, std::string &error);
+
+#endif
@@ -0,0 +1,228 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "LevelImage.h"
+
+size_t levelImageSize(const LevelImageHeader &header) {
+    return sizeof(LevelImageHeader) +
+           header.brickCount * sizeof(LevelImageBrick) +
+           header.connectionCount * sizeof(LevelImageConnection) +
+           header.roomCount * sizeof(LevelImageRoom) +
+           (header.heroCount + header.monsterCount) * sizeof(LevelImageFigure) +
+           header.boardWidth * header.boardHeight;
+}
+
+uint32_t levelImageChecksum(const unsigned char *data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool isValidBoardPosition(int x, int y) {
+    return x >= 0 && y >= 0 && x < BOARD_WIDTH && y < BOARD_HEIGHT;
+}
+
+static bool isValidBrickIndex(int index, const LevelImageHeader &header) {
+    return index >= 0 && index < header.brickCount;
+}
+
+bool verifyLevelImage(const unsigned char *data, size_t size, std::string &error) {
+    if (size < sizeof(LevelImageHeader)) {
+        error = "file too small";
+        return false;
+    }
+    const LevelImageHeader &header = *(const LevelImageHeader *)data;
+    if (header.magic != LEVEL_IMAGE_MAGIC || header.headerSize != sizeof(LevelImageHeader)) {
+        error = "not a level image";
+        return false;
+    }
+    if (header.version != LEVEL_IMAGE_VERSION) {
+        error = "unsupported level image version";
+        return false;
+    }
+    if (header.boardWidth != BOARD_WIDTH || header.boardHeight != BOARD_HEIGHT) {
+        error = "board size mismatch";
+        return false;
+    }
+    if (header.fileSize != size || levelImageSize(header) != size) {
+        error = "size mismatch";
+        return false;
+    }
+    if (header.roomCount > LEVEL_IMAGE_MAX_ROOMS || header.heroCount > HEROES_COUNT) {
+        error = "too many rooms or heroes";
+        return false;
+    }
+    if (levelImageChecksum(data + sizeof(LevelImageHeader), size - sizeof(LevelImageHeader)) != header.checksum) {
+        error = "checksum mismatch";
+        return false;
+    }
+
+    // Indices are checked once here, so readers of the image can use them without bounds checks
+    const LevelImageBrick *bricks = (const LevelImageBrick *)(data + sizeof(LevelImageHeader));
+    for (int i = 0; i < header.brickCount; i++) {
+        if (bricks[i].type < 0 || bricks[i].type >= BRICK_IMAGES_COUNT || bricks[i].room < 0 || bricks[i].room >= header.roomCount) {
+            error = "invalid brick";
+            return false;
+        }
+        cv::Size brickSize = brickTypeBoardSize(bricks[i].type);
+        if (!isValidBoardPosition(bricks[i].x, bricks[i].y) || !isValidBoardPosition(bricks[i].x + brickSize.width - 1, bricks[i].y + brickSize.height - 1)) {
+            error = "brick outside board";
+            return false;
+        }
+    }
+    const LevelImageConnection *connections = (const LevelImageConnection *)(bricks + header.brickCount);
+    for (int i = 0; i < header.connectionCount; i++) {
+        const LevelImageConnection &c = connections[i];
+        if (c.type < CONNECTION_TYPE_VIEW_GLUE || c.type > CONNECTION_TYPE_HALLWAY || !isValidBoardPosition(c.x1, c.y1) || !isValidBoardPosition(c.x2, c.y2) ||
+            !isValidBrickIndex(c.brick1, header) || !isValidBrickIndex(c.brick2, header)) {
+            error = "invalid connection";
+            return false;
+        }
+    }
+    const LevelImageFigure *figures = (const LevelImageFigure *)((const LevelImageRoom *)(connections + header.connectionCount) + header.roomCount);
+    for (int i = 0; i < header.heroCount + header.monsterCount; i++) {
+        int typeCount = i < header.heroCount ? HEROES_COUNT : MONSTERS_COUNT;
+        if (figures[i].type < 0 || figures[i].type >= typeCount || !isValidBoardPosition(figures[i].x, figures[i].y)) {
+            error = "invalid figure";
+            return false;
+        }
+    }
+    const int8_t *brickMap = (const int8_t *)(figures + header.heroCount + header.monsterCount);
+    for (int i = 0; i < BOARD_WIDTH * BOARD_HEIGHT; i++) {
+        if (brickMap[i] != -1 && !isValidBrickIndex(brickMap[i], header)) {
+            error = "invalid brick map";
+            return false;
+        }
+    }
+    return true;
+}
+
+LevelImage::LevelImage() : data(NULL), size(0) {
+}
+
+LevelImage::~LevelImage() {
+    close();
+}
+
+bool LevelImage::open(const char *path, std::string &error) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd == -1) {
+        error = "could not open file";
+        return false;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+        ::close(fd);
+        error = "could not read file size";
+        return false;
+    }
+    void *mapping = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = "could not map file";
+        return false;
+    }
+    if (!verifyLevelImage((const unsigned char *)mapping, fileStat.st_size, error)) {
+        munmap(mapping, fileStat.st_size);
+        return false;
+    }
+    data = (const unsigned char *)mapping;
+    size = fileStat.st_size;
+    return true;
+}
+
+void LevelImage::close() {
+    if (data != NULL) {
+        munmap((void *)data, size);
+        data = NULL;
+        size = 0;
+    }
+}
+
+bool LevelImage::isOpen() const {
+    return data != NULL;
+}
+
+const LevelImageHeader &LevelImage::header() const {
+    return *(const LevelImageHeader *)data;
+}
+
+const LevelImageBrick *LevelImage::bricks() const {
+    return (const LevelImageBrick *)(data + sizeof(LevelImageHeader));
+}
+
+const LevelImageConnection *LevelImage::connections() const {
+    return (const LevelImageConnection *)(bricks() + header().brickCount);
+}
+
+const LevelImageRoom *LevelImage::rooms() const {
+    return (const LevelImageRoom *)(connections() + header().connectionCount);
+}
+
+const LevelImageFigure *LevelImage::heroes() const {
+    return (const LevelImageFigure *)(rooms() + header().roomCount);
+}
+
+const LevelImageFigure *LevelImage::monsters() const {
+    return heroes() + header().heroCount;
+}
+
+int LevelImage::brickIndexAtPosition(cv::Point position) const {
+    if (!isValidBoardPosition(position.x, position.y)) {
+        return -1;
+    }
+    const int8_t *brickMap = (const int8_t *)(monsters() + header().monsterCount);
+    return brickMap[position.y * BOARD_WIDTH + position.x];
+}
+
+LevelDefinition LevelImage::definition() const {
+    LevelDefinition definition;
+    for (int i = 0; i < header().brickCount; i++) {
+        LevelBrick brick = {.type = bricks()[i].type, .position = cv::Point(bricks()[i].x, bricks()[i].y)};
+        definition.bricks.push_back(brick);
+    }
+    for (int i = 0; i < header().connectionCount; i++) {
+        const LevelImageConnection &c = connections()[i];
+        LevelConnection connection = {.type = c.type, .position1 = cv::Point(c.x1, c.y1), .position2 = cv::Point(c.x2, c.y2)};
+        definition.connections.push_back(connection);
+    }
+    for (int i = 0; i < header().heroCount; i++) {
+        LevelFigure hero = {.type = heroes()[i].type, .position = cv::Point(heroes()[i].x, heroes()[i].y)};
+        definition.heroes.push_back(hero);
+    }
+    for (int i = 0; i < header().monsterCount; i++) {
+        LevelFigure monster = {.type = monsters()[i].type, .position = cv::Point(monsters()[i].x, monsters()[i].y)};
+        definition.monsters.push_back(monster);
+    }
+    return definition;
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_LevelImage_h
+#define Dystopia_LevelImage_h
+
+#include <stdint.h>
+
+#include <string>
+
+#include "GameRules.h"
+
+#define LEVEL_IMAGE_MAGIC   0x564c5944
+#define LEVEL_IMAGE_VERSION 1
+
+#define LEVEL_IMAGE_MAX_ROOMS 32
+
+// Compiled level, as written by the level compiler and memory mapped by the game. All fields are little endian.
+//
+// Layout: header, bricks, connections, rooms, heroes, monsters and finally the brick map with the index of the brick
+// covering each cell, or -1.
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t fileSize;
+
+    // FNV-1a of everything after the header
+    uint32_t checksum;
+
+    uint8_t boardWidth;
+    uint8_t boardHeight;
+    uint8_t brickCount;
+    uint8_t connectionCount;
+    uint8_t roomCount;
+    uint8_t heroCount;
+    uint8_t monsterCount;
+    uint8_t reserved;
+} LevelImageHeader;
+
+typedef struct {
+    int8_t type;
+    int8_t x;
+    int8_t y;
+
+    // Bricks joined by view glue make up a room
+    int8_t room;
+} LevelImageBrick;
+
+typedef struct {
+    int8_t type;
+    int8_t x1;
+    int8_t y1;
+    int8_t x2;
+    int8_t y2;
+    int8_t brick1;
+    int8_t brick2;
+    int8_t reserved;
+} LevelImageConnection;
+
+typedef struct {
+
+    // Bit per room reachable through a door or hallway
+    uint32_t adjacentRooms;
+} LevelImageRoom;
+
+typedef struct {
+    int8_t type;
+    int8_t x;
+    int8_t y;
+    int8_t reserved;
+} LevelImageFigure;
+
+// Size of an image with the section counts of the header
+size_t levelImageSize(const LevelImageHeader &header);
+
+uint32_t levelImageChecksum(const unsigned char *data, size_t size);
+
+// Checks header, size and checksum, and that every index in the image is in range
+bool verifyLevelImage(const unsigned char *data, size_t size, std::string &error);
+
+class LevelImage {
+public:
+    LevelImage();
+    ~LevelImage();
+
+    // Maps and verifies a compiled level file, replacing any level mapped before
+    bool open(const char *path, std::string &error);
+    void close();
+
+    bool isOpen() const;
+
+    const LevelImageHeader &header() const;
+    const LevelImageBrick *bricks() const;
+    const LevelImageConnection *connections() const;
+    const LevelImageRoom *rooms() const;
+    const LevelImageFigure *heroes() const;
+    const LevelImageFigure *monsters() const;
+    int brickIndexAtPosition(cv::Point position) const;
+
+    LevelDefinition definition() const;
+
+private:
+    LevelImage(const LevelImage &);
+    LevelImage &operator=(const LevelImage &);
+
+    const unsigned char *data;
+    size_t size;
+};
+
+#endif
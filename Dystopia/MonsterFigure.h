@@ -26,10 +26,7 @@
 #import <Foundation/Foundation.h>
 
 #import "GameObject.h"
-
-#define MONSTERS_COUNT 1
-
-#define MONSTER_GLOBNIC 0
+#import "GameRules.h"
 
 @interface MonsterFigure : MoveableGameObject
 
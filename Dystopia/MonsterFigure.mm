@@ -25,7 +25,6 @@
 
 #import "MonsterFigure.h"
 
-const int MONSTER_MOVEMENT_LENGTH[MONSTERS_COUNT] = {10};
 const NSArray *MONSTER_MARKER_IMAGE = [NSArray arrayWithObjects:@"marker_globnic.png", nil];
 
 @interface MonsterFigure () {
@@ -47,8 +46,4 @@ const NSArray *MONSTER_MARKER_IMAGE = [NSArray arrayWithObjects:@"marker_globnic
     self.active = NO;
 }
 
-- (bool)canMoveToLocation:(cv::Point)location withMovementCount:(int)movementCount {
-    return movementCount <= self.movementLength;
-}
-
 @end
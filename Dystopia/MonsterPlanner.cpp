@@ -0,0 +1,247 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <random>
+
+#include "MonsterPlanner.h"
+
+typedef std::chrono::steady_clock::time_point PlannerTime;
+
+// Shared with the pool tasks, which may outlive the call to plan if the time budget runs out
+struct PlanSearch {
+    PlannerTime deadline;
+
+    // Held here, so a board change while late tasks finish does not matter
+    std::shared_ptr<const DistanceTable> distanceTable;
+
+    std::vector<std::vector<cv::Point>> candidates;
+    std::vector<std::vector<cv::Point>> heroEscapes;
+
+    std::mutex mutex;
+    std::condition_variable finishedCondition;
+    int pendingTasks;
+
+    std::vector<int> initialChoice;
+    std::vector<int> bestChoice;
+    int bestScore;
+    int restarts;
+    bool cut;
+};
+
+static bool isPastDeadline(const PlanSearch &search) {
+    return std::chrono::steady_clock::now() >= search.deadline;
+}
+
+static void cellsOfBitboard(const Bitboard &board, std::vector<cv::Point> &cells) {
+    cells.clear();
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (uint32_t row = board.rows[i]; row != 0; row &= row - 1) {
+            cells.push_back(cv::Point(__builtin_ctz(row), i));
+        }
+    }
+}
+
+static int plannerDistance(const DistanceTable &table, cv::Point from, cv::Point to) {
+    int distance = table.distance(from, to);
+    return distance == DISTANCE_TABLE_UNREACHABLE ? MONSTER_PLANNER_FAR_DISTANCE : distance;
+}
+
+// Lower is better. Plans with two monsters on one cell are never chosen
+static int planScore(const PlanSearch &search, const std::vector<int> &choice) {
+    for (int i = 0; i < choice.size(); i++) {
+        for (int j = i + 1; j < choice.size(); j++) {
+            if (search.candidates[i][choice[i]] == search.candidates[j][choice[j]]) {
+                return INT_MAX;
+            }
+        }
+    }
+    int score = 0;
+    for (int h = 0; h < search.heroEscapes.size(); h++) {
+        int escapeDistance = 0;
+        for (int c = 0; c < search.heroEscapes[h].size(); c++) {
+            cv::Point p = search.heroEscapes[h][c];
+            int distance = MONSTER_PLANNER_FAR_DISTANCE;
+            for (int m = 0; m < choice.size() && distance > escapeDistance; m++) {
+                distance = std::min(distance, plannerDistance(*search.distanceTable, search.candidates[m][choice[m]], p));
+            }
+            escapeDistance = std::max(escapeDistance, distance);
+        }
+        score += escapeDistance;
+    }
+    return score;
+}
+
+// Changes one monster at a time to its best candidate until no change helps
+static int improvePlan(const PlanSearch &search, std::vector<int> &choice) {
+    int score = planScore(search, choice);
+    for (bool improved = true; improved; ) {
+        improved = false;
+        for (int m = 0; m < choice.size(); m++) {
+            if (isPastDeadline(search)) {
+                return score;
+            }
+            int original = choice[m];
+            for (int k = 0; k < search.candidates[m].size(); k++) {
+                if (k == original) {
+                    continue;
+                }
+                choice[m] = k;
+                int candidateScore = planScore(search, choice);
+                if (candidateScore < score) {
+                    score = candidateScore;
+                    original = k;
+                    improved = true;
+                }
+            }
+            choice[m] = original;
+        }
+    }
+    return score;
+}
+
+static void finishTask(PlanSearch &search) {
+    std::lock_guard<std::mutex> lock(search.mutex);
+    search.pendingTasks--;
+    search.finishedCondition.notify_all();
+}
+
+// Returns false if the deadline came first
+static bool waitForTasks(PlanSearch &search) {
+    std::unique_lock<std::mutex> lock(search.mutex);
+    return search.finishedCondition.wait_until(lock, search.deadline, [&search] { return search.pendingTasks == 0; });
+}
+
+MonsterPlan planMonsterMoves(const Pathfinder &pathfinder, const std::vector<PlannerFigure> &monsters, const std::vector<PlannerFigure> &heroes, const Bitboard &blocked, double timeBudget, unsigned int seed, WorkStealingPool &pool) {
+    std::shared_ptr<PlanSearch> search = std::make_shared<PlanSearch>();
+    search->deadline = std::chrono::steady_clock::now() + std::chrono::microseconds((long long)(timeBudget * 1000000.0));
+    search->distanceTable = pathfinder.distanceTable();
+    search->pendingTasks = 0;
+    search->restarts = 0;
+    search->cut = false;
+
+    // Candidates are the reachable cells closest to any hero, the monster's own cell always among them
+    std::vector<cv::Point> cells;
+    search->candidates.resize(monsters.size());
+    for (int m = 0; m < monsters.size(); m++) {
+        Bitboard monsterBlocked = blocked;
+        monsterBlocked.rows[monsters[m].position.y] &= ~(1u << monsters[m].position.x);
+        cellsOfBitboard(pathfinder.reachableCells(monsters[m].position, monsters[m].movementLength, monsterBlocked), cells);
+
+        std::vector<std::pair<int, int>> rankedCells;
+        for (int i = 0; i < cells.size(); i++) {
+            int distance = MONSTER_PLANNER_FAR_DISTANCE;
+            for (int h = 0; h < heroes.size(); h++) {
+                distance = std::min(distance, plannerDistance(*search->distanceTable, heroes[h].position, cells[i]));
+            }
+            rankedCells.push_back(std::make_pair(distance, i));
+        }
+        std::sort(rankedCells.begin(), rankedCells.end());
+        bool hasOwnPosition = false;
+        for (int i = 0; i < rankedCells.size() && i < MONSTER_PLANNER_CANDIDATES; i++) {
+            cv::Point p = cells[rankedCells[i].second];
+            search->candidates[m].push_back(p);
+            hasOwnPosition |= p == monsters[m].position;
+        }
+        if (!hasOwnPosition) {
+            search->candidates[m].push_back(monsters[m].position);
+        }
+    }
+
+    // Each monster's best cell on its own, moving aside on conflicts. Used as is if the search is cut short
+    search->bestChoice.assign(monsters.size(), 0);
+    for (int m = 0; m < monsters.size(); m++) {
+        for (int k = 0; k < search->candidates[m].size(); k++) {
+            bool taken = false;
+            for (int other = 0; other < m; other++) {
+                taken |= search->candidates[other][search->bestChoice[other]] == search->candidates[m][k];
+            }
+            if (!taken) {
+                search->bestChoice[m] = k;
+                break;
+            }
+        }
+    }
+
+    search->heroEscapes.resize(heroes.size());
+    for (int h = 0; h < heroes.size(); h++) {
+        Bitboard heroBlocked = blocked;
+        heroBlocked.rows[heroes[h].position.y] &= ~(1u << heroes[h].position.x);
+        cellsOfBitboard(pathfinder.reachableCells(heroes[h].position, heroes[h].movementLength, heroBlocked), search->heroEscapes[h]);
+    }
+
+    search->initialChoice = search->bestChoice;
+    search->bestScore = planScore(*search, search->bestChoice);
+    if (monsters.size() > 0 && heroes.size() > 0) {
+        int taskCount = pool.workerCount();
+        {
+            std::lock_guard<std::mutex> lock(search->mutex);
+            search->pendingTasks = taskCount;
+        }
+        for (int task = 0; task < taskCount; task++) {
+            pool.submit([search, task, seed]() {
+                std::mt19937 random(seed + task);
+                std::vector<int> choice(search->candidates.size());
+                for (int restart = 0; restart < MONSTER_PLANNER_MAX_RESTARTS && !isPastDeadline(*search); restart++) {
+                    if (task == 0 && restart == 0) {
+                        choice = search->initialChoice;
+                    } else {
+                        for (int m = 0; m < choice.size(); m++) {
+                            choice[m] = std::uniform_int_distribution<int>(0, (int)search->candidates[m].size() - 1)(random);
+                        }
+                    }
+                    int score = improvePlan(*search, choice);
+
+                    std::lock_guard<std::mutex> lock(search->mutex);
+                    search->restarts++;
+                    if (score < search->bestScore) {
+                        search->bestScore = score;
+                        search->bestChoice = choice;
+                    }
+                }
+                if (isPastDeadline(*search)) {
+                    std::lock_guard<std::mutex> lock(search->mutex);
+                    search->cut = true;
+                }
+                finishTask(*search);
+            });
+        }
+        waitForTasks(*search);
+    }
+
+    std::lock_guard<std::mutex> lock(search->mutex);
+    MonsterPlan plan;
+    for (int m = 0; m < monsters.size(); m++) {
+        plan.destinations.push_back(search->candidates[m][search->bestChoice[m]]);
+    }
+    plan.score = search->bestScore;
+    plan.restarts = search->restarts;
+    plan.complete = search->pendingTasks == 0 && !search->cut;
+    return plan;
+}
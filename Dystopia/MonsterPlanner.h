@@ -0,0 +1,70 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_MonsterPlanner_h
+#define Dystopia_MonsterPlanner_h
+
+#include <vector>
+
+#include "Pathfinder.h"
+#include "WorkStealingPool.h"
+
+// Destinations per monster kept for the joint search, best first
+#define MONSTER_PLANNER_CANDIDATES 24
+
+// Restarts per search task before it gives up early
+#define MONSTER_PLANNER_MAX_RESTARTS 64
+
+// Distance used for cells a monster cannot reach at all
+#define MONSTER_PLANNER_FAR_DISTANCE 1000
+
+typedef struct {
+    cv::Point position;
+    int movementLength;
+} PlannerFigure;
+
+typedef struct {
+
+    // One per monster, in the order given. A monster that should stay keeps its own position
+    std::vector<cv::Point> destinations;
+
+    // Sum over heroes of the distance to the closest monster after the hero's best escape. Lower is better
+    int score;
+
+    int restarts;
+
+    // The search ran to the end rather than being cut by the time budget
+    bool complete;
+} MonsterPlan;
+
+// Joint monster moves, searched two plies deep: monsters move together, then every hero moves as far from the monsters
+// as it can reach.
+//
+// Each worker runs restarts of a local search, one monster changed at a time, with distances looked up in the
+// board's distance table. The best plan found when the time budget runs out is returned; no result waits for a worker
+// that is still busy.
+MonsterPlan planMonsterMoves(const Pathfinder &pathfinder, const std::vector<PlannerFigure> &monsters, const std::vector<PlannerFigure> &heroes, const Bitboard &blocked, double timeBudget, unsigned int seed, WorkStealingPool &pool);
+
+#endif
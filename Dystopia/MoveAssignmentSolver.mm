@@ -0,0 +1,101 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "MoveAssignmentSolver.h"
+
+typedef struct {
+    cv::vector<cv::vector<bool>> allowed;
+    cv::vector<cv::vector<int>> cost;
+    cv::vector<int> current;
+    cv::vector<int> best;
+    cv::vector<bool> taken;
+    int bestCost;
+} AssignmentSearch;
+
+MoveAssignmentSolver *moveAssignmentSolverInstance = nil;
+
+@implementation MoveAssignmentSolver
+
++ (MoveAssignmentSolver *)instance {
+    @synchronized(self) {
+        if (moveAssignmentSolverInstance == nil) {
+            moveAssignmentSolverInstance = [[MoveAssignmentSolver alloc] init];
+        }
+        return moveAssignmentSolverInstance;
+    }
+}
+
+- (cv::vector<int>)assignmentFromOrigins:(cv::vector<cv::Point>)origins reachablePositions:(cv::vector<cv::vector<cv::Point>>)reachablePositions destinations:(cv::vector<cv::Point>)destinations {
+    cv::vector<int> noAssignment;
+    if (origins.size() == 0 || origins.size() != destinations.size() || origins.size() > MOVE_ASSIGNMENT_MAX_FIGURES) {
+        return noAssignment;
+    }
+
+    // Build constraint and cost matrices
+    AssignmentSearch search;
+    search.allowed = cv::vector<cv::vector<bool>>(origins.size(), cv::vector<bool>(destinations.size(), false));
+    search.cost = cv::vector<cv::vector<int>>(origins.size(), cv::vector<int>(destinations.size(), 0));
+    for (int i = 0; i < origins.size(); i++) {
+        for (int j = 0; j < destinations.size(); j++) {
+            search.allowed[i][j] = std::find(reachablePositions[i].begin(), reachablePositions[i].end(), destinations[j]) != reachablePositions[i].end();
+            search.cost[i][j] = ABS(origins[i].x - destinations[j].x) + ABS(origins[i].y - destinations[j].y);
+        }
+    }
+    search.current = cv::vector<int>(origins.size(), -1);
+    search.taken = cv::vector<bool>(destinations.size(), false);
+    search.bestCost = -1;
+
+    [self searchAssignment:search figure:0 cost:0];
+
+    // Equally cheap assignments are a stable board state, not a bad frame, so ties go to the first one found. Search
+    // tries destinations in order for each origin in order, so the same board always gives the same assignment
+    if (search.bestCost == -1) {
+        return noAssignment;
+    }
+    return search.best;
+}
+
+- (void)searchAssignment:(AssignmentSearch &)search figure:(int)figure cost:(int)cost {
+    if (search.bestCost != -1 && cost >= search.bestCost) {
+        return;
+    }
+    if (figure == search.current.size()) {
+        search.bestCost = cost;
+        search.best = search.current;
+        return;
+    }
+    for (int j = 0; j < search.taken.size(); j++) {
+        if (search.taken[j] || !search.allowed[figure][j]) {
+            continue;
+        }
+        search.taken[j] = true;
+        search.current[figure] = j;
+        [self searchAssignment:search figure:(figure + 1) cost:(cost + search.cost[figure][j])];
+        search.current[figure] = -1;
+        search.taken[j] = false;
+    }
+}
+
+@end
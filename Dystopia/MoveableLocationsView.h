@@ -25,9 +25,15 @@
 
 #import <UIKit/UIKit.h>
 
+#import "DistanceTable.h"
+
+#define MOVEABLE_LOCATIONS_APPEAR_DURATION 1.0f
+#define MOVEABLE_LOCATIONS_REAPPEAR_DURATION 1.5f
+
 @interface MoveableLocationsView : UIView
 
 - (void)showLocations:(cv::vector<cv::Point>)l;
+- (void)showLocationMask:(Bitboard)mask;
 - (void)hideLocations;
 
 @end
@@ -23,16 +23,23 @@
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 // SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+#import <QuartzCore/QuartzCore.h>
+
 #import "MoveableLocationsView.h"
 #import "BoardUtil.h"
+#import "GameScheduler.h"
 
-#define MOVEABLE_LOCATIONS_APPEAR_DURATION 1.0f
-#define MOVEABLE_LOCATIONS_REAPPEAR_DURATION 1.5f
+// Premultiplied RGBA of red at 0.3 alpha
+const uint8_t MOVEABLE_LOCATION_PIXEL[4] = {77, 0, 0, 77};
 
 @interface MoveableLocationsView () {
-    cv::vector<cv::Point> locations;
-    NSMutableArray *views;
-    UIColor *moveableLocationColor;
+    Bitboard locationMask;
+    Bitboard drawnLocationMask;
+
+    // One pixel per board cell, scaled up by the layer
+    CGContextRef locationContext;
+    CALayer *locationLayer;
+
     bool visible;
 }
 
@@ -52,15 +59,46 @@
     self.alpha = 0.0f;
     self.hidden = YES;
     visible = NO;
-    moveableLocationColor = [UIColor colorWithRed:1.0f green:0.0f blue:0.0f alpha:0.3f];
-    views = nil;
+    clearBitboard(locationMask);
+    clearBitboard(drawnLocationMask);
+
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    locationContext = CGBitmapContextCreate(NULL, BOARD_WIDTH, BOARD_HEIGHT, 8, BOARD_WIDTH * 4, colorSpace, kCGImageAlphaPremultipliedLast);
+    CGColorSpaceRelease(colorSpace);
+    memset(CGBitmapContextGetData(locationContext), 0, BOARD_WIDTH * BOARD_HEIGHT * 4);
+
+    locationLayer = [CALayer layer];
+    locationLayer.magnificationFilter = kCAFilterNearest;
+    [self.layer addSublayer:locationLayer];
+}
+
+- (void)dealloc {
+    CGContextRelease(locationContext);
+}
+
+- (void)layoutSubviews {
+    [super layoutSubviews];
+    CGPoint origin = [[BoardUtil instance] brickScreenPosition:cv::Point(0, 0)];
+    CGSize cellSize = [[BoardUtil instance] singleBrickScreenSize];
+    locationLayer.frame = CGRectMake(origin.x, origin.y, cellSize.width * BOARD_WIDTH, cellSize.height * BOARD_HEIGHT);
 }
 
 - (void)showLocations:(cv::vector<cv::Point>)l {
-    locations = l;
+    Bitboard mask;
+    clearBitboard(mask);
+    for (int i = 0; i < l.size(); i++) {
+        setBitboardCell(mask, l[i]);
+    }
+    [self showLocationMask:mask];
+}
+
+- (void)showLocationMask:(Bitboard)mask {
+    locationMask = mask;
     if (visible) {
         [self hideLocations];
-        [self performSelector:@selector(createAndShowLocations) withObject:nil afterDelay:(MOVEABLE_LOCATIONS_REAPPEAR_DURATION)];
+        [[GameScheduler instance] performBlock:^{
+            [self createAndShowLocations];
+        } afterDelay:MOVEABLE_LOCATIONS_REAPPEAR_DURATION];
     } else {
         [self createAndShowLocations];
     }
@@ -75,7 +113,9 @@
             self.alpha = 0.0f;
         }];
     });
-    [self performSelector:@selector(hideView) withObject:nil afterDelay:MOVEABLE_LOCATIONS_APPEAR_DURATION];
+    [[GameScheduler instance] performBlock:^{
+        [self hideView];
+    } afterDelay:MOVEABLE_LOCATIONS_APPEAR_DURATION];
 }
 
 - (void)hideView {
@@ -90,32 +130,41 @@
             self.hidden = NO;
             visible = YES;
         }
-        [self createLocationViews];
+        [self drawLocations];
         [UIView animateWithDuration:MOVEABLE_LOCATIONS_APPEAR_DURATION animations:^{
             self.alpha = 1.0f;
         }];
     });
 }
 
-- (void)removeViews {
-    if (views == nil) {
-        return;
+- (void)drawLocations {
+
+    // Only cells that changed since last drawn are touched
+    uint8_t *pixels = (uint8_t *)CGBitmapContextGetData(locationContext);
+    bool changed = NO;
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (uint32_t changedCells = locationMask.rows[i] ^ drawnLocationMask.rows[i]; changedCells != 0; changedCells &= changedCells - 1) {
+            int j = __builtin_ctz(changedCells);
+            uint8_t *pixel = pixels + (i * BOARD_WIDTH + j) * 4;
+            if ((locationMask.rows[i] >> j) & 1) {
+                memcpy(pixel, MOVEABLE_LOCATION_PIXEL, 4);
+            } else {
+                memset(pixel, 0, 4);
+            }
+            changed = YES;
+        }
     }
-    for (UIView *view in views) {
-        [view removeFromSuperview];
+    if (!changed) {
+        return;
     }
-    views = nil;
-}
+    drawnLocationMask = locationMask;
 
-- (void)createLocationViews {
-    [self removeViews];
-    views = [NSMutableArray array];
-    for (int i = 0; i < locations.size(); i++) {
-        UIView *view = [[UIView alloc] initWithFrame:[[BoardUtil instance] brickScreenRect:locations[i]]];
-        view.backgroundColor = moveableLocationColor;
-        [self addSubview:view];
-        [views addObject:view];
-    }
+    CGImageRef image = CGBitmapContextCreateImage(locationContext);
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    locationLayer.contents = (__bridge id)image;
+    [CATransaction commit];
+    CGImageRelease(image);
 }
 
 @end
@@ -0,0 +1,225 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <cstring>
+
+#include "Pathfinder.h"
+
+Pathfinder::Pathfinder() {
+    int noRooms[BOARD_HEIGHT][BOARD_WIDTH];
+    memset(noRooms, -1, sizeof(noRooms));
+    setBoard(noRooms);
+}
+
+void Pathfinder::setBoard(const int r[BOARD_HEIGHT][BOARD_WIDTH]) {
+    memcpy(rooms, r, sizeof(rooms));
+    clearBitboard(walkableCells);
+    memset(roomLinks, 0, sizeof(roomLinks));
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (int j = 0; j < BOARD_WIDTH; j++) {
+            int room = rooms[i][j];
+            if (room < 0 || room >= PATHFINDER_MAX_ROOMS) {
+                rooms[i][j] = -1;
+                continue;
+            }
+            setBitboardCell(walkableCells, cv::Point(j, i));
+            int right = j < BOARD_WIDTH - 1 ? r[i][j + 1] : -1;
+            int below = i < BOARD_HEIGHT - 1 ? r[i + 1][j] : -1;
+            if (right >= 0 && right < PATHFINDER_MAX_ROOMS && right != room) {
+                roomLinks[room] |= 1u << right;
+                roomLinks[right] |= 1u << room;
+            }
+            if (below >= 0 && below < PATHFINDER_MAX_ROOMS && below != room) {
+                roomLinks[room] |= 1u << below;
+                roomLinks[below] |= 1u << room;
+            }
+        }
+    }
+    table = std::make_shared<const DistanceTable>(walkableCells, table.get());
+}
+
+const Bitboard &Pathfinder::walkable() const {
+    return walkableCells;
+}
+
+int Pathfinder::roomAtPosition(cv::Point position) const {
+    return bitboardContains(walkableCells, position) ? rooms[position.y][position.x] : -1;
+}
+
+void Pathfinder::roomDistances(int room, int distances[PATHFINDER_MAX_ROOMS]) const {
+    for (int i = 0; i < PATHFINDER_MAX_ROOMS; i++) {
+        distances[i] = PATHFINDER_UNREACHABLE;
+    }
+    if (room < 0 || room >= PATHFINDER_MAX_ROOMS) {
+        return;
+    }
+    uint32_t seen = 1u << room;
+    uint32_t frontier = seen;
+    for (int distance = 0; frontier != 0; distance++) {
+        uint32_t next = 0;
+        for (uint32_t rest = frontier; rest != 0; rest &= rest - 1) {
+            int r = __builtin_ctz(rest);
+            distances[r] = distance;
+            next |= roomLinks[r];
+        }
+        frontier = next & ~seen;
+        seen |= frontier;
+    }
+}
+
+int Pathfinder::distance(cv::Point from, cv::Point to) const {
+    return table->distance(from, to);
+}
+
+std::shared_ptr<const DistanceTable> Pathfinder::distanceTable() const {
+    return table;
+}
+
+bool Pathfinder::path(cv::Point start, cv::Point target, std::vector<cv::Point> &path) const {
+    path.clear();
+    int distance = table->distance(start, target);
+    if (distance == PATHFINDER_UNREACHABLE) {
+        return false;
+    }
+    int DIR_X[4] = {-1, 1,  0, 0};
+    int DIR_Y[4] = { 0, 0, -1, 1};
+
+    // Walk down the distances to the target, there always being a neighbour one step closer
+    cv::Point p = start;
+    path.push_back(p);
+    for (; distance > 0; distance--) {
+        for (int i = 0; i < 4; i++) {
+            cv::Point q = cv::Point(p.x + DIR_X[i], p.y + DIR_Y[i]);
+            if (table->distance(q, target) == distance - 1) {
+                p = q;
+                break;
+            }
+        }
+        path.push_back(p);
+    }
+    return true;
+}
+
+Bitboard Pathfinder::reachableCells(cv::Point start, int movementLength, const Bitboard &blocked) const {
+    Bitboard reachable;
+    clearBitboard(reachable);
+    int region = table->regionAtPosition(start);
+    if (region == -1) {
+        return reachable;
+    }
+
+    // Figures further away than the movement length cannot be in the way, leaving a table lookup per cell. Otherwise
+    // the figures are searched around
+    bool blockedInReach = false;
+    for (int i = 0; i < BOARD_HEIGHT && !blockedInReach; i++) {
+        for (uint32_t row = blocked.rows[i] & table->regionCells(region).rows[i]; row != 0; row &= row - 1) {
+            cv::Point p = cv::Point(__builtin_ctz(row), i);
+            if (p != start && table->distance(start, p) < movementLength) {
+                blockedInReach = true;
+                break;
+            }
+        }
+    }
+    if (!blockedInReach) {
+        const Bitboard &regionCells = table->regionCells(region);
+        for (int i = 0; i < BOARD_HEIGHT; i++) {
+            for (uint32_t row = regionCells.rows[i] & ~blocked.rows[i]; row != 0; row &= row - 1) {
+                int j = __builtin_ctz(row);
+                if (table->distance(start, cv::Point(j, i)) <= movementLength) {
+                    reachable.rows[i] |= 1u << j;
+                }
+            }
+        }
+        setBitboardCell(reachable, start);
+        return reachable;
+    }
+
+    Bitboard allowed;
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        allowed.rows[i] = walkableCells.rows[i] & ~blocked.rows[i];
+    }
+    Bitboard frontier;
+    Bitboard next;
+    clearBitboard(frontier);
+    setBitboardCell(frontier, start);
+    reachable = frontier;
+    for (int i = 0; i < movementLength && expandFrontier(frontier, allowed, reachable, next); i++) {
+        frontier = next;
+    }
+    return reachable;
+}
+
+bool Pathfinder::recommendedDestination(cv::Point monster, int movementLength, const std::vector<cv::Point> &heroes, const Bitboard &blocked, cv::Point &destination) const {
+    int roomHops[PATHFINDER_MAX_ROOMS];
+    roomDistances(roomAtPosition(monster), roomHops);
+
+    // Heroes in rooms that cannot be reached are ruled out first, and only heroes at most one room further away than
+    // the closest are compared by steps
+    int closestRoomHops = -1;
+    for (int i = 0; i < heroes.size(); i++) {
+        int room = roomAtPosition(heroes[i]);
+        if (room != -1 && roomHops[room] != PATHFINDER_UNREACHABLE && (closestRoomHops == -1 || roomHops[room] < closestRoomHops)) {
+            closestRoomHops = roomHops[room];
+        }
+    }
+    if (closestRoomHops == -1) {
+        return false;
+    }
+    cv::Point target;
+    int targetDistance = PATHFINDER_UNREACHABLE;
+    for (int i = 0; i < heroes.size(); i++) {
+        int room = roomAtPosition(heroes[i]);
+        if (room == -1 || roomHops[room] == PATHFINDER_UNREACHABLE || roomHops[room] > closestRoomHops + 1) {
+            continue;
+        }
+        int distance = table->distance(monster, heroes[i]);
+        if (distance != PATHFINDER_UNREACHABLE && (targetDistance == PATHFINDER_UNREACHABLE || distance < targetDistance)) {
+            target = heroes[i];
+            targetDistance = distance;
+        }
+    }
+    if (targetDistance == PATHFINDER_UNREACHABLE) {
+        return false;
+    }
+
+    // Closest cell to the hero, taking the nearest one of equally close cells
+    Bitboard reachable = reachableCells(monster, movementLength, blocked);
+    destination = monster;
+    int bestDistance = targetDistance;
+    int bestSteps = 0;
+    for (int i = 0; i < BOARD_HEIGHT; i++) {
+        for (uint32_t row = reachable.rows[i]; row != 0; row &= row - 1) {
+            cv::Point p = cv::Point(__builtin_ctz(row), i);
+            int distance = table->distance(p, target);
+            int steps = table->distance(monster, p);
+            if (distance < bestDistance || (distance == bestDistance && steps < bestSteps)) {
+                bestDistance = distance;
+                bestSteps = steps;
+                destination = p;
+            }
+        }
+    }
+    return true;
+}
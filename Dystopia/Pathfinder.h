@@ -0,0 +1,82 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_Pathfinder_h
+#define Dystopia_Pathfinder_h
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+#include "GameRules.h"
+#include "DistanceTable.h"
+
+#define PATHFINDER_MAX_ROOMS 32
+
+#define PATHFINDER_UNREACHABLE DISTANCE_TABLE_UNREACHABLE
+
+// Two level pathfinding over the revealed board. Rooms are searched first, using the room links given by walkable cells
+// of different rooms touching, and only then are cells looked at, in the distance table of the walkable cells.
+
+class Pathfinder {
+public:
+    Pathfinder();
+
+    // Room of every walkable cell, -1 for cells that cannot be walked on. Rooms must be below PATHFINDER_MAX_ROOMS
+    void setBoard(const int rooms[BOARD_HEIGHT][BOARD_WIDTH]);
+
+    const Bitboard &walkable() const;
+    int roomAtPosition(cv::Point position) const;
+
+    // Room hops from the room to every room, or PATHFINDER_UNREACHABLE
+    void roomDistances(int room, int distances[PATHFINDER_MAX_ROOMS]) const;
+
+    // Steps between the cells, other figures not taken into account, or PATHFINDER_UNREACHABLE
+    int distance(cv::Point from, cv::Point to) const;
+
+    // Kept alive by whoever holds it, so it can be used from other threads while the board changes
+    std::shared_ptr<const DistanceTable> distanceTable() const;
+
+    // Shortest cell path from start to target, both included. Blocked cells are not taken into account
+    bool path(cv::Point start, cv::Point target, std::vector<cv::Point> &path) const;
+
+    // Cells reachable from start in at most movementLength steps without passing blocked cells, start included
+    Bitboard reachableCells(cv::Point start, int movementLength, const Bitboard &blocked) const;
+
+    // Reachable cell closest to the nearest hero, fewest steps first on ties. Returns false if no hero can be reached
+    bool recommendedDestination(cv::Point monster, int movementLength, const std::vector<cv::Point> &heroes, const Bitboard &blocked, cv::Point &destination) const;
+
+private:
+    int rooms[BOARD_HEIGHT][BOARD_WIDTH];
+    Bitboard walkableCells;
+    uint32_t roomLinks[PATHFINDER_MAX_ROOMS];
+
+    std::shared_ptr<const DistanceTable> table;
+};
+
+#endif
@@ -263,9 +263,10 @@ PreviewableViewController *previewInstance = nil;
 }
 
 - (void)previewBoard:(UIImage *)image {
-    if (boardPreview.hidden == NO) {
+    BoardSnapshotReference snapshot = [[BoardCalibrator instance] boardSnapshot];
+    if (boardPreview.hidden == NO && snapshot.isValid()) {
         cv::Mat coloredImage;
-        cv::cvtColor([BoardCalibrator instance].boardImage, coloredImage, CV_GRAY2RGB);
+        cv::cvtColor(snapshot->image, coloredImage, CV_GRAY2RGB);
         boardPreview.image = [UIImage imageWithCVMat:coloredImage];
     }
 }
@@ -0,0 +1,162 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#import "RevealMaskAtlas.h"
+#import "BoardUtil.h"
+#import "BrickView.h"
+
+// Transparent pixels between regions, so filtering never samples a neighbour
+#define REVEAL_MASK_ATLAS_PADDING 2
+
+@interface RevealMaskAtlas () {
+    NSMutableArray *regionBrickViews;
+    NSMutableArray *regionBrickSets;
+
+    cv::vector<CGRect> regionFrames;
+    cv::vector<CGRect> regionAtlasRects;
+
+    CGSize atlasSize;
+}
+
+@end
+
+@implementation RevealMaskAtlas
+
+@synthesize image;
+
+- (id)init {
+    if (self = [super init]) {
+        regionBrickViews = [NSMutableArray array];
+        regionBrickSets = [NSMutableArray array];
+        image = NULL;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    CGImageRelease(image);
+}
+
+- (int)regionCount {
+    return (int)regionFrames.size();
+}
+
+- (int)addMaskWithBrickViews:(NSArray *)brickViews {
+    NSSet *brickSet = [NSSet setWithArray:brickViews];
+    NSUInteger region = [regionBrickSets indexOfObject:brickSet];
+    if (region != NSNotFound) {
+        return (int)region;
+    }
+    [regionBrickSets addObject:brickSet];
+    [regionBrickViews addObject:brickViews];
+    regionFrames.push_back([[BoardUtil instance] brickViewsBoundingRect:brickViews]);
+    return (int)regionFrames.size() - 1;
+}
+
+- (void)render {
+    [self packRegions];
+    [self rasterizeRegions];
+}
+
+- (void)packRegions {
+    regionAtlasRects.assign(regionFrames.size(), CGRectZero);
+
+    // Shelf packing of the regions, tallest first
+    cv::vector<int> order;
+    float atlasWidth = 0.0f;
+    float area = 0.0f;
+    for (int i = 0; i < regionFrames.size(); i++) {
+        order.push_back(i);
+        atlasWidth = MAX(atlasWidth, ceilf(regionFrames[i].size.width) + REVEAL_MASK_ATLAS_PADDING);
+        area += (regionFrames[i].size.width + REVEAL_MASK_ATLAS_PADDING) * (regionFrames[i].size.height + REVEAL_MASK_ATLAS_PADDING);
+    }
+    atlasWidth = MAX(atlasWidth, ceilf(sqrtf(area)));
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return regionFrames[a].size.height > regionFrames[b].size.height;
+    });
+
+    float x = 0.0f;
+    float y = 0.0f;
+    float shelfHeight = 0.0f;
+    for (int i : order) {
+        float width = ceilf(regionFrames[i].size.width);
+        float height = ceilf(regionFrames[i].size.height);
+        if (x + width + REVEAL_MASK_ATLAS_PADDING > atlasWidth) {
+            x = 0.0f;
+            y += shelfHeight;
+            shelfHeight = 0.0f;
+        }
+        regionAtlasRects[i] = CGRectMake(x, y, width, height);
+        x += width + REVEAL_MASK_ATLAS_PADDING;
+        shelfHeight = MAX(shelfHeight, height + REVEAL_MASK_ATLAS_PADDING);
+    }
+    atlasSize = CGSizeMake(atlasWidth, MAX(y + shelfHeight, 1.0f));
+}
+
+- (void)rasterizeRegions {
+    CGImageRelease(image);
+    image = NULL;
+
+    CGContextRef context = CGBitmapContextCreate(NULL, (size_t)atlasSize.width, (size_t)atlasSize.height, 8, (size_t)atlasSize.width, NULL, kCGImageAlphaOnly);
+    if (context == NULL) {
+        NSLog(@"Could not create reveal mask atlas of size %.0fx%.0f", atlasSize.width, atlasSize.height);
+        return;
+    }
+    CGContextClearRect(context, CGRectMake(0.0f, 0.0f, atlasSize.width, atlasSize.height));
+
+    // Top-left origin, as the layer reads contentsRect
+    CGContextTranslateCTM(context, 0.0f, atlasSize.height);
+    CGContextScaleCTM(context, 1.0f, -1.0f);
+    CGContextSetGrayFillColor(context, 0.0f, 1.0f);
+
+    for (int i = 0; i < regionFrames.size(); i++) {
+        CGContextSaveGState(context);
+        CGContextClipToRect(context, regionAtlasRects[i]);
+        for (BrickView *brickView in [regionBrickViews objectAtIndex:i]) {
+            CGRect brickRect = [[BoardUtil instance] brickTypeFrame:brickView.type position:brickView.position];
+            brickRect.origin.x += regionAtlasRects[i].origin.x - regionFrames[i].origin.x;
+            brickRect.origin.y += regionAtlasRects[i].origin.y - regionFrames[i].origin.y;
+            CGContextFillRect(context, brickRect);
+        }
+        CGContextRestoreGState(context);
+    }
+    image = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+
+    if (DEBUG) {
+        NSLog(@"Reveal mask atlas: %i regions in %.0fx%.0f", self.regionCount, atlasSize.width, atlasSize.height);
+    }
+}
+
+- (CGRect)frameForRegion:(int)region {
+    return regionFrames[region];
+}
+
+- (CGRect)contentsRectForRegion:(int)region {
+    CGRect rect = regionAtlasRects[region];
+    return CGRectMake(rect.origin.x / atlasSize.width, rect.origin.y / atlasSize.height, regionFrames[region].size.width / atlasSize.width, regionFrames[region].size.height / atlasSize.height);
+}
+
+@end
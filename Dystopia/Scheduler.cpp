@@ -0,0 +1,236 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "Scheduler.h"
+
+RealTimeClock::RealTimeClock() : startTime(std::chrono::steady_clock::now()) {
+}
+
+double RealTimeClock::now() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+bool RealTimeClock::advanceTo(double) {
+    return false;
+}
+
+VirtualClock::VirtualClock() : time(0.0) {
+}
+
+double VirtualClock::now() const {
+    return time;
+}
+
+bool VirtualClock::advanceTo(double t) {
+    if (t > time) {
+        time = t;
+    }
+    return true;
+}
+
+Scheduler::Scheduler(SchedulerClock &clock) : schedulerClock(clock), nextSequenceNumber(0) {
+}
+
+void Scheduler::schedule(double delay, const Task &task) {
+    ScheduledTask scheduledTask;
+    scheduledTask.time = schedulerClock.now() + std::max(delay, 0.0);
+    scheduledTask.sequenceNumber = nextSequenceNumber++;
+    scheduledTask.task = task;
+    tasks.push(scheduledTask);
+}
+
+int Scheduler::runDueTasks() {
+    int count = 0;
+    while (!tasks.empty() && tasks.top().time <= schedulerClock.now()) {
+
+        // Pop before running, as the task may schedule new tasks
+        Task task = tasks.top().task;
+        tasks.pop();
+        task();
+        count++;
+    }
+    return count;
+}
+
+int Scheduler::runUntilIdle(int maxTasks) {
+    int count = runDueTasks();
+    while (!tasks.empty() && (maxTasks < 0 || count < maxTasks)) {
+        if (!schedulerClock.advanceTo(tasks.top().time)) {
+            break;
+        }
+        count += runDueTasks();
+    }
+    return count;
+}
+
+void Scheduler::moveTasksTo(Scheduler &other) {
+    double now = schedulerClock.now();
+    while (!tasks.empty()) {
+        other.schedule(tasks.top().time - now, tasks.top().task);
+        tasks.pop();
+    }
+}
+
+bool Scheduler::hasTasks() const {
+    return !tasks.empty();
+}
+
+double Scheduler::nextTaskTime() const {
+    return tasks.empty() ? -1.0 : tasks.top().time;
+}
+
+SchedulerClock &Scheduler::clock() const {
+    return schedulerClock;
+}
+
+#ifdef SCHEDULER_TURN_SEQUENCE_MAIN
+
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include "TurnTiming.h"
+
+struct TurnSequenceEvent {
+    std::string name;
+    double time;
+};
+
+class TurnSequence {
+public:
+    TurnSequence(Scheduler *scheduler, int heroCount, int monsterCount, int doorOpeningHero)
+        : scheduler(scheduler), heroCount(heroCount), monsterCount(monsterCount), doorOpeningHero(doorOpeningHero) {
+    }
+
+    // Board recognized; the start room door opens before heroes are placed
+    void start() {
+        scheduler->schedule(BRICKVIEW_OPEN_DOOR_DURATION, [this]() {
+            log("place heroes");
+            objectIndex = 0;
+            nextObjectTurnAfterDelay(BOARD_GAME_NEXT_OBJECT_PAUSE);
+        });
+    }
+
+    Scheduler *scheduler;
+    std::vector<TurnSequenceEvent> events;
+
+private:
+    void nextObjectTurnAfterDelay(double delay) {
+        scheduler->schedule(delay, [this]() {
+            nextObjectTurn();
+        });
+    }
+
+    void nextObjectTurn() {
+        if (objectIndex < heroCount) {
+            log("hero " + std::to_string(objectIndex));
+            bool openedDoor = objectIndex == doorOpeningHero;
+            if (openedDoor) {
+                scheduler->schedule(BRICKVIEW_OPEN_DOOR_DURATION, [this]() {
+                    log("relayout board");
+                });
+            }
+            objectIndex++;
+            nextObjectTurnAfterDelay(openedDoor ? BRICKVIEW_OPEN_DOOR_DURATION + BOARD_GAME_NEXT_OBJECT_PAUSE : BOARD_GAME_NEXT_OBJECT_PAUSE);
+            return;
+        }
+        if (objectIndex < heroCount + monsterCount) {
+            log("monster " + std::to_string(objectIndex - heroCount));
+            objectIndex++;
+            nextObjectTurnAfterDelay(BOARD_GAME_NEXT_OBJECT_PAUSE);
+            return;
+        }
+        log("end turn");
+        scheduler->schedule(BOARD_GAME_NEXT_OBJECT_DELAY, [this]() {
+            log("players turn");
+        });
+    }
+
+    void log(const std::string &name) {
+        TurnSequenceEvent event;
+        event.name = name;
+        event.time = scheduler->clock().now();
+        events.push_back(event);
+    }
+
+    int heroCount;
+    int monsterCount;
+    int doorOpeningHero;
+    int objectIndex;
+};
+
+static bool checkTurnSequence(const std::string &title, const std::vector<TurnSequenceEvent> &events, const std::vector<TurnSequenceEvent> &expected) {
+    bool ok = events.size() == expected.size();
+    for (int i = 0; ok && i < (int)expected.size(); i++) {
+        ok = events[i].name == expected[i].name && std::fabs(events[i].time - expected[i].time) < 1e-3;
+    }
+    std::cout << (ok ? "ok   " : "FAIL ") << title << std::endl;
+    for (const TurnSequenceEvent &event : events) {
+        std::cout << "  " << event.time << " " << event.name << std::endl;
+    }
+    return ok;
+}
+
+// Runs a turn of two heroes, where the first opens a door, and one monster without waiting for any of the delays
+int main() {
+    double door = BRICKVIEW_OPEN_DOOR_DURATION;
+    double pause = BOARD_GAME_NEXT_OBJECT_PAUSE;
+    std::vector<TurnSequenceEvent> expected = {
+        {"place heroes", door},
+        {"hero 0", door + pause},
+        {"hero 1", door + pause + door + pause},
+        {"relayout board", door + pause + door},
+        {"monster 0", door + pause + door + pause * 2.0},
+        {"end turn", door + pause + door + pause * 3.0},
+        {"players turn", door + pause + door + pause * 3.0 + BOARD_GAME_NEXT_OBJECT_DELAY}
+    };
+    std::sort(expected.begin(), expected.end(), [](const TurnSequenceEvent &a, const TurnSequenceEvent &b) {
+        return a.time < b.time;
+    });
+    bool ok = true;
+
+    VirtualClock virtualClock;
+    Scheduler scheduler(virtualClock);
+    TurnSequence turnSequence(&scheduler, 2, 1, 0);
+    turnSequence.start();
+    int taskCount = scheduler.runUntilIdle();
+    ok &= checkTurnSequence("virtual clock", turnSequence.events, expected) && taskCount == 7 && !scheduler.hasTasks();
+
+    // Started on the wall clock and switched to a virtual clock before anything was due, as GameScheduler does
+    RealTimeClock realTimeClock;
+    Scheduler realTimeScheduler(realTimeClock);
+    VirtualClock switchedClock;
+    Scheduler switchedScheduler(switchedClock);
+    TurnSequence switchedTurnSequence(&realTimeScheduler, 2, 1, 0);
+    switchedTurnSequence.start();
+    realTimeScheduler.moveTasksTo(switchedScheduler);
+    switchedTurnSequence.scheduler = &switchedScheduler;
+    taskCount = switchedScheduler.runUntilIdle();
+    ok &= checkTurnSequence("switched to virtual clock", switchedTurnSequence.events, expected) && taskCount == 7 && !realTimeScheduler.hasTasks();
+
+    return ok ? 0 : 1;
+}
+
+#endif
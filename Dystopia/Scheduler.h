@@ -0,0 +1,115 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_Scheduler_h
+#define Dystopia_Scheduler_h
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <vector>
+
+// Source of time for a scheduler, in seconds
+class SchedulerClock {
+public:
+    virtual ~SchedulerClock() {}
+
+    virtual double now() const = 0;
+
+    // Moves time forward to the given time. Only a virtual clock can; the wall clock returns false
+    virtual bool advanceTo(double time) = 0;
+};
+
+class RealTimeClock : public SchedulerClock {
+public:
+    RealTimeClock();
+
+    double now() const;
+    bool advanceTo(double time);
+
+private:
+    std::chrono::steady_clock::time_point startTime;
+};
+
+class VirtualClock : public SchedulerClock {
+public:
+    VirtualClock();
+
+    double now() const;
+    bool advanceTo(double time);
+
+private:
+    double time;
+};
+
+// Delayed tasks ordered by due time; tasks due at the same time run in the order they were scheduled.
+//
+// Not thread safe - schedule and run from the same thread.
+//
+// A turn sequence with the delays of BoardGame is replayed on a virtual clock by
+//
+//   c++ -std=c++11 -DSCHEDULER_TURN_SEQUENCE_MAIN Scheduler.cpp -o turnsequence && ./turnsequence
+
+class Scheduler {
+public:
+    typedef std::function<void()> Task;
+
+    explicit Scheduler(SchedulerClock &clock);
+
+    void schedule(double delay, const Task &task);
+
+    // Runs all tasks that are due, including tasks they schedule without delay. Returns number of tasks run
+    int runDueTasks();
+
+    // Runs tasks until none are left or maxTasks have been run, jumping the clock ahead to each next task. With the
+    // wall clock only due tasks are run
+    int runUntilIdle(int maxTasks = -1);
+
+    // Moves all pending tasks to the other scheduler, keeping their order and the time left until they are due
+    void moveTasksTo(Scheduler &other);
+
+    bool hasTasks() const;
+    double nextTaskTime() const;
+
+    SchedulerClock &clock() const;
+
+private:
+    struct ScheduledTask {
+        double time;
+        unsigned long long sequenceNumber;
+        Task task;
+
+        bool operator>(const ScheduledTask &other) const {
+            return time != other.time ? time > other.time : sequenceNumber > other.sequenceNumber;
+        }
+    };
+
+    SchedulerClock &schedulerClock;
+    std::priority_queue<ScheduledTask, std::vector<ScheduledTask>, std::greater<ScheduledTask>> tasks;
+    unsigned long long nextSequenceNumber;
+};
+
+#endif
@@ -0,0 +1,150 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_SnapshotExchange_h
+#define Dystopia_SnapshotExchange_h
+
+#include <atomic>
+#include <stddef.h>
+
+#define SNAPSHOT_EXCHANGE_DEFAULT_SLOT_COUNT 4
+
+// Lock-free publication of immutable snapshots from a single producer to any number of readers.
+//
+// Snapshots live in a fixed set of slots, each with an atomic reference count. The producer fills a slot that is neither
+// current nor referenced and publishes it by swapping the current slot index. Readers reference the current slot and
+// confirm it is still current, retrying only if a publish happened in between - neither side ever waits for the other.
+// If readers hold every other slot the producer drops the snapshot instead of blocking.
+
+template <typename T, int SlotCount = SNAPSHOT_EXCHANGE_DEFAULT_SLOT_COUNT>
+class SnapshotExchange {
+
+private:
+    struct Slot {
+        T value;
+        std::atomic<int> references;
+    };
+
+public:
+
+    // Read reference to a published snapshot; the slot is not reused while referenced
+    class Reference {
+    public:
+        Reference() : slot(NULL) {}
+        Reference(const Reference &other) : slot(other.slot) {
+            retain();
+        }
+        ~Reference() {
+            release();
+        }
+
+        Reference &operator=(const Reference &other) {
+            if (slot != other.slot) {
+                release();
+                slot = other.slot;
+                retain();
+            }
+            return *this;
+        }
+
+        bool isValid() const {
+            return slot != NULL;
+        }
+
+        const T &operator*() const {
+            return slot->value;
+        }
+
+        const T *operator->() const {
+            return &slot->value;
+        }
+
+    private:
+        friend class SnapshotExchange;
+
+        explicit Reference(Slot *referencedSlot) : slot(referencedSlot) {}
+
+        void retain() {
+            if (slot != NULL) {
+                slot->references.fetch_add(1);
+            }
+        }
+
+        void release() {
+            if (slot != NULL) {
+                slot->references.fetch_sub(1);
+                slot = NULL;
+            }
+        }
+
+        Slot *slot;
+    };
+
+    SnapshotExchange() : current(-1) {
+        for (int i = 0; i < SlotCount; i++) {
+            slots[i].references.store(0);
+        }
+    }
+
+    // Publishes a new snapshot. Must only be called from one thread at a time. Returns false if the snapshot was dropped
+    bool publish(const T &value) {
+        int currentIndex = current.load();
+        for (int i = 0; i < SlotCount; i++) {
+            if (i == currentIndex || slots[i].references.load() != 0) {
+                continue;
+            }
+            slots[i].value = value;
+            current.store(i);
+            return true;
+        }
+        return false;
+    }
+
+    // Returns the latest snapshot, or an invalid reference if nothing has been published yet
+    Reference latest() {
+        while (true) {
+            int index = current.load();
+            if (index == -1) {
+                return Reference();
+            }
+            slots[index].references.fetch_add(1);
+            if (current.load() == index) {
+                return Reference(&slots[index]);
+            }
+            slots[index].references.fetch_sub(1);
+        }
+    }
+
+    // Drops the current snapshot; readers holding references keep them
+    void clear() {
+        current.store(-1);
+    }
+
+private:
+    Slot slots[SlotCount];
+    std::atomic<int> current;
+};
+
+#endif
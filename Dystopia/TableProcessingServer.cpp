@@ -0,0 +1,335 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "TableProcessingServer.h"
+#include "FrameBufferPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+static double currentTime() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TableProcessingServer::TableProcessingServer(int workerCount) : pool(workerCount), running(false) {
+}
+
+TableProcessingServer::~TableProcessingServer() {
+    stop();
+    pool.waitUntilIdle();
+    for (int i = 0; i < tables.size(); i++) {
+        delete tables[i];
+    }
+}
+
+int TableProcessingServer::addTable(TableProcessor *processor, double latencyBudget) {
+    return addTable(processor, NULL, latencyBudget);
+}
+
+int TableProcessingServer::addTable(TableProcessor *processor, FrameSource *source, double latencyBudget) {
+    Table *table = new Table();
+    table->processor = processor;
+    table->source = source;
+    table->latencyBudget = latencyBudget;
+    table->hasWaitingFrame = false;
+    table->processing = false;
+    table->frameSequenceNumber = 0;
+    table->framesReceived = 0;
+    table->framesProcessed = 0;
+    table->framesDropped = 0;
+    table->deadlineMisses = 0;
+    table->latencySum = 0.0;
+    table->maxLatency = 0.0;
+    table->latencySampleCount = 0;
+
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    table->tableId = (int)tables.size();
+    tables.push_back(table);
+    if (running && source != NULL) {
+        table->reader = std::thread(&TableProcessingServer::readFrames, this, table);
+    }
+    return table->tableId;
+}
+
+void TableProcessingServer::start() {
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    if (running) {
+        return;
+    }
+    running = true;
+    for (int i = 0; i < tables.size(); i++) {
+        if (tables[i]->source != NULL) {
+            tables[i]->reader = std::thread(&TableProcessingServer::readFrames, this, tables[i]);
+        }
+    }
+}
+
+void TableProcessingServer::stop() {
+
+    // Readers submit frames and look up tables, so join them without holding the tables lock
+    std::vector<Table *> stoppedTables;
+    {
+        std::lock_guard<std::mutex> lock(tablesMutex);
+        running = false;
+        stoppedTables = tables;
+    }
+    for (int i = 0; i < stoppedTables.size(); i++) {
+        if (stoppedTables[i]->reader.joinable()) {
+            stoppedTables[i]->source->interrupt();
+            stoppedTables[i]->reader.join();
+        }
+    }
+}
+
+void TableProcessingServer::submitFrame(int tableId, const cv::Mat &image) {
+    Table *table;
+    {
+        std::lock_guard<std::mutex> lock(tablesMutex);
+        table = tables[tableId];
+    }
+    submitFrame(table, image);
+}
+
+void TableProcessingServer::submitFrame(Table *table, const cv::Mat &image) {
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        table->framesReceived++;
+        if (table->hasWaitingFrame) {
+            table->framesDropped++;
+        }
+
+        // The waiting image is never referenced by a worker, so its buffer can be overwritten in place
+        FrameBufferPool::instance().ensure(table->waitingImage, image.size(), image.type());
+        image.copyTo(table->waitingImage);
+        table->waitingFrameSequenceNumber = ++table->frameSequenceNumber;
+        table->waitingArrivalTime = currentTime();
+        table->hasWaitingFrame = true;
+        if (!table->processing) {
+            table->processing = true;
+            schedule = true;
+        }
+    }
+    if (schedule) {
+        scheduleTable(table);
+    }
+}
+
+void TableProcessingServer::scheduleTable(Table *table) {
+    pool.submit([this, table] { processWaitingFrame(table); }, table->tableId % pool.workerCount());
+}
+
+void TableProcessingServer::processWaitingFrame(Table *table) {
+    cv::Mat image;
+    unsigned long long frameSequenceNumber;
+    double arrivalTime;
+    {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        std::swap(image, table->waitingImage);
+        frameSequenceNumber = table->waitingFrameSequenceNumber;
+        arrivalTime = table->waitingArrivalTime;
+        table->hasWaitingFrame = false;
+    }
+
+    bool missedDeadline = currentTime() - arrivalTime > table->latencyBudget;
+    if (!missedDeadline) {
+        table->processor->processFrame(image, frameSequenceNumber);
+    }
+    double latency = currentTime() - arrivalTime;
+
+    bool reschedule;
+    {
+        std::lock_guard<std::mutex> lock(table->mutex);
+        if (missedDeadline) {
+            table->deadlineMisses++;
+        } else {
+            table->framesProcessed++;
+            table->latencySum += latency;
+            table->maxLatency = std::max(table->maxLatency, latency);
+            table->latencySamples[table->latencySampleCount % TABLE_PROCESSING_LATENCY_SAMPLE_COUNT] = latency;
+            table->latencySampleCount++;
+        }
+        reschedule = table->hasWaitingFrame;
+        table->processing = reschedule;
+    }
+    if (reschedule) {
+        scheduleTable(table);
+    }
+}
+
+void TableProcessingServer::readFrames(Table *table) {
+    cv::Mat image;
+    while (running && table->source->nextFrame(image)) {
+        submitFrame(table, image);
+    }
+}
+
+void TableProcessingServer::waitUntilIdle() {
+    pool.waitUntilIdle();
+}
+
+TableMetrics TableProcessingServer::metrics(int tableId) {
+    Table *table;
+    {
+        std::lock_guard<std::mutex> lock(tablesMutex);
+        table = tables[tableId];
+    }
+    std::lock_guard<std::mutex> lock(table->mutex);
+    TableMetrics metrics = {
+        .framesReceived = table->framesReceived,
+        .framesProcessed = table->framesProcessed,
+        .framesDropped = table->framesDropped,
+        .deadlineMisses = table->deadlineMisses,
+        .meanLatency = table->framesProcessed > 0 ? table->latencySum / table->framesProcessed : 0.0,
+        .maxLatency = table->maxLatency,
+        .latency95thPercentile = 0.0
+    };
+
+    // Percentile over the most recent samples
+    int sampleCount = std::min(table->latencySampleCount, TABLE_PROCESSING_LATENCY_SAMPLE_COUNT);
+    if (sampleCount > 0) {
+        std::vector<double> samples(table->latencySamples, table->latencySamples + sampleCount);
+        int index = std::min(sampleCount - 1, (sampleCount * 95) / 100);
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        metrics.latency95thPercentile = samples[index];
+    }
+    return metrics;
+}
+
+int TableProcessingServer::tableCount() {
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    return (int)tables.size();
+}
+
+#ifdef TABLE_PROCESSING_SERVER_MAIN
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "FramePreprocessor.h"
+
+// Board detection and brick recognition are Objective-C++ and only build with the app. This stage is the portable front
+// of board detection - grayscale blur and intensity range - so the server schedules real per-frame work on Linux
+class PreprocessingTableProcessor : public TableProcessor {
+public:
+    void processFrame(const cv::Mat &image, unsigned long long) {
+        preprocessFrame(image, blurredImage);
+    }
+
+private:
+    cv::Mat blurredImage;
+};
+
+// Counts the streams still running, so the server can stop once every recording has been played
+class EndTrackingFrameSource : public FrameSource {
+public:
+    EndTrackingFrameSource(FrameSource *source, std::atomic<int> &activeSourceCount) : source(source), activeSourceCount(activeSourceCount), ended(false) {
+        activeSourceCount++;
+    }
+
+    ~EndTrackingFrameSource() {
+        delete source;
+    }
+
+    bool nextFrame(cv::Mat &image) {
+        if (ended) {
+            return false;
+        }
+        if (!source->nextFrame(image)) {
+            ended = true;
+            activeSourceCount--;
+            return false;
+        }
+        return true;
+    }
+
+    void interrupt() {
+        source->interrupt();
+    }
+
+private:
+    FrameSource *source;
+    std::atomic<int> &activeSourceCount;
+    bool ended;
+};
+
+static FrameSource *openFrameSource(const std::string &name, int width, int height, float framesPerSecond) {
+    size_t separator = name.rfind(':');
+    if (separator != std::string::npos) {
+        return RawFrameSource::connect(name.substr(0, separator).c_str(), atoi(name.substr(separator + 1).c_str()), width, height);
+    }
+    return RawFrameSource::openFile(name.c_str(), width, height, framesPerSecond);
+}
+
+// One table per source - a recording of raw grayscale frames, played back at the given rate, or host:port of a camera
+// stream. Prints the metrics of every table each second until all streams have ended
+int main(int argc, char *argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " <width> <height> <frames per second> <file|host:port>..." << std::endl;
+        return 1;
+    }
+    int width = atoi(argv[1]);
+    int height = atoi(argv[2]);
+    float framesPerSecond = (float)atof(argv[3]);
+
+    std::atomic<int> activeSourceCount(0);
+    std::vector<FrameSource *> sources;
+    std::vector<TableProcessor *> processors;
+    TableProcessingServer server;
+    for (int i = 4; i < argc; i++) {
+        FrameSource *source = openFrameSource(argv[i], width, height, framesPerSecond);
+        if (source == NULL) {
+            std::cerr << argv[i] << ": could not open frame source" << std::endl;
+            return 1;
+        }
+        sources.push_back(new EndTrackingFrameSource(source, activeSourceCount));
+        processors.push_back(new PreprocessingTableProcessor());
+        server.addTable(processors.back(), sources.back());
+    }
+    std::cout << "Processing " << server.tableCount() << " tables with " << framePreprocessorKernelName() << " kernels" << std::endl;
+
+    server.start();
+    while (activeSourceCount > 0) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        for (int i = 0; i < server.tableCount(); i++) {
+            TableMetrics metrics = server.metrics(i);
+            std::cout << "Table " << i << ": " << metrics.framesReceived << " received, " << metrics.framesProcessed << " processed, "
+                      << metrics.framesDropped << " dropped, " << metrics.deadlineMisses << " late, latency mean "
+                      << metrics.meanLatency * 1000.0 << " ms, 95% " << metrics.latency95thPercentile * 1000.0 << " ms, max "
+                      << metrics.maxLatency * 1000.0 << " ms" << std::endl;
+        }
+    }
+    server.stop();
+    server.waitUntilIdle();
+
+    for (int i = 0; i < sources.size(); i++) {
+        delete sources[i];
+        delete processors[i];
+    }
+    return 0;
+}
+
+#endif
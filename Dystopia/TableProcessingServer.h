@@ -0,0 +1,147 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_TableProcessingServer_h
+#define Dystopia_TableProcessingServer_h
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "WorkStealingPool.h"
+#include "FrameSource.h"
+
+#define TABLE_PROCESSING_DEFAULT_LATENCY_BUDGET 0.25
+#define TABLE_PROCESSING_LATENCY_SAMPLE_COUNT 256
+
+// Vision work of one table - board detection and brick recognition on its frames.
+class TableProcessor {
+public:
+    virtual ~TableProcessor() {}
+
+    // Called on pool workers, but never concurrently for the same table
+    virtual void processFrame(const cv::Mat &image, unsigned long long frameSequenceNumber) = 0;
+};
+
+typedef struct {
+    long long framesReceived;
+    long long framesProcessed;
+
+    // Frames replaced by a newer frame of the same table before processing started
+    long long framesDropped;
+
+    // Frames that had already waited longer than the latency budget when a worker got to them
+    long long deadlineMisses;
+
+    // Seconds from a frame arriving until its processing finished
+    double meanLatency;
+    double maxLatency;
+    double latency95thPercentile;
+} TableMetrics;
+
+// Processes the camera streams of several tables on one shared work-stealing pool.
+//
+// Each table has at most one frame being processed and one waiting; a newer frame replaces the waiting one. A slow table
+// therefore never builds up a backlog, and the latency of a table is bounded by roughly two of its own processing times
+// plus queueing on the pool. Frames that have waited past the table's latency budget are skipped rather than processed
+// late. A table prefers the same worker for all of its frames and is only moved when that worker is busy elsewhere.
+//
+// Processors and frame sources are owned by the caller and must outlive the server.
+//
+// BoardDetectionTableProcessor does board detection and brick recognition per table, but is Objective-C++ and only
+// builds with the app. The standalone server does neither: it runs only the portable preprocessing stage of board
+// detection (grayscale blur and intensity range) on every table, so its metrics cover scheduling and that pass alone.
+// Build it with the command below, split over two lines, and run it with the frame size, playback rate and one
+// recording or host:port stream per table:
+//
+//   c++ -std=c++11 -O2 -DTABLE_PROCESSING_SERVER_MAIN TableProcessingServer.cpp WorkStealingPool.cpp FrameSource.cpp
+//       FramePreprocessor.cpp FrameBufferPool.cpp -lopencv_core -lpthread -o tableserver
+//   tableserver 640 480 30 table1.raw table2.raw camera3:5000
+
+class TableProcessingServer {
+public:
+    explicit TableProcessingServer(int workerCount = 0);
+    ~TableProcessingServer();
+
+    // Adds a table fed through submitFrame, like the camera session feeds its delegate. Returns the table id
+    int addTable(TableProcessor *processor, double latencyBudget = TABLE_PROCESSING_DEFAULT_LATENCY_BUDGET);
+
+    // Adds a table whose frames are read from the source on a thread of its own once the server is started
+    int addTable(TableProcessor *processor, FrameSource *source, double latencyBudget = TABLE_PROCESSING_DEFAULT_LATENCY_BUDGET);
+
+    void start();
+    void stop();
+
+    // Copies the frame, so the caller may reuse its buffer right away
+    void submitFrame(int tableId, const cv::Mat &image);
+
+    // Blocks until no table has a frame waiting or being processed
+    void waitUntilIdle();
+
+    TableMetrics metrics(int tableId);
+    int tableCount();
+
+private:
+    struct Table {
+        int tableId;
+        TableProcessor *processor;
+        FrameSource *source;
+        double latencyBudget;
+
+        std::mutex mutex;
+        cv::Mat waitingImage;
+        unsigned long long waitingFrameSequenceNumber;
+        double waitingArrivalTime;
+        bool hasWaitingFrame;
+        bool processing;
+        unsigned long long frameSequenceNumber;
+
+        long long framesReceived;
+        long long framesProcessed;
+        long long framesDropped;
+        long long deadlineMisses;
+        double latencySum;
+        double maxLatency;
+        double latencySamples[TABLE_PROCESSING_LATENCY_SAMPLE_COUNT];
+        int latencySampleCount;
+
+        std::thread reader;
+    };
+
+    void submitFrame(Table *table, const cv::Mat &image);
+    void processWaitingFrame(Table *table);
+    void scheduleTable(Table *table);
+    void readFrames(Table *table);
+
+    WorkStealingPool pool;
+
+    std::mutex tablesMutex;
+    std::vector<Table *> tables;
+    std::atomic<bool> running;
+};
+
+#endif
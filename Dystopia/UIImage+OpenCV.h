@@ -29,4 +29,8 @@
 - (cv::Mat)CVMat3;  // no alpha channel
 - (cv::Mat)CVGrayscaleMat;
 
+    //UIImage into caller-provided cv::Mat, reused if it fits
+- (void)copyToCVMat:(cv::Mat &)cvMat;
+- (void)copyToCVGrayscaleMat:(cv::Mat &)cvMat;
+
 @end
@@ -15,11 +15,19 @@
     //  http://docs.opencv.org/doc/tutorials/ios/image_manipulation/image_manipulation.html#opencviosimagemanipulation
 
 #import "UIImage+OpenCV.h"
+#import "FrameBufferPool.h"
 
 
 @implementation UIImage (OpenCV)
 
 -(cv::Mat)CVMat
+{
+    cv::Mat cvMat;
+    [self copyToCVMat:cvMat];
+    return cvMat;
+}
+
+- (void)copyToCVMat:(cv::Mat &)cvMat
 {
     CGColorSpaceRef colorSpace = CGImageGetColorSpace(self.CGImage);
     CGFloat cols;
@@ -32,7 +40,7 @@
         rows = self.size.height;
     }
     
-    cv::Mat cvMat(rows, cols, CV_8UC4); // 8 bits per component, 4 channels
+    FrameBufferPool::instance().ensure(cvMat, rows, cols, CV_8UC4); // 8 bits per component, 4 channels
     
     CGContextRef contextRef = CGBitmapContextCreate(cvMat.data,                 // Pointer to  data
                                                     cols,                       // Width of bitmap
@@ -45,8 +53,6 @@
     
     CGContextDrawImage(contextRef, CGRectMake(0, 0, cols, rows), self.CGImage);
     CGContextRelease(contextRef);
-    
-    return cvMat;
 }
 
 - (cv::Mat)CVMat3
@@ -58,6 +64,13 @@
 }
 
 -(cv::Mat)CVGrayscaleMat
+{
+    cv::Mat cvMat;
+    [self copyToCVGrayscaleMat:cvMat];
+    return cvMat;
+}
+
+- (void)copyToCVGrayscaleMat:(cv::Mat &)cvMat
 {
     CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceGray();
     
@@ -71,7 +84,7 @@
         rows = self.size.height;
     }
     
-    cv::Mat cvMat(rows, cols, CV_8UC1); // 8 bits per component, 1 channels
+    FrameBufferPool::instance().ensure(cvMat, rows, cols, CV_8UC1); // 8 bits per component, 1 channels
     
     CGContextRef contextRef = CGBitmapContextCreate(cvMat.data,                 // Pointer to data
                                                     cols,                       // Width of bitmap
@@ -85,8 +98,6 @@
     CGContextDrawImage(contextRef, CGRectMake(0, 0, cols, rows), self.CGImage);
     CGContextRelease(contextRef);
     CGColorSpaceRelease(colorSpace);
-    
-    return cvMat;
 }
 
 + (UIImage *)imageWithCVMat:(const cv::Mat&)cvMat orientation:(UIImageOrientation)orientation
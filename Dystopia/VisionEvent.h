@@ -0,0 +1,67 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef Dystopia_VisionEvent_h
+#define Dystopia_VisionEvent_h
+
+#include <opencv2/core/core.hpp>
+
+#include "SpscQueue.h"
+
+#define VISION_EVENT_BOARD_FOUND       0
+#define VISION_EVENT_BOARD_LOST        1
+#define VISION_EVENT_BOARD_OBSTRUCTED  2
+#define VISION_EVENT_CELL_OCCUPIED     3
+#define VISION_EVENT_CELL_VACATED      4
+#define VISION_EVENT_FIGURE_RECOGNIZED 5
+
+#define VISION_EVENT_QUEUE_CAPACITY 256
+
+#define VISION_EVENT_NO_REQUEST -1
+
+typedef struct {
+    int type;
+
+    // Camera frame the event was recognized on
+    unsigned long long frameSequenceNumber;
+
+    // Probability of the event being right, from 0 to 1
+    float confidence;
+
+    // Board cell of cell and figure events
+    cv::Point position;
+
+    // Recognition request the event answers, or VISION_EVENT_NO_REQUEST for board events
+    int requestTag;
+} VisionEvent;
+
+typedef SpscQueue<VisionEvent, VISION_EVENT_QUEUE_CAPACITY> VisionEventQueue;
+
+inline VisionEvent visionEvent(int type, unsigned long long frameSequenceNumber, float confidence, cv::Point position = cv::Point(-1, -1), int requestTag = VISION_EVENT_NO_REQUEST) {
+    VisionEvent event = {.type = type, .frameSequenceNumber = frameSequenceNumber, .confidence = confidence, .position = position, .requestTag = requestTag};
+    return event;
+}
+
+#endif
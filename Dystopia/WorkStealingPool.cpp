@@ -0,0 +1,135 @@
+// Copyright (c) 2013, Daniel Andersen (daniel@trollsahead.dk)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 3. The name of the author may not be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+// (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+// ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool(int workerCount) : pendingTasks(0), submissions(0), stopping(false), nextWorker(0), steals(0) {
+    if (workerCount <= 0) {
+        workerCount = std::max(1, (int)std::thread::hardware_concurrency());
+    }
+    for (int i = 0; i < workerCount; i++) {
+        queues.push_back(new WorkerQueue());
+    }
+    for (int i = 0; i < workerCount; i++) {
+        workers.push_back(std::thread(&WorkStealingPool::run, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    for (int i = 0; i < queues.size(); i++) {
+        delete queues[i];
+    }
+}
+
+void WorkStealingPool::submit(const Task &task, int preferredWorker) {
+    int workerIndex = preferredWorker >= 0 ? preferredWorker % (int)queues.size() : (int)(nextWorker++ % queues.size());
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        pendingTasks++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[workerIndex]->mutex);
+        queues[workerIndex]->tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        submissions++;
+    }
+    wakeCondition.notify_all();
+}
+
+void WorkStealingPool::waitUntilIdle() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    idleCondition.wait(lock, [this] { return pendingTasks == 0; });
+}
+
+int WorkStealingPool::workerCount() const {
+    return (int)workers.size();
+}
+
+long long WorkStealingPool::stealCount() const {
+    return steals.load();
+}
+
+void WorkStealingPool::run(int workerIndex) {
+    while (true) {
+        unsigned long long seenSubmissions;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            seenSubmissions = submissions;
+        }
+        Task task;
+        if (popTask(workerIndex, task) || stealTask(workerIndex, task)) {
+            task();
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            if (--pendingTasks == 0) {
+                idleCondition.notify_all();
+            }
+            continue;
+        }
+
+        // Nothing to run anywhere - sleep until a task is submitted. Submissions are counted before the scan, so a task
+        // submitted while scanning wakes the worker right away
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping) {
+            return;
+        }
+        wakeCondition.wait(lock, [this, seenSubmissions] { return stopping || submissions != seenSubmissions; });
+    }
+}
+
+bool WorkStealingPool::popTask(int workerIndex, Task &task) {
+    WorkerQueue *queue = queues[workerIndex];
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (queue->tasks.empty()) {
+        return false;
+    }
+    task = queue->tasks.back();
+    queue->tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::stealTask(int workerIndex, Task &task) {
+    for (int i = 1; i < queues.size(); i++) {
+        WorkerQueue *queue = queues[(workerIndex + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        if (queue->tasks.empty()) {
+            continue;
+        }
+        task = queue->tasks.front();
+        queue->tasks.pop_front();
+        steals++;
+        return true;
+    }
+    return false;
+}